@@ -0,0 +1,373 @@
+#pragma once
+
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#ifdef USE_SIMD
+#include <immintrin.h>
+#endif
+
+#include "../../../DataStructures/Container/ExternalKHeap.h"
+#include "../../../Helpers/Assert.h"
+#include "../../../Helpers/String/String.h"
+#include "../../../Helpers/Timer.h"
+#include "../../../Helpers/Types.h"
+#include "../../../Helpers/Vector/Vector.h"
+#include "../../../Helpers/aligned_allocator.h"
+#include "../CH.h"
+
+namespace CH {
+
+// One-to-all distances from a source (forward) or to a target (backward) by a PHAST sweep: an upward search from the
+// origin is followed by a single linear scan over all vertices in reverse contraction order, relaxing the downward
+// edges. The vertices are renumbered by their depth in the hierarchy (vertices without upward edges first), such that
+// the sweep reads and writes its distance array sequentially. Distances are reported for the POIs, i.e., the vertices
+// below endOfPOIs, with the same interface as BucketQuery. runBatch() sweeps up to BatchSize origins at once.
+template <bool DEBUG = false>
+class PHAST {
+public:
+    using Graph = CHGraph;
+    constexpr static bool Debug = DEBUG;
+    using Type = PHAST<Debug>;
+    constexpr static size_t BatchSize = 8;
+
+private:
+    struct UpwardLabel : public ExternalKHeapElement {
+        UpwardLabel() : ExternalKHeapElement(), distance(INFTY) {}
+        inline bool hasSmallerKey(const UpwardLabel* other) const noexcept { return distance < other->distance; }
+        int distance;
+    };
+
+    // Edges of one search direction, in sweep indices. The upward edges are used by the upward search, the downward
+    // edges of a vertex point to the (higher) vertices whose distance is pulled by the sweep.
+    struct SweepGraph {
+        std::vector<u_int32_t> firstUpwardEdge;
+        std::vector<u_int32_t> upwardHead;
+        std::vector<int> upwardWeight;
+        std::vector<u_int32_t> firstDownwardEdge;
+        std::vector<u_int32_t> downwardTail;
+        std::vector<int> downwardWeight;
+    };
+
+public:
+    PHAST(const Graph& forward, const Graph& backward, const std::vector<int>& forwardWeight,
+          const std::vector<int>& backwardWeight, const Vertex::ValueType endOfPOIs)
+        : numberOfVertices(forward.numVertices()),
+          sweepIndex(forward.numVertices()),
+          Q(forward.numVertices()),
+          upwardLabels(forward.numVertices()),
+          sweepDistance{std::vector<int>(forward.numVertices(), INFTY),
+                        std::vector<int>(backward.numVertices(), INFTY)},
+          distance{std::vector<int>(endOfPOIs, INFTY), std::vector<int>(endOfPOIs, INFTY)},
+          root{noVertex, noVertex},
+          endOfPOIs(endOfPOIs),
+          reachedPOIs{std::vector<Vertex>(), std::vector<Vertex>()},
+          targetDistance(INFTY),
+          batchSize(0) {
+        AssertMsg(forward.numVertices() == backward.numVertices(), "Forward and backward graph differ in size!");
+        AssertMsg(endOfPOIs <= numberOfVertices, "There are more POIs than vertices!");
+        if constexpr (Debug) timer.restart();
+        const std::vector<Vertex> sweepOrder = computeSweepOrder(forward, backward);
+        buildSweepGraph<FORWARD>(sweepOrder, forward, backward, forwardWeight, backwardWeight);
+        buildSweepGraph<BACKWARD>(sweepOrder, backward, forward, backwardWeight, forwardWeight);
+        if constexpr (Debug) {
+            std::cout << "Built PHAST sweep graphs in " << String::msToString(timer.elapsedMilliseconds()) << std::endl;
+            std::cout << "   Number of levels: " << String::prettyInt(numberOfLevels) << std::endl;
+        }
+    }
+
+    template <typename ATTRIBUTE>
+    PHAST(const Graph& forward, const Graph& backward, const Vertex::ValueType endOfPOIs,
+          const ATTRIBUTE attribute = Weight)
+        : PHAST(forward, backward, forward[attribute], backward[attribute], endOfPOIs) {}
+
+    PHAST(const CH& ch, const int direction = FORWARD, const Vertex::ValueType endOfPOIs = 0)
+        : PHAST(ch.getGraph(direction), ch.getGraph(!direction), endOfPOIs, Weight) {}
+
+    // Computes the distances from the source to all POIs and from all POIs to the target. Either of the two may be
+    // noVertex, in which case the corresponding sweep is skipped.
+    template <bool TARGET_PRUNING = true>
+    inline void run(const Vertex from, const Vertex to, const double targetPruningFactor = 1) noexcept {
+        if (root[FORWARD] == from && root[BACKWARD] == to) return;
+        if constexpr (Debug) {
+            std::cout << "Starting PHAST query" << std::endl;
+            timer.restart();
+        }
+
+        root[FORWARD] = from;
+        root[BACKWARD] = to;
+        targetDistance = INFTY;
+
+        if (from != noVertex) sweep<FORWARD>(from);
+        if (to != noVertex) sweep<BACKWARD>(to);
+        if (from != noVertex && to != noVertex) targetDistance = sweepDistance[FORWARD][sweepIndex[to]];
+
+        int maxDistance = INFTY;
+        if (TARGET_PRUNING && targetDistance != INFTY) {
+            maxDistance = std::min<double>(INFTY, targetDistance * targetPruningFactor);
+        }
+        collectPOIs<FORWARD>(from != noVertex, maxDistance);
+        collectPOIs<BACKWARD>(to != noVertex, maxDistance);
+
+        if constexpr (Debug) std::cout << "   Time = " << String::msToString(timer.elapsedMilliseconds()) << std::endl;
+    }
+
+    template <int I, int J, bool TARGET_PRUNING = true>
+    inline void run(const Vertex origin) noexcept {
+        if (root[I] == origin && root[J] == noVertex) return;
+        root[I] = origin;
+        root[J] = noVertex;
+        targetDistance = INFTY;
+        sweep<I>(origin);
+        collectPOIs<I>(true, INFTY);
+        collectPOIs<J>(false, INFTY);
+    }
+
+    // Sweeps up to BatchSize origins simultaneously in direction I. The distance array stores the BatchSize distances
+    // of each vertex next to each other, such that one downward edge is relaxed for all origins with a single
+    // vector instruction. The results are read with getBatchDistance().
+    template <int I = FORWARD>
+    inline void runBatch(const std::vector<Vertex>& origins) noexcept {
+        AssertMsg(origins.size() <= BatchSize, "Cannot sweep " << origins.size() << " origins at once!");
+        batchSize = origins.size();
+        batchDistance.assign(numberOfVertices * BatchSize, INFTY);
+        for (size_t lane = 0; lane < batchSize; lane++) {
+            upwardSearch<I>(origins[lane], [&](const u_int32_t vertex, const int dist) {
+                batchDistance[(vertex * BatchSize) + lane] = dist;
+            });
+        }
+        const SweepGraph& graph = sweepGraph[I];
+        int* const dist = batchDistance.data();
+#if defined(USE_SIMD) && defined(__AVX2__)
+        for (u_int32_t vertex = 0; vertex < numberOfVertices; vertex++) {
+            __m256i* const vertexDistance = reinterpret_cast<__m256i*>(dist + (vertex * BatchSize));
+            __m256i result = _mm256_load_si256(vertexDistance);
+            for (u_int32_t edge = graph.firstDownwardEdge[vertex]; edge < graph.firstDownwardEdge[vertex + 1]; edge++) {
+                const __m256i tailDistance =
+                    _mm256_load_si256(reinterpret_cast<const __m256i*>(dist + (graph.downwardTail[edge] * BatchSize)));
+                const __m256i weight = _mm256_set1_epi32(graph.downwardWeight[edge]);
+                result = _mm256_min_epi32(result, _mm256_add_epi32(tailDistance, weight));
+            }
+            _mm256_store_si256(vertexDistance, result);
+        }
+#else
+        for (u_int32_t vertex = 0; vertex < numberOfVertices; vertex++) {
+            int* const vertexDistance = dist + (vertex * BatchSize);
+            for (u_int32_t edge = graph.firstDownwardEdge[vertex]; edge < graph.firstDownwardEdge[vertex + 1]; edge++) {
+                const int* const tailDistance = dist + (graph.downwardTail[edge] * BatchSize);
+                for (size_t lane = 0; lane < BatchSize; lane++) {
+                    vertexDistance[lane] =
+                        std::min(vertexDistance[lane], tailDistance[lane] + graph.downwardWeight[edge]);
+                }
+            }
+        }
+#endif
+    }
+
+    inline void clear() noexcept {
+        root[FORWARD] = noVertex;
+        root[BACKWARD] = noVertex;
+        targetDistance = INFTY;
+        collectPOIs<FORWARD>(false, INFTY);
+        collectPOIs<BACKWARD>(false, INFTY);
+    }
+
+    inline bool reachable() const noexcept { return targetDistance != INFTY; }
+
+    inline int getDistance(const Vertex = noVertex) const noexcept { return targetDistance; }
+
+    inline const std::vector<int>& getForwardDistance() const noexcept { return distance[FORWARD]; }
+
+    inline int getForwardDistance(const Vertex vertex) const noexcept { return distance[FORWARD][vertex]; }
+
+    inline const std::vector<int>& getBackwardDistance() const noexcept { return distance[BACKWARD]; }
+
+    inline int getBackwardDistance(const Vertex vertex) const noexcept { return distance[BACKWARD][vertex]; }
+
+    inline const std::vector<Vertex>& getForwardPOIs() const noexcept { return reachedPOIs[FORWARD]; }
+
+    inline const std::vector<Vertex>& getBackwardPOIs() const noexcept { return reachedPOIs[BACKWARD]; }
+
+    // Distance between the origin of the given lane of the last runBatch() and an arbitrary vertex.
+    inline int getBatchDistance(const size_t lane, const Vertex vertex) const noexcept {
+        AssertMsg(lane < batchSize, "Lane " << lane << " was not used by the last batch!");
+        return batchDistance[(sweepIndex[vertex] * BatchSize) + lane];
+    }
+
+    inline size_t getNumberOfLevels() const noexcept { return numberOfLevels; }
+
+    inline long long byteSize() const noexcept {
+        long long result = Vector::byteSize(sweepIndex);
+        for (const int i : {FORWARD, BACKWARD}) {
+            result += Vector::byteSize(sweepGraph[i].firstUpwardEdge);
+            result += Vector::byteSize(sweepGraph[i].upwardHead);
+            result += Vector::byteSize(sweepGraph[i].upwardWeight);
+            result += Vector::byteSize(sweepGraph[i].firstDownwardEdge);
+            result += Vector::byteSize(sweepGraph[i].downwardTail);
+            result += Vector::byteSize(sweepGraph[i].downwardWeight);
+            result += Vector::byteSize(sweepDistance[i]);
+        }
+        result += batchDistance.size() * sizeof(int);
+        return result;
+    }
+
+private:
+    // The depth of a vertex is 0 if it has no upward edges, and 1 + the maximum depth of its upward neighbors
+    // otherwise. Sorting by depth yields a topological order of the downward edges of both directions.
+    inline std::vector<Vertex> computeSweepOrder(const Graph& forward, const Graph& backward) noexcept {
+        std::vector<u_int32_t> remainingUpwardEdges(numberOfVertices, 0);
+        std::vector<u_int32_t> firstLowerNeighbor(numberOfVertices + 1, 0);
+        for (const Vertex vertex : forward.vertices()) {
+            remainingUpwardEdges[vertex] = forward.outDegree(vertex) + backward.outDegree(vertex);
+            for (const Graph* graph : {&forward, &backward}) {
+                for (const Edge edge : graph->edgesFrom(vertex)) {
+                    firstLowerNeighbor[graph->get(ToVertex, edge) + 1]++;
+                }
+            }
+        }
+        for (size_t i = 1; i <= numberOfVertices; i++) {
+            firstLowerNeighbor[i] += firstLowerNeighbor[i - 1];
+        }
+        std::vector<Vertex> lowerNeighbors(firstLowerNeighbor.back());
+        std::vector<u_int32_t> nextLowerNeighbor(firstLowerNeighbor.begin(), firstLowerNeighbor.end() - 1);
+        for (const Vertex vertex : forward.vertices()) {
+            for (const Graph* graph : {&forward, &backward}) {
+                for (const Edge edge : graph->edgesFrom(vertex)) {
+                    lowerNeighbors[nextLowerNeighbor[graph->get(ToVertex, edge)]++] = vertex;
+                }
+            }
+        }
+
+        std::vector<u_int32_t> depth(numberOfVertices, 0);
+        std::vector<Vertex> order;
+        order.reserve(numberOfVertices);
+        for (const Vertex vertex : forward.vertices()) {
+            if (remainingUpwardEdges[vertex] == 0) order.emplace_back(vertex);
+        }
+        for (size_t i = 0; i < order.size(); i++) {
+            const Vertex vertex = order[i];
+            for (u_int32_t j = firstLowerNeighbor[vertex]; j < firstLowerNeighbor[vertex + 1]; j++) {
+                const Vertex lower = lowerNeighbors[j];
+                depth[lower] = std::max(depth[lower], depth[vertex] + 1);
+                if (--remainingUpwardEdges[lower] == 0) order.emplace_back(lower);
+            }
+        }
+        AssertMsg(order.size() == numberOfVertices, "The upward graphs contain a cycle!");
+
+        numberOfLevels = (numberOfVertices == 0) ? 0 : (*std::max_element(depth.begin(), depth.end()) + 1);
+        std::stable_sort(order.begin(), order.end(),
+                         [&](const Vertex a, const Vertex b) { return depth[a] < depth[b]; });
+        for (size_t i = 0; i < numberOfVertices; i++) {
+            sweepIndex[order[i]] = i;
+        }
+        return order;
+    }
+
+    template <int I>
+    inline void buildSweepGraph(const std::vector<Vertex>& sweepOrder, const Graph& upward, const Graph& downward,
+                                const std::vector<int>& upwardWeight, const std::vector<int>& downwardWeight) noexcept {
+        SweepGraph& graph = sweepGraph[I];
+        graph.firstUpwardEdge.assign(1, 0);
+        graph.firstDownwardEdge.assign(1, 0);
+        for (const Vertex vertex : sweepOrder) {
+            for (const Edge edge : upward.edgesFrom(vertex)) {
+                graph.upwardHead.emplace_back(sweepIndex[upward.get(ToVertex, edge)]);
+                graph.upwardWeight.emplace_back(upwardWeight[edge]);
+            }
+            graph.firstUpwardEdge.emplace_back(graph.upwardHead.size());
+            for (const Edge edge : downward.edgesFrom(vertex)) {
+                AssertMsg(sweepIndex[downward.get(ToVertex, edge)] < sweepIndex[vertex], "Edge is not upward!");
+                graph.downwardTail.emplace_back(sweepIndex[downward.get(ToVertex, edge)]);
+                graph.downwardWeight.emplace_back(downwardWeight[edge]);
+            }
+            graph.firstDownwardEdge.emplace_back(graph.downwardTail.size());
+        }
+    }
+
+    template <int I, typename SETTLE_CALLBACK>
+    inline void upwardSearch(const Vertex origin, const SETTLE_CALLBACK& settle) noexcept {
+        const SweepGraph& graph = sweepGraph[I];
+        touchedLabels.clear();
+        upwardLabels[sweepIndex[origin]].distance = 0;
+        touchedLabels.emplace_back(sweepIndex[origin]);
+        Q.update(&upwardLabels[sweepIndex[origin]]);
+        while (!Q.empty()) {
+            const UpwardLabel* label = Q.extractFront();
+            const u_int32_t vertex = label - &(upwardLabels[0]);
+            settle(vertex, label->distance);
+            for (u_int32_t edge = graph.firstUpwardEdge[vertex]; edge < graph.firstUpwardEdge[vertex + 1]; edge++) {
+                UpwardLabel& head = upwardLabels[graph.upwardHead[edge]];
+                const int newDistance = label->distance + graph.upwardWeight[edge];
+                if (newDistance >= head.distance) continue;
+                if (head.distance == INFTY) touchedLabels.emplace_back(graph.upwardHead[edge]);
+                head.distance = newDistance;
+                Q.update(&head);
+            }
+        }
+        for (const u_int32_t vertex : touchedLabels) {
+            upwardLabels[vertex].distance = INFTY;
+        }
+    }
+
+    template <int I>
+    inline void sweep(const Vertex origin) noexcept {
+        const SweepGraph& graph = sweepGraph[I];
+        int* const dist = sweepDistance[I].data();
+        std::fill(sweepDistance[I].begin(), sweepDistance[I].end(), INFTY);
+        upwardSearch<I>(origin, [&](const u_int32_t vertex, const int d) { dist[vertex] = d; });
+        for (u_int32_t vertex = 0; vertex < numberOfVertices; vertex++) {
+            int result = dist[vertex];
+            for (u_int32_t edge = graph.firstDownwardEdge[vertex]; edge < graph.firstDownwardEdge[vertex + 1]; edge++) {
+                result = std::min(result, dist[graph.downwardTail[edge]] + graph.downwardWeight[edge]);
+            }
+            dist[vertex] = result;
+        }
+    }
+
+    template <int I>
+    inline void collectPOIs(const bool swept, const int maxDistance) noexcept {
+        reachedPOIs[I].clear();
+        if (!swept) {
+            std::fill(distance[I].begin(), distance[I].end(), INFTY);
+            return;
+        }
+        for (Vertex poi = Vertex(0); poi < endOfPOIs; poi++) {
+            const int dist = sweepDistance[I][sweepIndex[poi]];
+            if (dist == INFTY || dist > maxDistance) {
+                distance[I][poi] = INFTY;
+            } else {
+                distance[I][poi] = dist;
+                reachedPOIs[I].emplace_back(poi);
+            }
+        }
+    }
+
+private:
+    size_t numberOfVertices;
+    size_t numberOfLevels;
+    std::vector<u_int32_t> sweepIndex;
+    SweepGraph sweepGraph[2];
+
+    ExternalKHeap<2, UpwardLabel> Q;
+    std::vector<UpwardLabel> upwardLabels;
+    std::vector<u_int32_t> touchedLabels;
+
+    std::vector<int> sweepDistance[2];
+    std::vector<int> distance[2];
+
+    Vertex root[2];
+
+    Vertex endOfPOIs;
+    std::vector<Vertex> reachedPOIs[2];
+
+    int targetDistance;
+
+    size_t batchSize;
+    std::vector<int, aligned_allocator<int, 32>> batchDistance;
+
+    Timer timer;
+};
+
+} // namespace CH
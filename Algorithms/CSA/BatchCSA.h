@@ -0,0 +1,224 @@
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+#ifdef USE_SIMD
+#include <immintrin.h>
+#endif
+
+#include "../../DataStructures/CSA/Data.h"
+#include "../../DataStructures/CSA/Entities/DepartureTimeIndex.h"
+#include "../../Helpers/Assert.h"
+#include "../../Helpers/Types.h"
+#include "../../Helpers/Vector/Vector.h"
+#include "../../Helpers/aligned_allocator.h"
+
+namespace CSA {
+
+// Transitive earliest arrival CSA for a batch of up to BATCH_SIZE independent queries, each with its own source,
+// departure time and (optional) target. Every query occupies one lane: A stop holds one arrival time per lane, and the
+// arrival times of all lanes at a stop are stored contiguously. A trip holds a bitmask of the lanes in which it has
+// been reached. The connections are scanned once per batch, starting at the earliest departure time of the batch, and
+// each connection is processed for all lanes at once. With target pruning, the scan stops as soon as the departure
+// time exceeds the arrival time at the target in every lane. Journeys are not retrieved.
+template <size_t BATCH_SIZE = 8>
+class BatchCSA {
+public:
+    inline static constexpr size_t BatchSize = BATCH_SIZE;
+    inline static constexpr size_t BlockSize = 8;
+    inline static constexpr size_t NumberOfBlocks = BatchSize / BlockSize;
+    static_assert(BatchSize > 0 && BatchSize % BlockSize == 0 && BatchSize <= 32,
+                  "Batch size must be a positive multiple of 8 and at most 32!");
+    using Type = BatchCSA<BatchSize>;
+    using LaneMask = u_int32_t;
+
+public:
+    BatchCSA(const Data& data)
+        : data(data),
+          numberOfQueries(0),
+          arrivalTimes(data.numberOfStops() * BatchSize, never),
+          tripReached(data.numberOfTrips(), 0),
+          isTarget(data.numberOfStops(), false),
+          targetPruning(false),
+          pruningTime(never),
+          departureTimeIndex(data.connections),
+          numberOfScannedConnections(0) {
+        AssertMsg(Vector::isSorted(data.connections), "Connections must be sorted in ascending order!");
+    }
+
+    // Runs one batch of at most BatchSize queries. If targets are given, there must be one per query, and the scan is
+    // pruned once every target has been reached.
+    inline void run(const std::vector<StopId>& sources, const std::vector<int>& departureTimes,
+                    const std::vector<StopId>& targets = std::vector<StopId>()) noexcept {
+        AssertMsg(sources.size() <= BatchSize, "Too many queries for one batch (" << sources.size() << ")!");
+        AssertMsg(departureTimes.size() == sources.size(), "There must be one departure time per source!");
+        AssertMsg(targets.empty() || targets.size() == sources.size(), "There must be one target per source!");
+        clear();
+        if (sources.empty()) return;
+        initialize(sources, departureTimes, targets);
+        const int firstDepartureTime = *std::min_element(departureTimes.begin(), departureTimes.end());
+        scanConnections(departureTimeIndex.firstConnectionDepartingAt(firstDepartureTime), data.connections.size());
+    }
+
+    inline bool reachable(const size_t lane, const StopId stop) const noexcept {
+        return getEarliestArrivalTime(lane, stop) < never;
+    }
+
+    inline int getEarliestArrivalTime(const size_t lane, const StopId stop) const noexcept {
+        AssertMsg(lane < numberOfQueries, "Lane " << lane << " is out of range!");
+        AssertMsg(data.isStop(stop), "Stop " << stop << " is out of range!");
+        return arrivalTimes[stop * BatchSize + lane];
+    }
+
+    inline const int* getEarliestArrivalTimes(const StopId stop) const noexcept {
+        AssertMsg(data.isStop(stop), "Stop " << stop << " is out of range!");
+        return arrivalTimes.data() + stop * BatchSize;
+    }
+
+    inline size_t getNumberOfScannedConnections() const noexcept { return numberOfScannedConnections; }
+
+    inline long long byteSize() const noexcept {
+        return arrivalTimes.capacity() * sizeof(int) + Vector::byteSize(tripReached) + departureTimeIndex.byteSize();
+    }
+
+private:
+    inline void clear() noexcept {
+        std::fill(arrivalTimes.begin(), arrivalTimes.end(), never);
+        std::fill(tripReached.begin(), tripReached.end(), 0);
+        for (const StopId target : targets) {
+            if (target != noStop) isTarget[target] = false;
+        }
+        targets.clear();
+        targetPruning = false;
+        pruningTime = never;
+        numberOfQueries = 0;
+        numberOfScannedConnections = 0;
+    }
+
+    inline void initialize(const std::vector<StopId>& sources, const std::vector<int>& departureTimes,
+                           const std::vector<StopId>& targetStops) noexcept {
+        numberOfQueries = sources.size();
+        if (!targetStops.empty()) {
+            targets = targetStops;
+            targetPruning = std::find(targets.begin(), targets.end(), noStop) == targets.end();
+            for (const StopId target : targets) {
+                if (target != noStop) isTarget[target] = true;
+            }
+        }
+        for (size_t lane = 0; lane < numberOfQueries; lane++) {
+            AssertMsg(data.isStop(sources[lane]), "Source " << sources[lane] << " is not a stop!");
+            AssertMsg(targets.empty() || targets[lane] == noStop || data.isStop(targets[lane]),
+                      "Target " << targets[lane] << " is not a stop!");
+            const LaneMask lanes = LaneMask(1) << lane;
+            improveArrivalTimes(sources[lane], departureTimes[lane], lanes);
+            relaxEdges(sources[lane], departureTimes[lane], lanes);
+        }
+    }
+
+    inline void scanConnections(const size_t begin, const size_t end) noexcept {
+        for (size_t i = begin; i < end; i++) {
+            const Connection& connection = data.connections[i];
+            if (targetPruning && connection.departureTime > pruningTime) break;
+            numberOfScannedConnections++;
+            const int latestArrivalTime = connection.departureTime - data.minTransferTime(connection.departureStopId);
+            const LaneMask reached = tripReached[connection.tripId]
+                                     | lanesArrivingBy(connection.departureStopId, latestArrivalTime);
+            if (reached == 0) continue;
+            tripReached[connection.tripId] = reached;
+            const LaneMask improved = improveArrivalTimes(connection.arrivalStopId, connection.arrivalTime, reached);
+            if (improved == 0) continue;
+            relaxEdges(connection.arrivalStopId, connection.arrivalTime, improved);
+        }
+    }
+
+    inline void relaxEdges(const StopId stop, const int time, const LaneMask lanes) noexcept {
+        for (const Edge edge : data.transferGraph.edgesFrom(stop)) {
+            const StopId toStop = StopId(data.transferGraph.get(ToVertex, edge));
+            improveArrivalTimes(toStop, time + data.transferGraph.get(TravelTime, edge), lanes);
+        }
+    }
+
+    // Sets the arrival time at the stop to the given time in every given lane where this is an improvement, and
+    // returns the improved lanes.
+    inline LaneMask improveArrivalTimes(const StopId stop, const int time, const LaneMask lanes) noexcept {
+        int* labels = arrivalTimes.data() + stop * BatchSize;
+        LaneMask improved = 0;
+#if defined(USE_SIMD) && defined(__AVX2__)
+        const __m256i times = _mm256_set1_epi32(time);
+        for (size_t block = 0; block < NumberOfBlocks; block++) {
+            const LaneMask blockLanes = (lanes >> (block * BlockSize)) & 0xFF;
+            if (blockLanes == 0) continue;
+            __m256i* label = reinterpret_cast<__m256i*>(labels + block * BlockSize);
+            const __m256i oldLabel = _mm256_load_si256(label);
+            const __m256i better = _mm256_and_si256(_mm256_cmpgt_epi32(oldLabel, times), expandLaneMask(blockLanes));
+            _mm256_store_si256(label, _mm256_blendv_epi8(oldLabel, times, better));
+            improved |= LaneMask(_mm256_movemask_ps(_mm256_castsi256_ps(better))) << (block * BlockSize);
+        }
+#else
+        for (size_t lane = 0; lane < BatchSize; lane++) {
+            if (!(lanes & (LaneMask(1) << lane)) || labels[lane] <= time) continue;
+            labels[lane] = time;
+            improved |= LaneMask(1) << lane;
+        }
+#endif
+        if (improved != 0 && isTarget[stop]) updatePruningTime();
+        return improved;
+    }
+
+    // Returns the lanes in which the stop is reached at or before the given time.
+    inline LaneMask lanesArrivingBy(const StopId stop, const int time) const noexcept {
+        const int* labels = arrivalTimes.data() + stop * BatchSize;
+        LaneMask lanes = 0;
+#if defined(USE_SIMD) && defined(__AVX2__)
+        const __m256i times = _mm256_set1_epi32(time);
+        for (size_t block = 0; block < NumberOfBlocks; block++) {
+            const __m256i label = _mm256_load_si256(reinterpret_cast<const __m256i*>(labels + block * BlockSize));
+            const LaneMask tooLate = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(label, times)));
+            lanes |= (~tooLate & 0xFF) << (block * BlockSize);
+        }
+#else
+        for (size_t lane = 0; lane < BatchSize; lane++) {
+            if (labels[lane] <= time) lanes |= LaneMask(1) << lane;
+        }
+#endif
+        return lanes;
+    }
+
+#if defined(USE_SIMD) && defined(__AVX2__)
+    // Expands the lowest 8 bits of the mask to one all-ones or all-zeros 32-bit value per lane.
+    inline static __m256i expandLaneMask(const LaneMask lanes) noexcept {
+        const __m256i laneBits = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+        return _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_set1_epi32(lanes), laneBits), laneBits);
+    }
+#endif
+
+    // The scan can be stopped once the departure time exceeds the arrival time at the target in every lane. Arrival
+    // times only decrease, so the pruning time has to be recomputed only when the arrival time at a target improves.
+    inline void updatePruningTime() noexcept {
+        if (!targetPruning) return;
+        pruningTime = -never;
+        for (size_t lane = 0; lane < numberOfQueries; lane++) {
+            pruningTime = std::max(pruningTime, arrivalTimes[targets[lane] * BatchSize + lane]);
+        }
+    }
+
+private:
+    const Data& data;
+
+    size_t numberOfQueries;
+
+    std::vector<int, aligned_allocator<int, 32>> arrivalTimes;
+    std::vector<LaneMask> tripReached;
+
+    std::vector<StopId> targets;
+    std::vector<bool> isTarget;
+    bool targetPruning;
+    int pruningTime;
+
+    DepartureTimeIndex departureTimeIndex;
+
+    size_t numberOfScannedConnections;
+};
+
+} // namespace CSA
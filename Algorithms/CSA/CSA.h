@@ -7,7 +7,10 @@
 #include <vector>
 
 #include "../../DataStructures/CSA/Data.h"
+#include "../../DataStructures/CSA/Entities/ConnectionArrays.h"
+#include "../../DataStructures/CSA/Entities/DepartureTimeIndex.h"
 #include "../../DataStructures/CSA/Entities/Journey.h"
+#include "../../DataStructures/Container/ResettableVector.h"
 #include "../../Helpers/Assert.h"
 #include "../../Helpers/Timer.h"
 #include "../../Helpers/Types.h"
@@ -15,13 +18,19 @@
 
 namespace CSA {
 
-template <bool PATH_RETRIEVAL = true, typename PROFILER = NoProfiler, bool LIMITED_WALKING = true>
+template <bool PATH_RETRIEVAL = true, typename PROFILER = NoProfiler, bool LIMITED_WALKING = true,
+          bool COMPRESSED_TIMES = false>
 class CSA {
 public:
     constexpr static bool PathRetrieval = PATH_RETRIEVAL;
     using Profiler = PROFILER;
-    using Type = CSA<PathRetrieval, Profiler, LIMITED_WALKING>;
+    constexpr static bool CompressedTimes = COMPRESSED_TIMES;
+    using Type = CSA<PathRetrieval, Profiler, LIMITED_WALKING, CompressedTimes>;
     using TripFlag = Meta::IF<PathRetrieval, ConnectionId, bool>;
+    using Connections = ConnectionArrays<CompressedTimes>;
+    using HotConnection = typename Connections::HotConnection;
+    // Number of connections ahead of the current one whose stop and trip labels are prefetched.
+    constexpr static size_t PrefetchDistance = 8;
 
 private:
     struct ParentLabel {
@@ -44,6 +53,8 @@ public:
           tripReached(data.numberOfTrips(), TripFlag()),
           arrivalTime(data.numberOfStops(), never),
           parentLabel(PathRetrieval ? data.numberOfStops() : 0),
+          connections(data.connections),
+          departureTimeIndex(data.connections),
           profiler(profilerTemplate) {
         AssertMsg(Vector::isSorted(data.connections), "Connections must be sorted in ascending order!");
         profiler.registerPhases({PHASE_CLEAR, PHASE_INITIALIZATION, PHASE_CONNECTION_SCAN});
@@ -62,7 +73,7 @@ public:
         profiler.startPhase();
         sourceStop = source;
         targetStop = target;
-        arrivalTime[sourceStop] = departureTime;
+        arrivalTime.set(sourceStop, departureTime);
         relaxEdges(sourceStop, departureTime);
         const ConnectionId firstConnection = firstReachableConnection(departureTime);
         profiler.donePhase(PHASE_INITIALIZATION);
@@ -115,49 +126,62 @@ private:
     inline void clear() {
         sourceStop = noStop;
         targetStop = noStop;
-        Vector::fill(arrivalTime, never);
-        Vector::fill(tripReached, TripFlag());
-        if constexpr (PathRetrieval) {
-            Vector::fill(parentLabel, ParentLabel());
-        }
+        // Parent labels are written whenever an arrival time is set, so they do not have to be reset.
+        arrivalTime.clear();
+        tripReached.clear();
     }
 
     inline ConnectionId firstReachableConnection(const int departureTime) const noexcept {
-        return ConnectionId(Vector::lowerBound(data.connections, departureTime,
-                                               [](const Connection& connection, const int time) {
-            return connection.departureTime < time;
-        }));
+        return departureTimeIndex.firstConnectionDepartingAt(departureTime);
     }
 
     inline void scanConnections(const ConnectionId begin, const ConnectionId end) noexcept {
-        for (ConnectionId i = begin; i < end; i++) {
-            const Connection& connection = data.connections[i];
-            if (targetStop != noStop && connection.departureTime > arrivalTime[targetStop]) break;
+        for (size_t block = connections.blockOf(begin); block < connections.numberOfBlocks(); block++) {
+            const size_t blockBegin = std::max<size_t>(begin, connections.beginOfBlock(block));
+            const size_t blockEnd = std::min<size_t>(end, connections.endOfBlock(block));
+            if (blockBegin >= end) break;
+            if (!scanConnectionsOfBlock(connections.baseTime(block), blockBegin, blockEnd)) break;
+        }
+    }
 
-            if (connectionIsReachable(connection, i)) {
+    // Returns false if the scan was stopped by target pruning.
+    inline bool scanConnectionsOfBlock(const int baseTime, const size_t begin, const size_t end) noexcept {
+        for (size_t i = begin; i < end; i++) {
+            if (i + PrefetchDistance < end) {
+                const HotConnection& nextConnection = connections.hot(i + PrefetchDistance);
+                __builtin_prefetch(&tripReached[nextConnection.tripId]);
+                __builtin_prefetch(&arrivalTime[nextConnection.departureStopId]);
+            }
+            const int departureTime = baseTime + connections.departureTimeOffset(i);
+            if (targetStop != noStop && departureTime > arrivalTime[targetStop]) return false;
+
+            const HotConnection& connection = connections.hot(i);
+            if (connectionIsReachable(connection, departureTime, ConnectionId(i))) {
                 profiler.countMetric(METRIC_CONNECTIONS);
-                arrivalByTrip(connection.arrivalStopId, connection.arrivalTime, connection.tripId);
+                arrivalByTrip(connections.arrivalStopId(i), connections.arrivalTime(i), connection.tripId);
             }
         }
+        return true;
     }
 
-    inline bool connectionIsReachableFromStop(const Connection& connection) const noexcept {
+    inline bool connectionIsReachableFromStop(const HotConnection& connection, const int departureTime) const noexcept {
         return arrivalTime[connection.departureStopId]
-               <= connection.departureTime - data.minTransferTime(connection.departureStopId);
+               <= departureTime - data.minTransferTime(connection.departureStopId);
     }
 
-    inline bool connectionIsReachableFromTrip(const Connection& connection) const noexcept {
+    inline bool connectionIsReachableFromTrip(const HotConnection& connection) const noexcept {
         return tripReached[connection.tripId] != TripFlag();
     }
 
-    inline bool connectionIsReachable(const Connection& connection, const ConnectionId id) noexcept {
+    inline bool connectionIsReachable(const HotConnection& connection, const int departureTime,
+                                      const ConnectionId id) noexcept {
         if (connectionIsReachableFromTrip(connection)) return true;
-        if (connectionIsReachableFromStop(connection)) {
+        if (connectionIsReachableFromStop(connection, departureTime)) {
             if constexpr (PathRetrieval) {
-                tripReached[connection.tripId] = id;
+                tripReached.set(connection.tripId, id);
             } else {
                 suppressUnusedParameterWarning(id);
-                tripReached[connection.tripId] = true;
+                tripReached.set(connection.tripId, true);
             }
             return true;
         }
@@ -167,11 +191,12 @@ private:
     inline void arrivalByTrip(const StopId stop, const int time, const TripId trip) noexcept {
         if (LIMITED_WALKING && arrivalTime[stop] <= time) return;
         profiler.countMetric(METRIC_STOPS_BY_TRIP);
-        arrivalTime[stop] = time;
+        arrivalTime.set(stop, time);
         if constexpr (PathRetrieval) {
-            parentLabel[stop].parent = data.connections[tripReached[trip]].departureStopId;
-            parentLabel[stop].reachedByTransfer = false;
-            parentLabel[stop].tripId = trip;
+            ParentLabel& label = parentLabel[stop];
+            label.parent = data.connections[tripReached[trip]].departureStopId;
+            label.reachedByTransfer = false;
+            label.tripId = trip;
         }
         relaxEdges(stop, time);
     }
@@ -188,11 +213,12 @@ private:
     inline void arrivalByTransfer(const StopId stop, const int time, const StopId parent, const Edge edge) noexcept {
         if (arrivalTime[stop] <= time) return;
         profiler.countMetric(METRIC_STOPS_BY_TRANSFER);
-        arrivalTime[stop] = time;
+        arrivalTime.set(stop, time);
         if constexpr (PathRetrieval) {
-            parentLabel[stop].parent = parent;
-            parentLabel[stop].reachedByTransfer = true;
-            parentLabel[stop].transferId = edge;
+            ParentLabel& label = parentLabel[stop];
+            label.parent = parent;
+            label.reachedByTransfer = true;
+            label.transferId = edge;
         }
     }
 
@@ -202,10 +228,13 @@ private:
     StopId sourceStop;
     StopId targetStop;
 
-    std::vector<TripFlag> tripReached;
-    std::vector<int> arrivalTime;
+    ResettableVector<TripFlag> tripReached;
+    ResettableVector<int> arrivalTime;
     std::vector<ParentLabel> parentLabel;
 
+    Connections connections;
+    DepartureTimeIndex departureTimeIndex;
+
     Profiler profiler;
 };
 } // namespace CSA
@@ -7,7 +7,9 @@
 #include <vector>
 
 #include "../../DataStructures/Container/ExternalKHeap.h"
+#include "../../DataStructures/Container/ResettableVector.h"
 #include "../../DataStructures/CSA/Data.h"
+#include "../../DataStructures/CSA/Entities/DepartureTimeIndex.h"
 #include "../../DataStructures/CSA/Entities/Journey.h"
 #include "../../Helpers/Assert.h"
 #include "../../Helpers/Timer.h"
@@ -37,9 +39,10 @@ private:
     };
 
     struct DijkstraLabel : public ExternalKHeapElement {
-        DijkstraLabel() : arrivalTime(never), parent(noVertex) {}
+        DijkstraLabel() : arrivalTime(never), parent(noVertex), timestamp(0) {}
         int arrivalTime;
         Vertex parent;
+        u_int32_t timestamp;
         inline bool hasSmallerKey(const DijkstraLabel* const other) const noexcept {
             return arrivalTime < other->arrivalTime;
         }
@@ -58,6 +61,8 @@ public:
           arrivalTime(data.numberOfStops() + 1, never),
           parentLabel(PathRetrieval ? data.numberOfStops() + 1 : 0),
           dijkstraLabels(data.transferGraph.numVertices()),
+          dijkstraTimestamp(0),
+          departureTimeIndex(data.connections),
           profiler(profilerTemplate) {
         AssertMsg(Vector::isSorted(data.connections), "Connections must be sorted in ascending order!");
         profiler.registerPhases({PHASE_CLEAR, PHASE_INITIALIZATION, PHASE_CONNECTION_SCAN});
@@ -89,7 +94,7 @@ public:
         targetVertex = target;
         targetStop = data.isStop(target) ? StopId(target) : StopId(data.numberOfStops());
         if (data.isStop(source)) {
-            arrivalTime[source] = departureTime;
+            arrivalTime.set(source, departureTime);
         }
         runInitialTransfers();
         const ConnectionId firstConnection = firstReachableConnection(departureTime);
@@ -153,20 +158,15 @@ private:
         sourceDepartureTime = never;
         targetVertex = noVertex;
         targetStop = noStop;
-        Vector::fill(arrivalTime, never);
-        Vector::fill(tripReached, TripFlag());
-        Vector::fill(dijkstraLabels, DijkstraLabel());
+        // Parent labels are written whenever an arrival time is set, so they do not have to be reset.
+        arrivalTime.clear();
+        tripReached.clear();
+        dijkstraTimestamp++;
         queue.clear();
-        if constexpr (PathRetrieval) {
-            Vector::fill(parentLabel, ParentLabel());
-        }
     }
 
     inline ConnectionId firstReachableConnection(const int departureTime) const noexcept {
-        return ConnectionId(Vector::lowerBound(data.connections, departureTime,
-                                               [](const Connection& connection, const int time) {
-            return connection.departureTime < time;
-        }));
+        return departureTimeIndex.firstConnectionDepartingAt(departureTime);
     }
 
     inline void scanConnections(const ConnectionId begin, const ConnectionId end) noexcept {
@@ -194,10 +194,10 @@ private:
         if (connectionIsReachableFromTrip(connection)) return true;
         if (connectionIsReachableFromStop(connection)) {
             if constexpr (PathRetrieval) {
-                tripReached[connection.tripId] = id;
+                tripReached.set(connection.tripId, id);
             } else {
                 suppressUnusedParameterWarning(id);
-                tripReached[connection.tripId] = true;
+                tripReached.set(connection.tripId, true);
             }
             return true;
         }
@@ -207,10 +207,11 @@ private:
     inline void arrivalByTrip(const StopId stop, const int time, const TripId trip) noexcept {
         if (arrivalTime[stop] <= time) return;
         profiler.countMetric(METRIC_STOPS_BY_TRIP);
-        arrivalTime[stop] = time;
+        arrivalTime.set(stop, time);
         if constexpr (PathRetrieval) {
-            parentLabel[stop].parent = data.connections[tripReached[trip]].departureStopId;
-            parentLabel[stop].tripId = trip;
+            ParentLabel& label = parentLabel[stop];
+            label.parent = data.connections[tripReached[trip]].departureStopId;
+            label.tripId = trip;
         } else {
             suppressUnusedParameterWarning(trip);
         }
@@ -259,19 +260,31 @@ private:
     }
 
     inline void arrivalByEdge(const Vertex vertex, const int time, const Vertex parent) noexcept {
-        if (dijkstraLabels[vertex].arrivalTime <= time) return;
-        dijkstraLabels[vertex].arrivalTime = time;
-        dijkstraLabels[vertex].parent = parent;
-        queue.update(&dijkstraLabels[vertex]);
+        DijkstraLabel& label = getDijkstraLabel(vertex);
+        if (label.arrivalTime <= time) return;
+        label.arrivalTime = time;
+        label.parent = parent;
+        queue.update(&label);
+    }
+
+    inline DijkstraLabel& getDijkstraLabel(const Vertex vertex) noexcept {
+        DijkstraLabel& label = dijkstraLabels[vertex];
+        if (label.timestamp != dijkstraTimestamp) {
+            label.arrivalTime = never;
+            label.parent = noVertex;
+            label.timestamp = dijkstraTimestamp;
+        }
+        return label;
     }
 
     inline void arrivalByTransfer(const StopId stop, const int time, const Vertex parent) noexcept {
         if (arrivalTime[stop] <= time) return;
         profiler.countMetric(METRIC_STOPS_BY_TRANSFER);
-        arrivalTime[stop] = time;
+        arrivalTime.set(stop, time);
         if constexpr (PathRetrieval) {
-            parentLabel[stop].parent = parent;
-            parentLabel[stop].tripId = noTripId;
+            ParentLabel& label = parentLabel[stop];
+            label.parent = parent;
+            label.tripId = noTripId;
         } else {
             suppressUnusedParameterWarning(parent);
         }
@@ -286,12 +299,15 @@ private:
     Vertex targetVertex;
     StopId targetStop;
 
-    std::vector<TripFlag> tripReached;
-    std::vector<int> arrivalTime;
+    ResettableVector<TripFlag> tripReached;
+    ResettableVector<int> arrivalTime;
     std::vector<ParentLabel> parentLabel;
     std::vector<DijkstraLabel> dijkstraLabels;
+    u_int32_t dijkstraTimestamp;
     ExternalKHeap<2, DijkstraLabel> queue;
 
+    DepartureTimeIndex departureTimeIndex;
+
     Profiler profiler;
 };
 } // namespace CSA
@@ -7,7 +7,10 @@
 #include <vector>
 
 #include "../../DataStructures/CSA/Data.h"
+#include "../../DataStructures/CSA/Entities/DepartureTimeIndex.h"
 #include "../../DataStructures/CSA/Entities/Journey.h"
+#include "../../DataStructures/Container/HubLabels.h"
+#include "../../DataStructures/Container/ResettableVector.h"
 #include "../../Helpers/Assert.h"
 #include "../../Helpers/Timer.h"
 #include "../../Helpers/Types.h"
@@ -36,28 +39,33 @@ private:
     };
 
 public:
-    HLCSA(const Data& data, const TransferGraph& outHubGraph, const TransferGraph& inHubGraph,
+    HLCSA(const Data& data, const HubLabels& outHubLabels, const HubLabels& inHubLabels,
           const Profiler& profilerTemplate = Profiler())
         : data(data),
-          outHubs(outHubGraph),
-          inHubs(inHubGraph),
+          outHubs(outHubLabels),
+          inHubs(inHubLabels),
           transferDistanceToTarget(inHubs.numVertices(), INFTY),
           sourceVertex(noVertex),
           sourceDepartureTime(never),
           targetVertex(noVertex),
           lastTarget(Vertex(0)),
           tripReached(data.numberOfTrips(), TripFlag()),
-          arrivalTime(inHubGraph.numVertices(), never),
-          parentLabel(inHubGraph.numVertices()),
+          arrivalTime(inHubs.numVertices(), never),
+          parentLabel(inHubs.numVertices()),
+          departureTimeIndex(data.connections),
           profiler(profilerTemplate) {
         AssertMsg(Vector::isSorted(data.connections), "Connections must be sorted in ascending order!");
         profiler.registerPhases({PHASE_CLEAR, PHASE_INITIALIZATION, PHASE_CONNECTION_SCAN});
         profiler.registerMetrics({METRIC_CONNECTIONS, METRIC_EDGES, METRIC_STOPS_BY_TRIP});
         profiler.initialize();
-        outHubs.sortEdges(TravelTime);
-        inHubs.sortEdges(TravelTime);
+        outHubs.setSortedByDistance(true);
+        inHubs.setSortedByDistance(true);
     }
 
+    HLCSA(const Data& data, const TransferGraph& outHubGraph, const TransferGraph& inHubGraph,
+          const Profiler& profilerTemplate = Profiler())
+        : HLCSA(data, HubLabels(outHubGraph, true), HubLabels(inHubGraph, true), profilerTemplate) {}
+
     inline void run(const Vertex source, const int departureTime, const Vertex target = noVertex) noexcept {
         profiler.start();
 
@@ -70,7 +78,7 @@ public:
         sourceDepartureTime = departureTime;
         targetVertex = target;
 
-        arrivalTime[sourceVertex] = departureTime;
+        arrivalTime.set(sourceVertex, departureTime);
         runInitialTransfers();
         const ConnectionId firstConnection = firstReachableConnection(departureTime);
         profiler.donePhase(PHASE_INITIALIZATION);
@@ -125,16 +133,13 @@ private:
         sourceVertex = noVertex;
         sourceDepartureTime = never;
         targetVertex = noVertex;
-        Vector::fill(arrivalTime, never);
-        Vector::fill(tripReached, TripFlag());
-        Vector::fill(parentLabel, ParentLabel());
+        // Parent labels are written whenever an arrival time is set, so they do not have to be reset.
+        arrivalTime.clear();
+        tripReached.clear();
     }
 
     inline ConnectionId firstReachableConnection(const int departureTime) const noexcept {
-        return ConnectionId(Vector::lowerBound(data.connections, departureTime,
-                                               [](const Connection& connection, const int time) {
-            return connection.departureTime < time;
-        }));
+        return departureTimeIndex.firstConnectionDepartingAt(departureTime);
     }
 
     inline void scanConnections(const ConnectionId begin, const ConnectionId end) noexcept {
@@ -161,7 +166,7 @@ private:
         if (connectionIsReachableFromTrip(connection)) return true;
         scanInHubs(connection.departureStopId);
         if (connectionIsReachableFromStop(connection)) {
-            tripReached[connection.tripId] = id;
+            tripReached.set(connection.tripId, id);
             return true;
         }
         return false;
@@ -170,31 +175,32 @@ private:
     inline void arrivalByTrip(const StopId stop, const int time, const TripId trip) noexcept {
         if (arrivalTime[stop] <= time) return;
         profiler.countMetric(METRIC_STOPS_BY_TRIP);
-        arrivalTime[stop] = time;
-        parentLabel[stop].parent = data.connections[tripReached[trip]].departureStopId;
-        parentLabel[stop].reachedByTransfer = false;
-        parentLabel[stop].tripId = trip;
+        arrivalTime.set(stop, time);
+        ParentLabel& label = parentLabel[stop];
+        label.parent = data.connections[tripReached[trip]].departureStopId;
+        label.reachedByTransfer = false;
+        label.tripId = trip;
         scanOutHubs(stop);
     }
 
     inline void runInitialTransfers() noexcept {
         transferDistanceToTarget[lastTarget] = INFTY;
-        for (const Edge edge : inHubs.edgesFrom(lastTarget)) {
-            transferDistanceToTarget[inHubs.get(ToVertex, edge)] = INFTY;
+        for (const size_t entry : inHubs.entries(lastTarget)) {
+            transferDistanceToTarget[inHubs.hub(entry)] = INFTY;
         }
         transferDistanceToTarget[targetVertex] = 0;
-        for (const Edge edge : inHubs.edgesFrom(targetVertex)) {
-            transferDistanceToTarget[inHubs.get(ToVertex, edge)] = inHubs.get(TravelTime, edge);
+        for (const size_t entry : inHubs.entries(targetVertex)) {
+            transferDistanceToTarget[inHubs.hub(entry)] = inHubs.distance(entry);
         }
         lastTarget = targetVertex;
         scanOutHubs(sourceVertex);
     }
 
     inline void scanOutHubs(const Vertex from) noexcept {
-        for (const Edge edge : outHubs.edgesFrom(from)) {
+        for (const size_t entry : outHubs.entries(from)) {
             profiler.countMetric(METRIC_EDGES);
-            const Vertex hub = outHubs.get(ToVertex, edge);
-            const int newArrivalTime = arrivalTime[from] + outHubs.get(TravelTime, edge);
+            const Vertex hub = outHubs.hub(entry);
+            const int newArrivalTime = arrivalTime[from] + outHubs.distance(entry);
             if (newArrivalTime >= arrivalTime[targetVertex]) break;
             arrivalByTransfer(hub, newArrivalTime, from);
             if (transferDistanceToTarget[hub] != INFTY) {
@@ -205,10 +211,10 @@ private:
     }
 
     inline void scanInHubs(const Vertex to) noexcept {
-        for (const Edge edge : inHubs.edgesFrom(to)) {
+        for (const size_t entry : inHubs.entries(to)) {
             profiler.countMetric(METRIC_EDGES);
-            const Vertex hub = inHubs.get(ToVertex, edge);
-            const int walkingTime = inHubs.get(TravelTime, edge);
+            const Vertex hub = inHubs.hub(entry);
+            const int walkingTime = inHubs.distance(entry);
             if (sourceDepartureTime + walkingTime >= arrivalTime[to]) break;
             const int newArrivalTime = arrivalTime[hub] + walkingTime;
             arrivalByTransfer(to, newArrivalTime, hub);
@@ -217,15 +223,16 @@ private:
 
     inline void arrivalByTransfer(const Vertex vertex, const int time, const Vertex parent) noexcept {
         if (arrivalTime[vertex] <= time) return;
-        arrivalTime[vertex] = time;
-        parentLabel[vertex].parent = parent;
-        parentLabel[vertex].reachedByTransfer = true;
+        arrivalTime.set(vertex, time);
+        ParentLabel& label = parentLabel[vertex];
+        label.parent = parent;
+        label.reachedByTransfer = true;
     }
 
 private:
     const Data& data;
-    TransferGraph outHubs;
-    TransferGraph inHubs;
+    HubLabels outHubs;
+    HubLabels inHubs;
 
     std::vector<int> transferDistanceToTarget;
 
@@ -234,10 +241,12 @@ private:
     Vertex targetVertex;
     Vertex lastTarget;
 
-    std::vector<TripFlag> tripReached;
-    std::vector<int> arrivalTime;
+    ResettableVector<TripFlag> tripReached;
+    ResettableVector<int> arrivalTime;
     std::vector<ParentLabel> parentLabel;
 
+    DepartureTimeIndex departureTimeIndex;
+
     Profiler profiler;
 };
 } // namespace CSA
@@ -0,0 +1,155 @@
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+#include <omp.h>
+
+#include "ProfileCSA.h"
+
+#include "../../DataStructures/CSA/Data.h"
+#include "../../Helpers/Assert.h"
+#include "../../Helpers/MultiThreading.h"
+#include "../../Helpers/Types.h"
+#include "../../Helpers/Vector/Vector.h"
+
+namespace CSA {
+
+// Multi-threaded ProfileCSA for one-to-one profile queries. The departure time range is split into windows, which are
+// processed by the threads independently, each with its own sequential ProfileCSA. A window scans the connections
+// departing in the window and those departing up to windowOverlap seconds after its end. The reachable trips are
+// determined from the start of the whole range, as in the sequential algorithm. Of the source profile of a window,
+// only the entries departing in the window are kept. The windows are then stitched together by decreasing
+// departure time, and entries that are dominated by an entry of a later window are removed.
+// Every journey that departs in a window and arrives at most windowOverlap seconds after the end of the window is
+// found. Hence, the result is the same as that of a sequential ProfileCSA if no Pareto-optimal journey takes longer
+// than windowOverlap seconds. Otherwise, such a journey may be missing or be replaced by a slower one.
+template <bool TRANSFERS_SECOND_CRIT = true>
+class ParallelProfileCSA {
+public:
+    constexpr static bool TransfersSecondCrit = TRANSFERS_SECOND_CRIT;
+    using Search = ProfileCSA<TransfersSecondCrit, NoProfiler>;
+    using Type = ParallelProfileCSA<TransfersSecondCrit>;
+
+    struct ProfileEntry {
+        ProfileEntry(const int departureTime = never, const int arrivalTime = never,
+                     const ConnectionId enterConnection = noConnection,
+                     const ConnectionId exitConnection = noConnection)
+            : departureTime(departureTime),
+              arrivalTime(arrivalTime),
+              enterConnection(enterConnection),
+              exitConnection(exitConnection) {}
+
+        int departureTime;
+        int arrivalTime;
+        ConnectionId enterConnection;
+        ConnectionId exitConnection;
+    };
+
+public:
+    // Like ProfileCSA, this shifts the connection times of data if transfers are the second criterion.
+    ParallelProfileCSA(Data& data, const ThreadPinning& threadPinning, const int windowOverlap = 4 * 60 * 60,
+                       const size_t windowsPerThread = 1)
+        : threadPinning(threadPinning),
+          windowOverlap(windowOverlap),
+          windowsPerThread(std::max<size_t>(windowsPerThread, 1)),
+          firstDepartureTime(data.connections.empty() ? 0 : data.connections.front().departureTime),
+          lastDepartureTime(data.connections.empty() ? 0 : data.connections.back().departureTime) {
+        AssertMsg(windowOverlap >= 0, "Window overlap must not be negative!");
+        AssertMsg(Vector::isSorted(data.connections), "Connections must be sorted in ascending order!");
+        // Only the first search prepares the connection times, the others are copies that share the same data.
+        searches.reserve(threadPinning.numberOfThreads);
+        searches.emplace_back(data);
+        for (size_t i = 1; i < threadPinning.numberOfThreads; i++) {
+            searches.emplace_back(searches.front());
+        }
+    }
+
+    // Computes the profile of the source for departures in [minDepartureTime, maxDepartureTime].
+    inline void run(const StopId source, const StopId target, const int minDepartureTime = 0,
+                    const int maxDepartureTime = 24 * 60 * 60) noexcept {
+        AssertMsg(minDepartureTime < maxDepartureTime, "Departure time range is empty!");
+        computeWindows(minDepartureTime, maxDepartureTime);
+        const size_t numberOfWindows = windowBegin.size() - 1;
+        if (windowEntries.size() < numberOfWindows) windowEntries.resize(numberOfWindows);
+
+        omp_set_num_threads(threadPinning.numberOfThreads);
+#pragma omp parallel
+        {
+            threadPinning.pinThread();
+            Search& search = searches[omp_get_thread_num()];
+
+#pragma omp for schedule(dynamic, 1)
+            for (size_t window = 0; window < numberOfWindows; window++) {
+                const int begin = windowBegin[window];
+                const int end = windowBegin[window + 1];
+                search.run(source, target, minDepartureTime, std::min(end + windowOverlap, maxDepartureTime), begin);
+                // Entries departing before the first window are only found by the first window, since they are reached
+                // by walking from the source. The last window keeps all entries departing after its begin.
+                const int lowerBound = (window == 0) ? -never : Search::transformTime(begin);
+                const int upperBound = (window + 1 == numberOfWindows) ? never : Search::transformTime(end);
+                collectEntries(search.getProfiles(), source, lowerBound, upperBound, windowEntries[window]);
+            }
+        }
+
+        profile.clear();
+        int earliestArrivalTime = never;
+        for (size_t window = numberOfWindows; window-- > 0;) {
+            for (const ProfileEntry& entry : windowEntries[window]) {
+                if (entry.arrivalTime >= earliestArrivalTime) continue;
+                earliestArrivalTime = entry.arrivalTime;
+                profile.emplace_back(entry);
+            }
+        }
+    }
+
+    // The Pareto-optimal journeys of the last query, ordered by decreasing departure time. With transfers as second
+    // criterion, the times are encoded as in ProfileCSA.
+    inline const std::vector<ProfileEntry>& getProfile() const noexcept { return profile; }
+
+    inline size_t numberOfJourneys() const noexcept { return profile.size(); }
+
+    inline size_t numberOfWindows() const noexcept { return windowBegin.empty() ? 0 : windowBegin.size() - 1; }
+
+private:
+    // The inner window boundaries split the part of the range in which connections depart, so every window except
+    // the first one starts before the last departure.
+    inline void computeWindows(const int minDepartureTime, const int maxDepartureTime) noexcept {
+        const int begin = std::max(minDepartureTime, firstDepartureTime);
+        const int end = std::min(maxDepartureTime, lastDepartureTime + 1);
+        const long long range = std::max(end - begin, 1);
+        const long long numberOfWindows =
+            std::min<long long>(range, threadPinning.numberOfThreads * windowsPerThread);
+        windowBegin.assign(1, minDepartureTime);
+        for (long long window = 1; window < numberOfWindows; window++) {
+            windowBegin.emplace_back(begin + (range * window) / numberOfWindows);
+        }
+        windowBegin.emplace_back(maxDepartureTime);
+    }
+
+    inline static void collectEntries(const ProfileArena& profiles, const StopId stop, const int lowerBound,
+                                      const int upperBound, std::vector<ProfileEntry>& entries) noexcept {
+        entries.clear();
+        for (size_t i = 0; i < profiles.size(stop); i++) {
+            const int departureTime = profiles.departureTime(stop, i);
+            if (departureTime < lowerBound || departureTime >= upperBound) continue;
+            entries.emplace_back(departureTime, profiles.arrivalTime(stop, i), profiles.enterConnection(stop, i),
+                                 profiles.exitConnection(stop, i));
+        }
+    }
+
+private:
+    const ThreadPinning threadPinning;
+    const int windowOverlap;
+    const size_t windowsPerThread;
+    const int firstDepartureTime;
+    const int lastDepartureTime;
+
+    std::vector<Search> searches;
+
+    std::vector<int> windowBegin;
+    std::vector<std::vector<ProfileEntry>> windowEntries;
+    std::vector<ProfileEntry> profile;
+};
+
+} // namespace CSA
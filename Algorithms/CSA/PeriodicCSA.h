@@ -0,0 +1,178 @@
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+#include "../../DataStructures/CSA/Data.h"
+#include "../../DataStructures/CSA/Entities/DepartureTimeIndex.h"
+#include "../../DataStructures/Container/ResettableVector.h"
+#include "../../Helpers/Assert.h"
+#include "../../Helpers/PeriodicTime.h"
+#include "../../Helpers/Types.h"
+#include "../../Helpers/Vector/Vector.h"
+
+namespace CSA {
+
+// Transitive earliest arrival CSA on a periodic timetable, in which every trip operates once per period (see
+// PeriodicTime.h). Instead of duplicating the trips for every day, the connections are sorted by their departure time
+// modulo the period, and this order is scanned once per day of the query horizon, with the times shifted to the
+// scanned day. A connection with day offset k belongs to the instance of its trip that started k days before the
+// scanned day. A trip stores the set of its instances that have been reached as a bitmask, so the horizon plus the
+// largest day offset is limited to 64 days. Journeys are not retrieved.
+class PeriodicCSA {
+public:
+    using DayMask = u_int64_t;
+    static constexpr int MaxNumberOfDays = 64;
+
+public:
+    PeriodicCSA(const Data& data, const int period = PeriodicTime::DefaultPeriod)
+        : data(data),
+          period(period),
+          maxDayShift(0),
+          connectionsByTimeOfDay(buildConnections(data, period, dayShiftOfConnection, maxDayShift)),
+          departureTimeIndex(connectionsByTimeOfDay),
+          sourceStop(noStop),
+          targetStop(noStop),
+          firstServiceDay(0),
+          tripReached(data.numberOfTrips(), 0),
+          arrivalTime(data.numberOfStops(), never),
+          numberOfScannedConnections(0) {
+        AssertMsg(maxDayShift < MaxNumberOfDays, "Trips must not run longer than " << MaxNumberOfDays << " days!");
+    }
+
+    // Scans the connections departing from the departure time until the end of the day numberOfDays - 1 days later.
+    inline void run(const StopId source, const int departureTime, const StopId target = noStop,
+                    const int numberOfDays = 2) noexcept {
+        AssertMsg(data.isStop(source), "Source stop " << source << " is not a valid stop!");
+        AssertMsg(numberOfDays > 0 && numberOfDays + maxDayShift <= MaxNumberOfDays,
+                  "The horizon must be between 1 and " << MaxNumberOfDays - maxDayShift << " days!");
+        clear();
+        sourceStop = source;
+        targetStop = target;
+        arrivalTime.set(sourceStop, departureTime);
+        relaxEdges(sourceStop, departureTime);
+        const int firstDay = PeriodicTime::dayOf(departureTime, period);
+        firstServiceDay = firstDay - maxDayShift;
+        for (int day = firstDay; day < firstDay + numberOfDays; day++) {
+            const size_t begin = (day == firstDay)
+                                     ? departureTimeIndex.firstConnectionDepartingAt(departureTime - day * period)
+                                     : 0;
+            if (!scanConnections(day, begin)) break;
+        }
+    }
+
+    inline bool reachable(const StopId stop) const noexcept { return arrivalTime[stop] < never; }
+
+    inline int getEarliestArrivalTime(const StopId stop) const noexcept { return arrivalTime[stop]; }
+
+    inline int getPeriod() const noexcept { return period; }
+
+    inline int getMaxDayShift() const noexcept { return maxDayShift; }
+
+    inline size_t getNumberOfScannedConnections() const noexcept { return numberOfScannedConnections; }
+
+    inline long long byteSize() const noexcept {
+        return Vector::byteSize(connectionsByTimeOfDay) + Vector::byteSize(dayShiftOfConnection)
+               + departureTimeIndex.byteSize() + tripReached.byteSize() + arrivalTime.byteSize();
+    }
+
+private:
+    // Shifts every connection to the day on which it departs, i.e., the departure time is taken modulo the period and
+    // the number of periods subtracted from it is stored as the day offset of the connection.
+    inline static std::vector<Connection> buildConnections(const Data& data, const int period,
+                                                           std::vector<u_int8_t>& dayShifts, int& maxDayShift) {
+        AssertMsg(period > 0, "Period must be positive!");
+        std::vector<Connection> connections;
+        std::vector<u_int8_t> connectionDayShifts;
+        connections.reserve(data.connections.size());
+        connectionDayShifts.reserve(data.connections.size());
+        for (const Connection& connection : data.connections) {
+            AssertMsg(connection.departureTime >= 0, "Departure times must not be negative!");
+            const int dayShift = PeriodicTime::dayOf(connection.departureTime, period);
+            AssertMsg(dayShift < MaxNumberOfDays, "Connection " << connection << " departs too late!");
+            maxDayShift = std::max(maxDayShift, dayShift);
+            connections.emplace_back(connection);
+            connections.back().departureTime -= dayShift * period;
+            connections.back().arrivalTime -= dayShift * period;
+            connectionDayShifts.emplace_back(dayShift);
+        }
+        std::vector<size_t> order(connections.size());
+        for (size_t i = 0; i < order.size(); i++) {
+            order[i] = i;
+        }
+        std::stable_sort(order.begin(), order.end(),
+                         [&](const size_t a, const size_t b) { return connections[a] < connections[b]; });
+        std::vector<Connection> result;
+        result.reserve(connections.size());
+        dayShifts.clear();
+        dayShifts.reserve(connections.size());
+        for (const size_t i : order) {
+            result.emplace_back(connections[i]);
+            dayShifts.emplace_back(connectionDayShifts[i]);
+        }
+        return result;
+    }
+
+    inline void clear() noexcept {
+        sourceStop = noStop;
+        targetStop = noStop;
+        arrivalTime.clear();
+        tripReached.clear();
+        numberOfScannedConnections = 0;
+    }
+
+    // Returns false if the scan was stopped by target pruning.
+    inline bool scanConnections(const int day, const size_t begin) noexcept {
+        const int dayOffset = day * period;
+        for (size_t i = begin; i < connectionsByTimeOfDay.size(); i++) {
+            const Connection& connection = connectionsByTimeOfDay[i];
+            const int departureTime = connection.departureTime + dayOffset;
+            if (targetStop != noStop && departureTime > arrivalTime[targetStop]) return false;
+            numberOfScannedConnections++;
+            const DayMask instance = DayMask(1) << (day - dayShiftOfConnection[i] - firstServiceDay);
+            if (!(tripReached[connection.tripId] & instance)) {
+                if (arrivalTime[connection.departureStopId]
+                    > departureTime - data.minTransferTime(connection.departureStopId))
+                    continue;
+                tripReached.set(connection.tripId, tripReached[connection.tripId] | instance);
+            }
+            arrivalByTrip(connection.arrivalStopId, connection.arrivalTime + dayOffset);
+        }
+        return true;
+    }
+
+    inline void arrivalByTrip(const StopId stop, const int time) noexcept {
+        if (arrivalTime[stop] <= time) return;
+        arrivalTime.set(stop, time);
+        relaxEdges(stop, time);
+    }
+
+    inline void relaxEdges(const StopId stop, const int time) noexcept {
+        for (const Edge edge : data.transferGraph.edgesFrom(stop)) {
+            const StopId toStop = StopId(data.transferGraph.get(ToVertex, edge));
+            const int newArrivalTime = time + data.transferGraph.get(TravelTime, edge);
+            if (arrivalTime[toStop] <= newArrivalTime) continue;
+            arrivalTime.set(toStop, newArrivalTime);
+        }
+    }
+
+private:
+    const Data& data;
+    const int period;
+
+    int maxDayShift;
+    std::vector<u_int8_t> dayShiftOfConnection;
+    std::vector<Connection> connectionsByTimeOfDay;
+    DepartureTimeIndex departureTimeIndex;
+
+    StopId sourceStop;
+    StopId targetStop;
+    int firstServiceDay;
+
+    ResettableVector<DayMask> tripReached;
+    ResettableVector<int> arrivalTime;
+
+    size_t numberOfScannedConnections;
+};
+
+} // namespace CSA
@@ -8,6 +8,7 @@
 #include <vector>
 
 #include "../../DataStructures/CSA/Data.h"
+#include "../../DataStructures/CSA/Entities/ProfileArena.h"
 #include "../../Helpers/Assert.h"
 #include "../../Helpers/String/String.h"
 #include "../../Helpers/Timer.h"
@@ -64,61 +65,6 @@ private:
         ConnectionId exit;
     };
 
-    struct Profile {
-        Profile() : elements(1, ProfileElement()) { elements.reserve(64); };
-
-        inline int size() { return elements.size(); }
-
-        inline bool isDominated(ProfileElement newProfileElement) {
-            // one element in the profile (call it P) domiantes currentProfile iff
-            // P.departureTime >= currentProfile.departureTime && P.arrivalTime <=
-            // currentProfile.arrivalTime In other words: We don't need currentProfile
-            // if there is a ProfileElement 'P' that departs later (or equal) and
-            // arrives earlier (or equal) as currentProfile
-
-            int i = findIndex(newProfileElement);
-
-            return (elements[i].getArrivalTime() <= newProfileElement.getArrivalTime());
-        }
-
-        inline void incorporate(ProfileElement newProfileElement) {
-            int i = findIndex(newProfileElement);
-            auto iter = elements.begin() + i + 1;
-
-            iter = elements.insert(iter, newProfileElement);
-
-            // remove all dominated element that come later in the vector
-            elements.erase(std::remove_if(std::next(iter), elements.end(),
-                                          [&](auto& other) { return newProfileElement.dominates(other); }),
-                           elements.end());
-        }
-
-        inline int findIndex(ProfileElement newProfileElement) noexcept {
-            int i(size() - 1);
-
-            while (elements[i].getDepartureTime() < newProfileElement.getDepartureTime())
-                --i;
-            return i;
-        }
-
-        void printElements() const {
-            if (TransfersSecondCrit) {
-                for (auto e : elements)
-                    std::cout << String::secToString(getExactArrivalTime(e.getDepartureTime())) << "\t"
-                              << String::secToString(getExactArrivalTime(e.getArrivalTime())) << " @ "
-                              << getNumberOfTransfers(e.getArrivalTime()) << " [ " << e.enter << " -> " << e.exit
-                              << " ]\n";
-            } else {
-                for (auto e : elements)
-                    std::cout << String::secToString(e.getDepartureTime()) << "\t"
-                              << String::secToString(e.getArrivalTime()) << " [ " << e.enter << " : " << e.exit
-                              << "]\n";
-            }
-        }
-
-        std::vector<ProfileElement> elements;
-    };
-
 public:
     ProfileCSA(Data& data, const Profiler& profilerTemplate = Profiler())
         : data(data),
@@ -127,7 +73,7 @@ public:
           targetStop(noStop),
           tripArrivalTime(data.numberOfTrips(), TripArrivalElement()),
           tripReached(data.numberOfTrips(), TripFlag()),
-          profiles(data.numberOfStops(), Profile()),
+          profiles(data.numberOfStops()),
           distanceToTarget(data.numberOfStops(), INFTY),
           arrivalTimeToStop(data.numberOfStops(), never),
           sourceDominationIndex(0),
@@ -147,6 +93,14 @@ public:
 
     inline void run(const StopId source, const StopId target, int minDepartureTime = 0,
                     int maxDepartureTime = 86400) noexcept {
+        run(source, target, minDepartureTime, maxDepartureTime, minDepartureTime);
+    }
+
+    // Like run(source, target, minDepartureTime, maxDepartureTime), but the profile scan stops at the first connection
+    // departing before firstScannedDepartureTime. Trips are still reachable if they can be reached when departing at
+    // minDepartureTime, so the profile entries departing at or after firstScannedDepartureTime are the same.
+    inline void run(const StopId source, const StopId target, int minDepartureTime, int maxDepartureTime,
+                    int firstScannedDepartureTime) noexcept {
         AssertMsg(data.isStop(source), "Source stop " << source << " is not a valid stop!");
         AssertMsg(data.isStop(target), "Target stop " << target << " is not a valid stop!");
         AssertMsg(minDepartureTime >= 0 && minDepartureTime < 24 * 60 * 60,
@@ -154,11 +108,14 @@ public:
         AssertMsg(maxDepartureTime > 0 && maxDepartureTime <= 24 * 60 * 60,
                   "Max Departure Time is not in the first day!");
         AssertMsg(minDepartureTime < maxDepartureTime, "Min Departure Time should be smaller than Max Departure Time!");
+        AssertMsg(minDepartureTime <= firstScannedDepartureTime && firstScannedDepartureTime < maxDepartureTime,
+                  "First scanned departure time is not in the departure time range!");
 
         profiler.start();
 
         minDepartureTime = transformTime(minDepartureTime);
         maxDepartureTime = transformTime(maxDepartureTime);
+        firstScannedDepartureTime = transformTime(firstScannedDepartureTime);
         profiler.startPhase();
         resetDistancesToTarget(target);
         clear();
@@ -179,7 +136,8 @@ public:
         profiler.donePhase(PHASE_REACHABLE_EA_QUERY);
 
         profiler.startPhase();
-        scanConnections(earliestConnection, latestConnection);
+        scanConnections(std::max(earliestConnection, firstReachableConnection(firstScannedDepartureTime)),
+                        latestConnection);
         profiler.donePhase(PHASE_CONNECTION_SCAN);
 
         profiler.done();
@@ -235,43 +193,65 @@ public:
             return journey;
 
         // this currently grabs the last element => need to fix
-        const ProfileElement& element = profiles[stop].elements.back();
-        int arrivalTimeAtTarget = getExactArrivalTime(element.arrivalTime);
+        const size_t last = profiles.size(stop) - 1;
+        int arrivalTimeAtTarget = getExactArrivalTime(profiles.arrivalTime(stop, last));
 
-        journey.push_back({element.enter, element.exit});
-        stop = data.connections[element.exit].arrivalStopId;
+        journey.push_back({profiles.enterConnection(stop, last), profiles.exitConnection(stop, last)});
+        stop = data.connections[profiles.exitConnection(stop, last)].arrivalStopId;
 
         while (distanceToTarget[stop] == INFTY) {
-            Profile& profil = profiles[stop];
-
-            int i(0);
+            size_t i(0);
 
-            while (i < profil.size() && getExactArrivalTime(profil.elements[i].arrivalTime) != arrivalTimeAtTarget)
+            while (i < profiles.size(stop) && getExactArrivalTime(profiles.arrivalTime(stop, i)) != arrivalTimeAtTarget)
                 ++i;
-            Assert(0 <= i && i < profil.size());
-            auto& e = profil.elements[i];
+            Assert(i < profiles.size(stop));
+            const ConnectionId exit = profiles.exitConnection(stop, i);
 
-            journey.push_back({e.enter, e.exit});
-            stop = data.connections[e.exit].arrivalStopId;
+            journey.push_back({profiles.enterConnection(stop, i), exit});
+            stop = data.connections[exit].arrivalStopId;
 
             std::cout << "Current Number of legs: " << journey.size() << "\n";
             std::cout << "Stop : " << stop << " distanceToTarget: " << distanceToTarget[stop] << "\n";
-            profil.printElements();
+            printProfile(stop);
         }
 
         return journey;
     }
 
     inline bool reachable(const StopId stop) const noexcept {
-        if (TransfersSecondCrit) return getExactArrivalTime(profiles[stop].elements.back().arrivalTime) < never;
-        return profiles[stop].elements.back().arrivalTime < never;
+        if (profiles.empty(stop)) return false;
+        const int arrivalTime = profiles.arrivalTime(stop, profiles.size(stop) - 1);
+        if (TransfersSecondCrit) return getExactArrivalTime(arrivalTime) < never;
+        return arrivalTime < never;
     }
 
     inline const Profiler& getProfiler() const noexcept { return profiler; }
 
-    void printProfile(const StopId stop) const { profiles[stop].printElements(); }
+    void printProfile(const StopId stop) const {
+        for (size_t i = 0; i < profiles.size(stop); i++) {
+            const int departureTime = profiles.departureTime(stop, i);
+            const int arrivalTime = profiles.arrivalTime(stop, i);
+            if (TransfersSecondCrit) {
+                std::cout << String::secToString(getExactArrivalTime(departureTime)) << "\t"
+                          << String::secToString(getExactArrivalTime(arrivalTime)) << " @ "
+                          << getNumberOfTransfers(arrivalTime) << " [ " << profiles.enterConnection(stop, i)
+                          << " -> " << profiles.exitConnection(stop, i) << " ]\n";
+            } else {
+                std::cout << String::secToString(departureTime) << "\t" << String::secToString(arrivalTime) << " [ "
+                          << profiles.enterConnection(stop, i) << " : " << profiles.exitConnection(stop, i) << "]\n";
+            }
+        }
+    }
+
+    int numberOfJourneys(const StopId stop) { return profiles.size(stop); }
 
-    int numberOfJourneys(const StopId stop) { return profiles[stop].size() - 1; }
+    // The profiles of the last query. After a query from s, the profile of s contains its Pareto-optimal journeys.
+    inline const ProfileArena& getProfiles() const noexcept { return profiles; }
+
+    inline static int transformTime(int time) noexcept {
+        if (!TransfersSecondCrit) return time;
+        return shiftTime(time);
+    }
 
 private:
     inline void resetDistancesToTarget(const StopId newTarget) {
@@ -291,7 +271,7 @@ private:
     inline void clear() {
         sourceStop = noStop;
         targetStop = noStop;
-        Vector::fill(profiles, Profile());
+        profiles.clear();
         Vector::fill(tripArrivalTime, TripArrivalElement());
         Vector::fill(tripReached, TripFlag());
         Vector::fill(arrivalTimeToStop, never);
@@ -357,34 +337,36 @@ private:
             Assert(tripArrivalTime[connection.tripId].exit != ConnectionId(-1));
             const ProfileElement currentProfile(connection.departureTime, tauC, i,
                                                 tripArrivalTime[connection.tripId].exit);
-            Profile& profileArrivalStop = profiles[connection.arrivalStopId];
 
-            if (!profileArrivalStop.isDominated(currentProfile) && checkSourceDomination(currentProfile)) {
+            if (!isDominated(connection.arrivalStopId, currentProfile) && checkSourceDomination(currentProfile)) {
                 profiler.countMetric(METRIC_STOPS_BY_TRIP);
 
-                profileArrivalStop.incorporate(currentProfile);
+                incorporate(connection.arrivalStopId, currentProfile);
                 relaxIncommingEdges(connection.departureStopId, currentProfile);
             }
         }
     }
 
     inline bool checkSourceDomination(const ProfileElement currentProfile) noexcept {
-        Profile& sourceProfile = profiles[sourceStop];
-
-        while (sourceDominationIndex < (int)sourceProfile.size() - 1
-               && sourceProfile.elements[sourceDominationIndex].getDepartureTime() >= currentProfile.getDepartureTime())
+        if (profiles.empty(sourceStop)) return true;
+        const int lastIndex = profiles.size(sourceStop) - 1;
+        sourceDominationIndex = std::min(sourceDominationIndex, lastIndex);
+        while (sourceDominationIndex < lastIndex
+               && profiles.departureTime(sourceStop, sourceDominationIndex) >= currentProfile.getDepartureTime())
             ++sourceDominationIndex;
-        return sourceProfile.elements[sourceDominationIndex].getArrivalTime() > currentProfile.getArrivalTime();
+        return profiles.arrivalTime(sourceStop, sourceDominationIndex) > currentProfile.getArrivalTime();
     }
 
-    inline int earliestArrivalTimeInProfiles(const StopId stop, const int arrivalTime) noexcept {
-        auto stopProfile = profiles[stop];
+    inline bool isDominated(const StopId stop, const ProfileElement& element) const noexcept {
+        return profiles.isDominated(stop, element.getDepartureTime(), element.getArrivalTime());
+    }
 
-        int i(stopProfile.elements.size() - 1);
+    inline void incorporate(const StopId stop, const ProfileElement& element) noexcept {
+        profiles.incorporate(stop, element.getDepartureTime(), element.getArrivalTime(), element.enter, element.exit);
+    }
 
-        while (stopProfile.elements[i].getDepartureTime() < arrivalTime)
-            --i;
-        return stopProfile.elements[i].getArrivalTime();
+    inline int earliestArrivalTimeInProfiles(const StopId stop, const int arrivalTime) noexcept {
+        return profiles.earliestArrivalTime(stop, arrivalTime);
     }
 
     inline void relaxIncommingEdges(const StopId stop, ProfileElement currentProfile) noexcept {
@@ -395,10 +377,9 @@ private:
                 currentProfile.getDepartureTime() - transformTime(reverseTransferGraph.get(TravelTime, edge));
             ProfileElement newElement(newDepartureTime, currentProfile.getArrivalTime(), currentProfile.enter,
                                       currentProfile.exit);
-            Profile& profileFromStop(profiles[fromStop]);
 
-            if (profileFromStop.isDominated(newElement)) continue;
-            profileFromStop.incorporate(newElement);
+            if (isDominated(fromStop, newElement)) continue;
+            incorporate(fromStop, newElement);
             profiler.countMetric(METRIC_STOPS_BY_TRANSFER);
         }
     }
@@ -440,11 +421,6 @@ private:
         arrivalTimeToStop[stop] = time;
     }
 
-    inline int transformTime(int time) noexcept {
-        if (!TransfersSecondCrit) return time;
-        return shiftTime(time);
-    }
-
 private:
     Data& data;
 
@@ -454,7 +430,7 @@ private:
 
     std::vector<TripArrivalElement> tripArrivalTime;
     std::vector<TripFlag> tripReached;
-    std::vector<Profile> profiles;
+    ProfileArena profiles;
     std::vector<int> distanceToTarget;
     std::vector<int> arrivalTimeToStop;
 
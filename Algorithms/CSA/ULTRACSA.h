@@ -7,7 +7,9 @@
 #include <vector>
 
 #include "../../DataStructures/CSA/Data.h"
+#include "../../DataStructures/CSA/Entities/DepartureTimeIndex.h"
 #include "../../DataStructures/CSA/Entities/Journey.h"
+#include "../../DataStructures/Container/ResettableVector.h"
 #include "../../Helpers/Assert.h"
 #include "../../Helpers/Timer.h"
 #include "../../Helpers/Types.h"
@@ -50,6 +52,7 @@ public:
           tripReached(data.numberOfTrips(), TripFlag()),
           arrivalTime(data.numberOfStops() + 1, never),
           parentLabel(PathRetrieval ? data.numberOfStops() + 1 : 0),
+          departureTimeIndex(data.connections),
           profiler(profilerTemplate) {
         AssertMsg(!Graph::hasLoops(data.transferGraph), "Shortcut graph may not have loops!");
         AssertMsg(Vector::isSorted(data.connections), "Connections must be sorted in ascending order!");
@@ -75,7 +78,7 @@ public:
             targetStop = data.isStop(target) ? StopId(target) : StopId(data.numberOfStops());
         }
         if (data.isStop(sourceVertex)) {
-            arrivalTime[sourceVertex] = departureTime;
+            arrivalTime.set(sourceVertex, departureTime);
         }
         runInitialTransfers();
         const ConnectionId firstConnection = firstReachableConnection(departureTime);
@@ -138,18 +141,13 @@ private:
         sourceDepartureTime = never;
         targetVertex = noVertex;
         targetStop = noStop;
-        Vector::fill(arrivalTime, never);
-        Vector::fill(tripReached, TripFlag());
-        if constexpr (PathRetrieval) {
-            Vector::fill(parentLabel, ParentLabel());
-        }
+        // Parent labels are written whenever an arrival time is set, so they do not have to be reset.
+        arrivalTime.clear();
+        tripReached.clear();
     }
 
     inline ConnectionId firstReachableConnection(const int departureTime) const noexcept {
-        return ConnectionId(Vector::lowerBound(data.connections, departureTime,
-                                               [](const Connection& connection, const int time) {
-            return connection.departureTime < time;
-        }));
+        return departureTimeIndex.firstConnectionDepartingAt(departureTime);
     }
 
     inline void scanConnections(const ConnectionId begin, const ConnectionId end) noexcept {
@@ -176,10 +174,10 @@ private:
         if (connectionIsReachableFromTrip(connection)) return true;
         if (connectionIsReachableFromStop(connection)) {
             if constexpr (PathRetrieval) {
-                tripReached[connection.tripId] = id;
+                tripReached.set(connection.tripId, id);
             } else {
                 suppressUnusedParameterWarning(id);
-                tripReached[connection.tripId] = true;
+                tripReached.set(connection.tripId, true);
             }
             return true;
         }
@@ -189,11 +187,12 @@ private:
     inline void arrivalByTrip(const StopId stop, const int time, const TripId trip) noexcept {
         if (arrivalTime[stop] <= time) return;
         profiler.countMetric(METRIC_STOPS_BY_TRIP);
-        arrivalTime[stop] = time;
+        arrivalTime.set(stop, time);
         if constexpr (PathRetrieval) {
-            parentLabel[stop].parent = data.connections[tripReached[trip]].departureStopId;
-            parentLabel[stop].reachedByTransfer = false;
-            parentLabel[stop].tripId = trip;
+            ParentLabel& label = parentLabel[stop];
+            label.parent = data.connections[tripReached[trip]].departureStopId;
+            label.reachedByTransfer = false;
+            label.tripId = trip;
         }
 
         for (const Edge edge : data.transferGraph.edgesFrom(stop)) {
@@ -229,11 +228,12 @@ private:
     inline void arrivalByTransfer(const StopId stop, const int time, const Vertex parent, const Edge edge) noexcept {
         if (arrivalTime[stop] <= time) return;
         profiler.countMetric(METRIC_STOPS_BY_TRANSFER);
-        arrivalTime[stop] = time;
+        arrivalTime.set(stop, time);
         if constexpr (PathRetrieval) {
-            parentLabel[stop].parent = parent;
-            parentLabel[stop].reachedByTransfer = true;
-            parentLabel[stop].transferId = edge;
+            ParentLabel& label = parentLabel[stop];
+            label.parent = parent;
+            label.reachedByTransfer = true;
+            label.transferId = edge;
         }
     }
 
@@ -246,10 +246,12 @@ private:
     Vertex targetVertex;
     StopId targetStop;
 
-    std::vector<TripFlag> tripReached;
-    std::vector<int> arrivalTime;
+    ResettableVector<TripFlag> tripReached;
+    ResettableVector<int> arrivalTime;
     std::vector<ParentLabel> parentLabel;
 
+    DepartureTimeIndex departureTimeIndex;
+
     Profiler profiler;
 };
 } // namespace CSA
@@ -0,0 +1,246 @@
+#pragma once
+
+#include <algorithm>
+#include <numeric>
+#include <omp.h>
+#include <vector>
+
+#include "../../DataStructures/PTL/Data.h"
+#include "../../Helpers/Assert.h"
+#include "../../Helpers/Console/Progress.h"
+#include "../../Helpers/MultiThreading.h"
+
+namespace PTL {
+
+// Computes the reachability labels of PTL via pruned landmark labeling on the time-expanded graph. The vertices are
+// processed as hubs in the given order; for every hub h, a forward BFS adds h to the incoming label of every vertex
+// reachable from h, and a backward BFS adds h to the outgoing label of every vertex that reaches h. A BFS does not
+// continue from vertices for which the reachability is already covered by the labels of higher ranked hubs.
+// Hubs are processed in batches of consecutive ranks. All hubs of one batch are processed in parallel and prune only
+// with the labels of previous batches, which keeps the labels correct (but slightly larger) and makes them independent
+// of the number of threads. Hubs are identified by their rank, so every label is sorted.
+class LabelBuilder {
+public:
+    using Hub = Data::Hub;
+    using Label = Data::Label;
+
+    enum VertexOrder { Degree, StopEvents };
+
+    LabelBuilder(const TE::Data& teData, const VertexOrder order = StopEvents)
+        : teData(teData),
+          numberOfVertices(teData.numberOfTEVertices()),
+          vertexOfRank(numberOfVertices),
+          outLabels(numberOfVertices),
+          inLabels(numberOfVertices) {
+        buildReverseGraph();
+        computeOrder(order);
+    }
+
+    inline void computeOrder(const VertexOrder order) noexcept {
+        std::iota(vertexOfRank.begin(), vertexOfRank.end(), Vertex(0));
+        if (order == Degree) {
+            // Order by (in-degree + 1) * (out-degree + 1), as in the original pruned landmark labeling.
+            std::vector<size_t> importance(numberOfVertices);
+            for (const Vertex vertex : teData.timeExpandedGraph.vertices()) {
+                importance[vertex] = (teData.timeExpandedGraph.outDegree(vertex) + 1)
+                                     * (firstInEdge[vertex + 1] - firstInEdge[vertex] + 1);
+            }
+            std::stable_sort(vertexOfRank.begin(), vertexOfRank.end(),
+                             [&](const Vertex a, const Vertex b) { return importance[a] > importance[b]; });
+        } else {
+            // Stops with many events first; per stop, its departure events by time, then its arrival events by time.
+            std::vector<StopId> stops(teData.numberOfStops());
+            std::iota(stops.begin(), stops.end(), StopId(0));
+            auto numberOfEventsAtStop = [&](const StopId stop) {
+                return teData.depEventsAtStop[stop].size() + teData.arrEventsAtStop[stop].size();
+            };
+            std::stable_sort(stops.begin(), stops.end(), [&](const StopId a, const StopId b) {
+                return numberOfEventsAtStop(a) > numberOfEventsAtStop(b);
+            });
+            size_t rank = 0;
+            for (const StopId stop : stops) {
+                for (const size_t event : teData.depEventsAtStop[stop]) {
+                    vertexOfRank[rank++] = Vertex(event);
+                }
+                for (const size_t event : teData.arrEventsAtStop[stop]) {
+                    vertexOfRank[rank++] = Vertex(event);
+                }
+            }
+            AssertMsg(rank == numberOfVertices, "Not every event belongs to a stop!");
+        }
+    }
+
+    inline void computeLabels(const ThreadPinning& threadPinning, const size_t maxBatchSize = 256,
+                              const bool verbose = true) noexcept {
+        if (verbose)
+            std::cout << "Computing PTL labels with " << threadPinning.numberOfThreads << " threads." << std::endl;
+
+        for (size_t vertex = 0; vertex < numberOfVertices; ++vertex) {
+            outLabels[vertex].clear();
+            inLabels[vertex].clear();
+        }
+
+        Progress progress(numberOfVertices, verbose);
+        omp_set_num_threads(threadPinning.numberOfThreads);
+        localSearches.clear();
+        for (size_t i = 0; i < threadPinning.numberOfThreads; ++i) {
+            localSearches.emplace_back(numberOfVertices);
+        }
+
+        size_t firstRank = 0;
+        size_t batchSize = 1;
+        const size_t batchSizeLimit = std::max<size_t>(maxBatchSize, 1);
+        std::vector<std::vector<Vertex>> forwardResults(batchSize);
+        std::vector<std::vector<Vertex>> backwardResults(batchSize);
+
+#pragma omp parallel
+        {
+            threadPinning.pinThread();
+            LocalSearch& search = localSearches[omp_get_thread_num()];
+
+            while (true) {
+                const size_t batchBegin = firstRank;
+                const size_t batchEnd = std::min(firstRank + batchSize, numberOfVertices);
+                if (batchBegin >= numberOfVertices) break;
+
+#pragma omp for schedule(dynamic, 1)
+                for (size_t rank = batchBegin; rank < batchEnd; ++rank) {
+                    search.run<true>(*this, Hub(rank), forwardResults[rank - batchBegin]);
+                    search.run<false>(*this, Hub(rank), backwardResults[rank - batchBegin]);
+                    progress++;
+                }
+
+#pragma omp single
+                {
+                    for (size_t rank = batchBegin; rank < batchEnd; ++rank) {
+                        for (const Vertex vertex : forwardResults[rank - batchBegin]) {
+                            inLabels[vertex].emplace_back(Hub(rank));
+                        }
+                        for (const Vertex vertex : backwardResults[rank - batchBegin]) {
+                            outLabels[vertex].emplace_back(Hub(rank));
+                        }
+                    }
+                    firstRank = batchEnd;
+                    batchSize = std::min(2 * batchSize, batchSizeLimit);
+                    forwardResults.assign(batchSize, {});
+                    backwardResults.assign(batchSize, {});
+                }
+            }
+        }
+        progress.finished();
+        std::vector<LocalSearch>().swap(localSearches);
+    }
+
+    // Moves the outgoing labels of the departure events and the incoming labels of the arrival events into the PTL
+    // data; the remaining labels are only needed for pruning during the construction.
+    inline void moveLabelsTo(Data& data) noexcept {
+        AssertMsg(data.fwdVertices.size() == (numberOfVertices >> 1), "Not the same size!");
+        AssertMsg(data.bwdVertices.size() == (numberOfVertices >> 1), "Not the same size!");
+
+        for (size_t vertex = 0; vertex < numberOfVertices; ++vertex) {
+            if (teData.isDepartureEvent(Vertex(vertex))) {
+                data.fwdVertices[vertex >> 1] = std::move(outLabels[vertex]);
+                data.fwdVertices[vertex >> 1].shrink_to_fit();
+            } else {
+                data.bwdVertices[(vertex - 1) >> 1] = std::move(inLabels[vertex]);
+                data.bwdVertices[(vertex - 1) >> 1].shrink_to_fit();
+            }
+        }
+    }
+
+private:
+    // Per-thread BFS state. Both bit vectors have one entry per vertex, which is small enough to keep one copy per
+    // thread even for large time-expanded graphs.
+    struct LocalSearch {
+        LocalSearch(const size_t numberOfVertices)
+            : visited(numberOfVertices, false), hubOfRoot(numberOfVertices, false) {}
+
+        template <bool FORWARD>
+        inline void run(const LabelBuilder& builder, const Hub hub, std::vector<Vertex>& result) noexcept {
+            const Vertex root = builder.vertexOfRank[hub];
+            // A forward search from the root covers (root, v) if out(root) and in(v) share a hub.
+            const Label& rootLabel = FORWARD ? builder.outLabels[root] : builder.inLabels[root];
+            for (const Hub h : rootLabel) {
+                hubOfRoot[h] = true;
+            }
+
+            queue.clear();
+            queue.emplace_back(root);
+            visited[root] = true;
+            for (size_t i = 0; i < queue.size(); ++i) {
+                const Vertex vertex = queue[i];
+                if (isCovered(FORWARD ? builder.inLabels[vertex] : builder.outLabels[vertex])) continue;
+                result.emplace_back(vertex);
+                if constexpr (FORWARD) {
+                    for (const Edge edge : builder.teData.timeExpandedGraph.edgesFrom(vertex)) {
+                        visit(builder.teData.timeExpandedGraph.get(ToVertex, edge));
+                    }
+                } else {
+                    for (size_t j = builder.firstInEdge[vertex]; j < builder.firstInEdge[vertex + 1]; ++j) {
+                        visit(builder.inNeighbors[j]);
+                    }
+                }
+            }
+
+            for (const Vertex vertex : queue) {
+                visited[vertex] = false;
+            }
+            for (const Hub h : rootLabel) {
+                hubOfRoot[h] = false;
+            }
+        }
+
+        inline void visit(const Vertex vertex) noexcept {
+            if (visited[vertex]) return;
+            visited[vertex] = true;
+            queue.emplace_back(vertex);
+        }
+
+        inline bool isCovered(const Label& label) const noexcept {
+            for (const Hub h : label) {
+                if (hubOfRoot[h]) return true;
+            }
+            return false;
+        }
+
+        std::vector<bool> visited;
+        std::vector<bool> hubOfRoot;
+        std::vector<Vertex> queue;
+    };
+
+    inline void buildReverseGraph() noexcept {
+        const TimeExpandedGraph& graph = teData.timeExpandedGraph;
+        AssertMsg(graph.numVertices() == numberOfVertices, "The time-expanded graph does not match the events!");
+
+        firstInEdge.assign(numberOfVertices + 1, 0);
+        for (const Vertex from : graph.vertices()) {
+            for (const Edge edge : graph.edgesFrom(from)) {
+                ++firstInEdge[graph.get(ToVertex, edge) + 1];
+            }
+        }
+        std::partial_sum(firstInEdge.begin(), firstInEdge.end(), firstInEdge.begin());
+
+        inNeighbors.resize(graph.numEdges());
+        std::vector<size_t> nextInEdge(firstInEdge.begin(), firstInEdge.end() - 1);
+        for (const Vertex from : graph.vertices()) {
+            for (const Edge edge : graph.edgesFrom(from)) {
+                inNeighbors[nextInEdge[graph.get(ToVertex, edge)]++] = from;
+            }
+        }
+    }
+
+    const TE::Data& teData;
+    const size_t numberOfVertices;
+
+    std::vector<Vertex> vertexOfRank;
+
+    std::vector<size_t> firstInEdge;
+    std::vector<Vertex> inNeighbors;
+
+    std::vector<Label> outLabels;
+    std::vector<Label> inLabels;
+
+    std::vector<LocalSearch> localSearches;
+};
+
+} // namespace PTL
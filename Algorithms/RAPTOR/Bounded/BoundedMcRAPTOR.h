@@ -8,6 +8,7 @@
 #include "../../../DataStructures/Container/Set.h"
 #include "../../../DataStructures/RAPTOR/Data.h"
 #include "../../../DataStructures/RAPTOR/Entities/ArrivalLabel.h"
+#include "../../../DataStructures/RAPTOR/Entities/ArenaBags.h"
 #include "../../../DataStructures/RAPTOR/Entities/Bags.h"
 #include "../Profiler.h"
 
@@ -90,9 +91,9 @@ private:
         }
     };
 
-    using BagType = Bag<Label>;
-    using BestBagType = Bag<BestLabel>;
-    using Round = std::vector<BagType>;
+    using Round = ArenaBags<Label>;
+    using BagType = typename Round::ConstBagReference;
+    using BestBagType = ArenaBags<BestLabel>;
     using RouteBagType = RouteBag<RouteLabel>;
 
 public:
@@ -101,6 +102,7 @@ public:
           profiler(profilerTemplate),
           forwardPruningRAPTOR(data, profiler),
           backwardPruningRAPTOR(backwardData, forwardPruningRAPTOR, profiler),
+          rounds(data.numberOfStops()),
           maxTrips(-1),
           bestLabelsByRoute(data.numberOfStops()),
           bestLabelsByTransfer(data.numberOfStops()),
@@ -215,7 +217,7 @@ public:
         std::vector<WalkingParetoLabel> result;
         for (size_t round = 0; round < rounds.size(); round += 2) {
             const size_t trueRound = std::min(round + 1, rounds.size() - 1);
-            for (const Label& label : rounds[trueRound][stop].labels) {
+            for (const Label& label : rounds[trueRound][stop]) {
                 result.emplace_back(label, round / 2);
             }
         }
@@ -228,13 +230,13 @@ public:
         stopsUpdatedByTransfer.clear();
         routesServingUpdatedStops.clear();
         if constexpr (RESET_CAPACITIES) {
-            std::vector<Round>().swap(rounds);
-            std::vector<BestBagType>(bestLabelsByRoute.size()).swap(bestLabelsByRoute);
-            std::vector<BestBagType>(bestLabelsByTransfer.size()).swap(bestLabelsByTransfer);
+            rounds.reset();
+            bestLabelsByRoute = BestBagType(data.numberOfStops());
+            bestLabelsByTransfer = BestBagType(data.numberOfStops());
         } else {
             rounds.clear();
-            Vector::fill(bestLabelsByRoute);
-            Vector::fill(bestLabelsByTransfer);
+            bestLabelsByRoute.clear();
+            bestLabelsByTransfer.clear();
         }
     }
 
@@ -324,15 +326,14 @@ private:
         routesServingUpdatedStops.clear();
         for (const StopId stop : stopsUpdatedByRoute) {
             stopsUpdatedByTransfer.insert(stop);
-            const BagType& bag = previousRound()[stop];
-            currentRound()[stop].resize(bag.size());
+            const BagType bag = previousRound()[stop];
             for (size_t i = 0; i < bag.size(); i++) {
-                currentRound()[stop][i] = Label(bag[i], stop, i);
+                currentRound()[stop].append(Label(bag[i], stop, i));
             }
         }
 
         for (const StopId stop : stopsUpdatedByRoute) {
-            const BagType& bag = previousRound()[stop];
+            const BagType bag = previousRound()[stop];
             for (const Edge edge : data.transferGraph.edgesFrom(stop)) {
                 profiler.countMetric(METRIC_EDGES);
                 const StopId toStop = StopId(data.transferGraph.get(ToVertex, edge));
@@ -357,12 +358,12 @@ private:
         return rounds.back();
     }
 
-    inline Round& previousRound() noexcept {
+    inline const Round& previousRound() const noexcept {
         AssertMsg(rounds.size() >= 2, "Cannot return previous round, because less than two rounds exist!");
         return rounds[rounds.size() - 2];
     }
 
-    inline void startNewRound() noexcept { rounds.emplace_back(data.numberOfStops()); }
+    inline void startNewRound() noexcept { rounds.emplace_back(); }
 
     inline size_t currentNumberOfTrips() const noexcept { return (rounds.size() - 1) / 2; }
 
@@ -425,12 +426,12 @@ private:
     ForwardPruningRAPTOR<Profiler> forwardPruningRAPTOR;
     BackwardPruningRAPTOR<Profiler> backwardPruningRAPTOR;
 
-    std::vector<Round> rounds;
+    ArenaBagRounds<Label> rounds;
 
     size_t maxTrips;
 
-    std::vector<BestBagType> bestLabelsByRoute;
-    std::vector<BestBagType> bestLabelsByTransfer;
+    BestBagType bestLabelsByRoute;
+    BestBagType bestLabelsByTransfer;
 
     IndexedSet<false, StopId> stopsUpdatedByRoute;
     IndexedSet<false, StopId> stopsUpdatedByTransfer;
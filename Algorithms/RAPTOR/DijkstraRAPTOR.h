@@ -2,6 +2,7 @@
 
 #include "InitialTransfers.h"
 #include "Profiler.h"
+#include "TripSearch.h"
 #include <iostream>
 #include <string>
 #include <vector>
@@ -13,12 +14,13 @@
 #include "../../DataStructures/RAPTOR/Data.h"
 #include "../../DataStructures/RAPTOR/Entities/ArrivalLabel.h"
 #include "../../DataStructures/RAPTOR/Entities/Journey.h"
+#include "../../DataStructures/RAPTOR/Entities/Rounds.h"
 #include "../../Helpers/Vector/Vector.h"
 
 namespace RAPTOR {
 
 template <typename INITIAL_TRANSFERS, typename PROFILER, bool TARGET_PRUNING = true,
-          bool USE_MIN_TRANSFER_TIMES = false, bool PREVENT_DIRECT_WALKING = false>
+          bool USE_MIN_TRANSFER_TIMES = false, bool PREVENT_DIRECT_WALKING = false, bool SPARSE_ROUNDS = false>
 class DijkstraRAPTOR {
 public:
     using InitialTransferType = INITIAL_TRANSFERS;
@@ -27,10 +29,12 @@ public:
     static constexpr bool TargetPruning = TARGET_PRUNING;
     static constexpr bool UseMinTransferTimes = USE_MIN_TRANSFER_TIMES;
     static constexpr bool PreventDirectWalking = PREVENT_DIRECT_WALKING;
+    static constexpr bool SparseRounds = SPARSE_ROUNDS;
     static constexpr bool SeparateRouteAndTransferEntries = UseMinTransferTimes | PreventDirectWalking;
     static constexpr int RoundFactor = SeparateRouteAndTransferEntries ? 2 : 1;
     using Type =
-        DijkstraRAPTOR<InitialTransferType, Profiler, TargetPruning, UseMinTransferTimes, PreventDirectWalking>;
+        DijkstraRAPTOR<InitialTransferType, Profiler, TargetPruning, UseMinTransferTimes, PreventDirectWalking,
+                       SparseRounds>;
     using SourceType = Vertex;
 
 public:
@@ -43,7 +47,7 @@ public:
         bool usesRoute;
         RouteId routeId;
     };
-    using Round = std::vector<EarliestArrivalLabel>;
+    using RoundLabels = Rounds<EarliestArrivalLabel, SparseRounds>;
 
     struct DijkstraLabel : public ExternalKHeapElement {
         DijkstraLabel() : arrivalTime(never), parent(noVertex) {}
@@ -59,6 +63,7 @@ public:
                    const Profiler& profilerTemplate = Profiler())
         : data(data),
           initialTransfers(initialTransfers),
+          rounds(data.numberOfStops() + 1),
           earliestArrivalByRoute(data.numberOfStops() + 1, never),
           stopsUpdatedByRoute(data.numberOfStops() + 1),
           stopsUpdatedByTransfer(data.numberOfStops() + 1),
@@ -267,7 +272,7 @@ public:
         targetStop = StopId(data.numberOfStops());
         queue.clear();
         if constexpr (RESET_CAPACITIES) {
-            std::vector<Round>().swap(rounds);
+            rounds.reset();
             std::vector<int>(earliestArrivalByRoute.size(), never).swap(earliestArrivalByRoute);
             std::vector<DijkstraLabel>(label.size()).swap(label);
         } else {
@@ -342,10 +347,23 @@ private:
 
             StopIndex parentIndex = stopIndex;
             const StopEvent* firstTrip = data.firstTripOfRoute(route);
+            const int* departureTimes = data.transposedDepartureTimesOfRoute(route);
+            const size_t numberOfTrips = data.numberOfTripsInRoute(route);
+            size_t tripIndex = numberOfTrips - 1;
             while (stopIndex < tripSize - 1) {
-                while ((trip > firstTrip) && ((trip - tripSize + stopIndex)->departureTime >= arrivalTime(stop))) {
-                    trip -= tripSize;
-                    parentIndex = stopIndex;
+                if (departureTimes) {
+                    const size_t earliestTripIndex = findEarliestReachableTrip(
+                        departureTimes + (stopIndex * numberOfTrips), tripIndex, arrivalTime(stop));
+                    if (earliestTripIndex < tripIndex) {
+                        tripIndex = earliestTripIndex;
+                        trip = firstTrip + (tripIndex * tripSize);
+                        parentIndex = stopIndex;
+                    }
+                } else {
+                    while ((trip > firstTrip) && ((trip - tripSize + stopIndex)->departureTime >= arrivalTime(stop))) {
+                        trip -= tripSize;
+                        parentIndex = stopIndex;
+                    }
                 }
                 stopIndex++;
                 stop = stops[stopIndex];
@@ -461,17 +479,17 @@ private:
         }
     }
 
-    inline Round& currentRound() noexcept {
+    inline typename RoundLabels::RoundReference currentRound() noexcept {
         AssertMsg(!rounds.empty(), "Cannot return current round, because no round exists!");
         return rounds.back();
     }
 
-    inline Round& previousRound() noexcept {
+    inline typename RoundLabels::ConstRoundReference previousRound() const noexcept {
         AssertMsg(rounds.size() >= 2, "Cannot return previous round, because less than two rounds exist!");
         return rounds[rounds.size() - 2];
     }
 
-    inline void startNewRound() noexcept { rounds.emplace_back(data.numberOfStops() + 1); }
+    inline void startNewRound() noexcept { rounds.emplace_back(); }
 
     inline bool arrivalByRoute(const StopId stop, const int arrivalTime) noexcept {
         AssertMsg(data.isStop(stop), "Stop " << stop << " is out of range!");
@@ -582,7 +600,7 @@ private:
 
     InitialTransferType initialTransfers;
 
-    std::vector<Round> rounds;
+    RoundLabels rounds;
 
     std::vector<int> earliestArrivalByRoute;
 
@@ -2,23 +2,27 @@
 
 #include "InitialTransfers.h"
 #include "Profiler.h"
+#include "TripSearch.h"
 #include <iostream>
 #include <string>
 #include <vector>
 
+#include "../../DataStructures/Container/HubLabels.h"
 #include "../../DataStructures/Container/Map.h"
 #include "../../DataStructures/Container/Set.h"
 #include "../../DataStructures/RAPTOR/Data.h"
 #include "../../DataStructures/RAPTOR/Entities/EarliestArrivalTime.h"
+#include "../../DataStructures/RAPTOR/Entities/Rounds.h"
 
 namespace RAPTOR {
 
-template <typename PROFILER = NoProfiler>
+template <typename PROFILER = NoProfiler, bool SPARSE_ROUNDS = false>
 class HLRAPTOR {
 public:
     using Profiler = PROFILER;
+    static constexpr bool SparseRounds = SPARSE_ROUNDS;
     using ArrivalTime = EarliestArrivalTime<false>;
-    using Type = HLRAPTOR<Profiler>;
+    using Type = HLRAPTOR<Profiler, SparseRounds>;
     using InitialTransferGraph = TransferGraph;
     using SourceType = Vertex;
 
@@ -32,7 +36,7 @@ private:
         bool usesRoute;
         RouteId routeId;
     };
-    using Round = std::vector<EarliestArrivalLabel>;
+    using RoundLabels = Rounds<EarliestArrivalLabel, SparseRounds>;
 
     struct HubParentLabel {
         HubParentLabel() : parent(noVertex), parentDepartureTime(never) {}
@@ -41,13 +45,14 @@ private:
     };
 
 public:
-    HLRAPTOR(const Data& data, const InitialTransferGraph& outHubGraph, const InitialTransferGraph& inHubGraph,
+    HLRAPTOR(const Data& data, const HubLabels& outHubLabels, const HubLabels& inHubLabels,
              const Profiler& profilerTemplate = Profiler())
         : data(data),
-          outHubs(outHubGraph),
-          inHubs(inHubGraph),
-          reverseInHubs(inHubGraph),
+          outHubs(outHubLabels),
+          inHubs(inHubLabels),
+          reverseInHubs(inHubLabels.reverse([&](const Vertex vertex) { return data.isStop(vertex); })),
           transferDistanceToTarget(inHubs.numVertices(), INFTY),
+          rounds(data.numberOfStops() + 1),
           hubParentLabels(inHubs.numVertices()),
           earliestArrival(inHubs.numVertices()),
           stopsUpdatedByRoute(data.numberOfStops() + 1),
@@ -66,19 +71,15 @@ public:
         profiler.registerMetrics({METRIC_ROUTES, METRIC_ROUTE_SEGMENTS, METRIC_VERTICES, METRIC_EDGES,
                                   METRIC_STOPS_BY_TRIP, METRIC_STOPS_BY_TRANSFER});
         profiler.initialize();
-        outHubs.sortEdges(TravelTime);
-        inHubs.sortEdges(TravelTime);
-        DynamicTransferGraph tempGraph;
-        Graph::copy(reverseInHubs, tempGraph);
-        for (const Vertex vertex : tempGraph.vertices()) {
-            if (data.isStop(vertex)) continue;
-            tempGraph.deleteAllOutgoingEdges(vertex);
-        }
-        tempGraph.revert();
-        Graph::move(std::move(tempGraph), reverseInHubs);
-        reverseInHubs.sortEdges(TravelTime);
+        outHubs.setSortedByDistance(true);
+        inHubs.setSortedByDistance(true);
+        reverseInHubs.setSortedByDistance(true);
     }
 
+    HLRAPTOR(const Data& data, const InitialTransferGraph& outHubGraph, const InitialTransferGraph& inHubGraph,
+             const Profiler& profilerTemplate = Profiler())
+        : HLRAPTOR(data, HubLabels(outHubGraph, true), HubLabels(inHubGraph, true), profilerTemplate) {}
+
     inline void run(const Vertex source, const int departureTime, const Vertex target,
                     const size_t maxRounds = INFTY) noexcept {
         profiler.start();
@@ -200,7 +201,7 @@ public:
         targetStop = StopId(data.numberOfStops());
         sourceDepartureTime = never;
         if constexpr (RESET_CAPACITIES) {
-            std::vector<Round>().swap(rounds);
+            rounds.reset();
             std::vector<HubParentLabel>(hubParentLabels.size()).swap(hubParentLabels);
             std::vector<int>(earliestArrival.size(), never).swap(earliestArrival);
         } else {
@@ -272,11 +273,24 @@ private:
 
             StopIndex parentIndex = stopIndex;
             const StopEvent* firstTrip = data.firstTripOfRoute(route);
+            const int* departureTimes = data.transposedDepartureTimesOfRoute(route);
+            const size_t numberOfTrips = data.numberOfTripsInRoute(route);
+            size_t tripIndex = numberOfTrips - 1;
             while (stopIndex < tripSize - 1) {
-                while ((trip > firstTrip)
-                       && ((trip - tripSize + stopIndex)->departureTime >= previousRound()[stop].arrivalTime)) {
-                    trip -= tripSize;
-                    parentIndex = stopIndex;
+                if (departureTimes) {
+                    const size_t earliestTripIndex = findEarliestReachableTrip(
+                        departureTimes + (stopIndex * numberOfTrips), tripIndex, previousRound()[stop].arrivalTime);
+                    if (earliestTripIndex < tripIndex) {
+                        tripIndex = earliestTripIndex;
+                        trip = firstTrip + (tripIndex * tripSize);
+                        parentIndex = stopIndex;
+                    }
+                } else {
+                    while ((trip > firstTrip)
+                           && ((trip - tripSize + stopIndex)->departureTime >= previousRound()[stop].arrivalTime)) {
+                        trip -= tripSize;
+                        parentIndex = stopIndex;
+                    }
                 }
                 stopIndex++;
                 stop = stops[stopIndex];
@@ -296,12 +310,12 @@ private:
         updatedHubs.clear();
 
         transferDistanceToTarget[lastTarget] = INFTY;
-        for (const Edge edge : inHubs.edgesFrom(lastTarget)) {
-            transferDistanceToTarget[inHubs.get(ToVertex, edge)] = INFTY;
+        for (const size_t entry : inHubs.entries(lastTarget)) {
+            transferDistanceToTarget[inHubs.hub(entry)] = INFTY;
         }
         transferDistanceToTarget[targetVertex] = 0;
-        for (const Edge edge : inHubs.edgesFrom(targetVertex)) {
-            transferDistanceToTarget[inHubs.get(ToVertex, edge)] = inHubs.get(TravelTime, edge);
+        for (const size_t entry : inHubs.entries(targetVertex)) {
+            transferDistanceToTarget[inHubs.hub(entry)] = inHubs.distance(entry);
         }
         lastTarget = targetVertex;
 
@@ -310,10 +324,10 @@ private:
         hubParentLabels[sourceVertex].parentDepartureTime = sourceDepartureTime;
         updatedHubs.insert(sourceVertex);
 
-        for (const Edge edge : outHubs.edgesFrom(sourceVertex)) {
-            const Vertex hub = outHubs.get(ToVertex, edge);
+        for (const size_t entry : outHubs.entries(sourceVertex)) {
+            const Vertex hub = outHubs.hub(entry);
             profiler.countMetric(METRIC_EDGES);
-            const int arrivalTime = sourceDepartureTime + outHubs.get(TravelTime, edge);
+            const int arrivalTime = sourceDepartureTime + outHubs.distance(entry);
             if (earliestArrival[targetVertex] <= arrivalTime) break;
             arrivalAtHub(hub, arrivalTime, sourceVertex, sourceDepartureTime);
         }
@@ -332,10 +346,10 @@ private:
             updatedHubs.insert(stop);
             stopsUpdatedByTransfer.insert(stop);
 
-            for (const Edge edge : outHubs.edgesFrom(stop)) {
-                const Vertex hub = outHubs.get(ToVertex, edge);
+            for (const size_t entry : outHubs.entries(stop)) {
+                const Vertex hub = outHubs.hub(entry);
                 profiler.countMetric(METRIC_EDGES);
-                const int arrivalTime = earliestArrivalTime + outHubs.get(TravelTime, edge);
+                const int arrivalTime = earliestArrivalTime + outHubs.distance(entry);
                 if (earliestArrival[targetVertex] <= arrivalTime) break;
                 arrivalAtHub(hub, arrivalTime, stop, earliestArrivalTime);
             }
@@ -347,11 +361,11 @@ private:
     inline void relaxTransfersFromHubs() noexcept {
         routesServingUpdatedStops.clear();
         for (const Vertex hub : updatedHubs) {
-            for (const Edge edge : reverseInHubs.edgesFrom(hub)) {
-                const StopId toStop = StopId(reverseInHubs.get(ToVertex, edge));
+            for (const size_t entry : reverseInHubs.entries(hub)) {
+                const StopId toStop = StopId(reverseInHubs.hub(entry));
                 AssertMsg(data.isStop(toStop), "Hubs have edges to non-stop vertices!");
                 profiler.countMetric(METRIC_EDGES);
-                const int arrivalTime = earliestArrival[hub] + reverseInHubs.get(TravelTime, edge);
+                const int arrivalTime = earliestArrival[hub] + reverseInHubs.distance(entry);
                 if (earliestArrival[targetVertex] <= arrivalTime) break;
                 arrivalByTransfer(toStop, arrivalTime, hubParentLabels[hub].parent,
                                   hubParentLabels[hub].parentDepartureTime);
@@ -365,17 +379,17 @@ private:
         }
     }
 
-    inline Round& currentRound() noexcept {
+    inline typename RoundLabels::RoundReference currentRound() noexcept {
         AssertMsg(!rounds.empty(), "Cannot return current round, because no round exists!");
         return rounds.back();
     }
 
-    inline Round& previousRound() noexcept {
+    inline typename RoundLabels::ConstRoundReference previousRound() const noexcept {
         AssertMsg(rounds.size() >= 2, "Cannot return previous round, because less than two rounds exist!");
         return rounds[rounds.size() - 2];
     }
 
-    inline void startNewRound() noexcept { rounds.emplace_back(data.numberOfStops() + 1); }
+    inline void startNewRound() noexcept { rounds.emplace_back(); }
 
     inline bool arrivalByRoute(const StopId stop, const int time) noexcept {
         AssertMsg(data.isStop(stop), "Stop " << stop << " is out of range!");
@@ -449,13 +463,13 @@ private:
 
 private:
     const Data& data;
-    TransferGraph outHubs;
-    TransferGraph inHubs;
-    TransferGraph reverseInHubs;
+    HubLabels outHubs;
+    HubLabels inHubs;
+    HubLabels reverseInHubs;
 
     std::vector<int> transferDistanceToTarget;
 
-    std::vector<Round> rounds;
+    RoundLabels rounds;
     std::vector<HubParentLabel> hubParentLabels;
 
     std::vector<int> earliestArrival;
@@ -3,12 +3,14 @@
 #include "../../DataStructures/RAPTOR/TransferModes.h"
 #include "../CH/Query/BucketQuery.h"
 #include "../CH/Query/CHQuery.h"
+#include "../CH/Query/PHAST.h"
 
 namespace RAPTOR {
 
 using DijkstraInitialTransfers = CH::Query<TransferGraph, false, false, true>;
 using CoreCHInitialTransfers = CH::Query<CHGraph, true, false, true>;
 using BucketCHInitialTransfers = CH::BucketQuery<CHGraph, true, false>;
+using PHASTInitialTransfers = CH::PHAST<false>;
 
 class TransitiveInitialTransfers {
 public:
@@ -0,0 +1,324 @@
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+#ifdef USE_SIMD
+#include <immintrin.h>
+#endif
+
+#include "../../DataStructures/Container/Map.h"
+#include "../../DataStructures/Container/Set.h"
+#include "../../DataStructures/RAPTOR/Data.h"
+#include "../../Helpers/Assert.h"
+#include "../../Helpers/Types.h"
+#include "../../Helpers/aligned_allocator.h"
+
+namespace RAPTOR {
+
+// Earliest arrival RAPTOR on a transitive transfer graph for a batch of up to BATCH_SIZE source stops with a common
+// departure time. Every stop holds one arrival time per source (lane), and the arrival times of all lanes at a stop are
+// stored contiguously. Routes and transfers are processed for all lanes at once: A route is scanned if it serves a stop
+// that was improved in any lane, and each lane keeps its own current trip, which is found with gathers on the
+// departure times of the route. Since the labels are not separated by round, the result is the earliest arrival time
+// with an unbounded number of trips.
+template <size_t BATCH_SIZE = 32>
+class ManySourceRAPTOR {
+public:
+    inline static constexpr size_t BatchSize = BATCH_SIZE;
+    inline static constexpr size_t BlockSize = 8;
+    inline static constexpr size_t NumberOfBlocks = BatchSize / BlockSize;
+    static_assert(BatchSize > 0 && BatchSize % BlockSize == 0, "Batch size must be a positive multiple of 8!");
+    using Type = ManySourceRAPTOR<BatchSize>;
+
+public:
+    ManySourceRAPTOR(const Data& data)
+        : data(data),
+          numberOfSources(0),
+          arrivalTimes(data.numberOfStops() * BatchSize, never),
+          stopsUpdatedByRoute(data.numberOfStops()),
+          stopsUpdatedByTransfer(data.numberOfStops()),
+          routesServingUpdatedStops(data.numberOfRoutes()),
+          numberOfRounds(0) {
+        AssertMsg(data.hasImplicitBufferTimes(), "Departure buffer times have to be implicit!");
+    }
+
+    // Runs one batch of at most BatchSize sources.
+    inline void run(const std::vector<StopId>& sources, const int time) noexcept {
+        AssertMsg(sources.size() <= BatchSize, "Too many sources for one batch (" << sources.size() << ")!");
+        clear();
+        initialize(sources, time);
+        relaxTransfers();
+        while (!stopsUpdatedByTransfer.empty()) {
+            numberOfRounds++;
+            collectRoutesServingUpdatedStops();
+            scanRoutes();
+            if (stopsUpdatedByRoute.empty()) break;
+            relaxTransfers();
+        }
+    }
+
+    // Computes the earliest arrival times from every source to every stop. The result is stored row by row, i.e., the
+    // arrival time from sources[i] at stop s is found at index i * numberOfStops + s.
+    inline std::vector<int> computeArrivalTimeMatrix(const std::vector<StopId>& sources, const int time) noexcept {
+        std::vector<int> matrix(sources.size() * data.numberOfStops(), never);
+        std::vector<StopId> batch;
+        for (size_t first = 0; first < sources.size(); first += BatchSize) {
+            batch.assign(sources.begin() + first, sources.begin() + std::min(first + BatchSize, sources.size()));
+            run(batch, time);
+            for (size_t lane = 0; lane < batch.size(); lane++) {
+                int* row = matrix.data() + (first + lane) * data.numberOfStops();
+                for (size_t stop = 0; stop < data.numberOfStops(); stop++) {
+                    row[stop] = arrivalTimes[stop * BatchSize + lane];
+                }
+            }
+        }
+        return matrix;
+    }
+
+    inline int getEarliestArrivalTime(const size_t lane, const StopId stop) const noexcept {
+        AssertMsg(lane < numberOfSources, "Lane " << lane << " is out of range!");
+        AssertMsg(data.isStop(stop), "Stop " << stop << " is out of range!");
+        return arrivalTimes[stop * BatchSize + lane];
+    }
+
+    inline const int* getEarliestArrivalTimes(const StopId stop) const noexcept {
+        AssertMsg(data.isStop(stop), "Stop " << stop << " is out of range!");
+        return arrivalTimes.data() + stop * BatchSize;
+    }
+
+    inline size_t getNumberOfRounds() const noexcept { return numberOfRounds; }
+
+    inline long long byteSize() const noexcept {
+        return arrivalTimes.capacity() * sizeof(int) + stopsUpdatedByRoute.byteSize()
+               + stopsUpdatedByTransfer.byteSize();
+    }
+
+private:
+    inline void clear() noexcept {
+        std::fill(arrivalTimes.begin(), arrivalTimes.end(), never);
+        stopsUpdatedByRoute.clear();
+        stopsUpdatedByTransfer.clear();
+        routesServingUpdatedStops.clear();
+        numberOfSources = 0;
+        numberOfRounds = 0;
+    }
+
+    inline void initialize(const std::vector<StopId>& sources, const int time) noexcept {
+        numberOfSources = sources.size();
+        for (size_t lane = 0; lane < sources.size(); lane++) {
+            AssertMsg(data.isStop(sources[lane]), "Source " << sources[lane] << " is not a stop!");
+            arrivalTimes[sources[lane] * BatchSize + lane] = time;
+            stopsUpdatedByRoute.insert(sources[lane]);
+        }
+    }
+
+    inline int minimumArrivalTime(const StopId stop) const noexcept {
+        const int* labels = arrivalTimes.data() + stop * BatchSize;
+#if defined(USE_SIMD) && defined(__AVX2__)
+        __m256i minimum = _mm256_load_si256(reinterpret_cast<const __m256i*>(labels));
+        for (size_t block = 1; block < NumberOfBlocks; block++) {
+            minimum = _mm256_min_epi32(
+                minimum, _mm256_load_si256(reinterpret_cast<const __m256i*>(labels + block * BlockSize)));
+        }
+        alignas(32) int values[BlockSize];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(values), minimum);
+        return *std::min_element(values, values + BlockSize);
+#else
+        return *std::min_element(labels, labels + BatchSize);
+#endif
+    }
+
+    inline void collectRoutesServingUpdatedStops() noexcept {
+        routesServingUpdatedStops.clear();
+        for (const StopId stop : stopsUpdatedByTransfer) {
+            const int arrivalTime = minimumArrivalTime(stop);
+            for (const RouteSegment& route : data.routesContainingStop(stop)) {
+                AssertMsg(data.isRoute(route.routeId), "Route " << route.routeId << " is out of range!");
+                if (route.stopIndex + 1 == data.numberOfStopsInRoute(route.routeId)) continue;
+                if (data.lastTripOfRoute(route.routeId)[route.stopIndex].departureTime < arrivalTime) continue;
+                if (routesServingUpdatedStops.contains(route.routeId)) {
+                    routesServingUpdatedStops[route.routeId] =
+                        std::min(routesServingUpdatedStops[route.routeId], route.stopIndex);
+                } else {
+                    routesServingUpdatedStops.insert(route.routeId, route.stopIndex);
+                }
+            }
+        }
+    }
+
+    // Each lane holds the index of its current trip, or numberOfTrips if it has not boarded a trip yet. At every stop,
+    // the arrival times of the current trips are merged into the labels, and afterwards every lane steps back to the
+    // earliest trip it can still board. The departure times are read from the transposed copy if it is available.
+    inline void scanRoutes() noexcept {
+        stopsUpdatedByRoute.clear();
+        for (const RouteId route : routesServingUpdatedStops.getKeys()) {
+            const StopIndex firstStopIndex = routesServingUpdatedStops[route];
+            const size_t tripSize = data.numberOfStopsInRoute(route);
+            const int numberOfTrips = data.numberOfTripsInRoute(route);
+            const StopId* stops = data.stopArrayOfRoute(route);
+            const int* stopEvents = reinterpret_cast<const int*>(data.firstTripOfRoute(route));
+            const int* transposedDepartureTimes = data.transposedDepartureTimesOfRoute(route);
+            const int arrivalStride = tripSize * 2;
+            const int departureStride = transposedDepartureTimes ? 1 : arrivalStride;
+
+            alignas(32) int tripIndex[BatchSize];
+            std::fill(tripIndex, tripIndex + BatchSize, numberOfTrips);
+            for (size_t stopIndex = firstStopIndex; stopIndex < tripSize; stopIndex++) {
+                const StopId stop = stops[stopIndex];
+                int* labels = arrivalTimes.data() + stop * BatchSize;
+                if (stopIndex > firstStopIndex) {
+                    const int* arrivalTimesOfStop = stopEvents + stopIndex * 2;
+                    if (mergeArrivalTimes(labels, tripIndex, arrivalTimesOfStop, arrivalStride, numberOfTrips)) {
+                        stopsUpdatedByRoute.insert(stop);
+                    }
+                }
+                if (stopIndex + 1 == tripSize) break;
+                const int* departureTimes = transposedDepartureTimes
+                                                ? transposedDepartureTimes + stopIndex * numberOfTrips
+                                                : stopEvents + stopIndex * 2 + 1;
+                boardTrips(labels, tripIndex, departureTimes, departureStride,
+                           departureTimes[(numberOfTrips - 1) * departureStride]);
+            }
+        }
+    }
+
+    inline bool mergeArrivalTimes(int* labels, const int* tripIndex, const int* arrivalTimesOfStop, const int stride,
+                                  const int numberOfTrips) const noexcept {
+#if defined(USE_SIMD) && defined(__AVX2__)
+        const __m256i trips = _mm256_set1_epi32(numberOfTrips);
+        const __m256i strides = _mm256_set1_epi32(stride);
+        const __m256i nevers = _mm256_set1_epi32(never);
+        __m256i improved = _mm256_setzero_si256();
+        for (size_t block = 0; block < NumberOfBlocks; block++) {
+            const __m256i index = _mm256_load_si256(reinterpret_cast<const __m256i*>(tripIndex + block * BlockSize));
+            const __m256i valid = _mm256_cmpgt_epi32(trips, index);
+            if (_mm256_testz_si256(valid, valid)) continue;
+            const __m256i arrival = _mm256_mask_i32gather_epi32(nevers, arrivalTimesOfStop,
+                                                                _mm256_mullo_epi32(index, strides), valid, 4);
+            __m256i* label = reinterpret_cast<__m256i*>(labels + block * BlockSize);
+            const __m256i oldLabel = _mm256_load_si256(label);
+            improved = _mm256_or_si256(improved, _mm256_cmpgt_epi32(oldLabel, arrival));
+            _mm256_store_si256(label, _mm256_min_epi32(oldLabel, arrival));
+        }
+        return !_mm256_testz_si256(improved, improved);
+#else
+        bool improved = false;
+        for (size_t lane = 0; lane < BatchSize; lane++) {
+            if (tripIndex[lane] == numberOfTrips) continue;
+            const int arrival = arrivalTimesOfStop[tripIndex[lane] * stride];
+            if (arrival >= labels[lane]) continue;
+            labels[lane] = arrival;
+            improved = true;
+        }
+        return improved;
+#endif
+    }
+
+    // Lanes that arrive after the last trip has departed cannot board any trip, so blocks without other lanes are
+    // skipped before any departure time is gathered. Otherwise, the previous trip is checked first, since most route
+    // segments do not change the trip. The lanes that can reach it search their earliest reachable trip with a binary
+    // search, which relies on the trips of a route not overtaking each other.
+    inline void boardTrips(const int* labels, int* tripIndex, const int* departureTimesOfStop, const int stride,
+                           const int lastDepartureTime) const noexcept {
+#if defined(USE_SIMD) && defined(__AVX2__)
+        const __m256i zeros = _mm256_setzero_si256();
+        const __m256i ones = _mm256_set1_epi32(1);
+        const __m256i strides = _mm256_set1_epi32(stride);
+        const __m256i lastDepartureTimes = _mm256_set1_epi32(lastDepartureTime);
+        for (size_t block = 0; block < NumberOfBlocks; block++) {
+            __m256i* blockIndex = reinterpret_cast<__m256i*>(tripIndex + block * BlockSize);
+            const __m256i label = _mm256_load_si256(reinterpret_cast<const __m256i*>(labels + block * BlockSize));
+            const __m256i tooLate = _mm256_cmpgt_epi32(label, lastDepartureTimes);
+            if (_mm256_testc_si256(tooLate, _mm256_set1_epi32(-1))) continue;
+            const __m256i index = _mm256_load_si256(blockIndex);
+            const __m256i hasPrevious = _mm256_cmpgt_epi32(index, zeros);
+            if (_mm256_testz_si256(hasPrevious, hasPrevious)) continue;
+            const __m256i previous = _mm256_sub_epi32(index, ones);
+            const __m256i departure = _mm256_mask_i32gather_epi32(
+                zeros, departureTimesOfStop, _mm256_mullo_epi32(previous, strides), hasPrevious, 4);
+            const __m256i reachable = _mm256_andnot_si256(_mm256_cmpgt_epi32(label, departure), hasPrevious);
+            if (_mm256_testz_si256(reachable, reachable)) continue;
+            // The reachable lanes search their earliest reachable trip in [low, high], the others keep their trip.
+            __m256i low = _mm256_blendv_epi8(index, zeros, reachable);
+            __m256i high = _mm256_blendv_epi8(index, previous, reachable);
+            while (true) {
+                const __m256i active = _mm256_cmpgt_epi32(high, low);
+                if (_mm256_testz_si256(active, active)) break;
+                const __m256i middle = _mm256_srli_epi32(_mm256_add_epi32(low, high), 1);
+                const __m256i middleDeparture = _mm256_mask_i32gather_epi32(
+                    zeros, departureTimesOfStop, _mm256_mullo_epi32(middle, strides), active, 4);
+                const __m256i tooEarly = _mm256_and_si256(_mm256_cmpgt_epi32(label, middleDeparture), active);
+                const __m256i catchable = _mm256_andnot_si256(tooEarly, active);
+                high = _mm256_blendv_epi8(high, middle, catchable);
+                low = _mm256_blendv_epi8(low, _mm256_add_epi32(middle, ones), tooEarly);
+            }
+            _mm256_store_si256(blockIndex, high);
+        }
+#else
+        for (size_t lane = 0; lane < BatchSize; lane++) {
+            if (labels[lane] > lastDepartureTime) continue;
+            while (tripIndex[lane] > 0 && departureTimesOfStop[(tripIndex[lane] - 1) * stride] >= labels[lane]) {
+                tripIndex[lane]--;
+            }
+        }
+#endif
+    }
+
+    inline void relaxTransfers() noexcept {
+        stopsUpdatedByTransfer.clear();
+        for (const StopId stop : stopsUpdatedByRoute) {
+            const int* labels = arrivalTimes.data() + stop * BatchSize;
+            for (const Edge edge : data.transferGraph.edgesFrom(stop)) {
+                AssertMsg(data.isStop(data.transferGraph.get(ToVertex, edge)),
+                          "Graph contains edges to non stop vertices!");
+                const StopId toStop = StopId(data.transferGraph.get(ToVertex, edge));
+                if (relaxEdge(labels, arrivalTimes.data() + toStop * BatchSize,
+                              data.transferGraph.get(TravelTime, edge))) {
+                    stopsUpdatedByTransfer.insert(toStop);
+                }
+            }
+            stopsUpdatedByTransfer.insert(stop);
+        }
+    }
+
+    inline bool relaxEdge(const int* fromLabels, int* toLabels, const int travelTime) const noexcept {
+#if defined(USE_SIMD) && defined(__AVX2__)
+        const __m256i travelTimes = _mm256_set1_epi32(travelTime);
+        __m256i improved = _mm256_setzero_si256();
+        for (size_t block = 0; block < BlockSize * NumberOfBlocks; block += BlockSize) {
+            const __m256i arrival = _mm256_add_epi32(
+                _mm256_load_si256(reinterpret_cast<const __m256i*>(fromLabels + block)), travelTimes);
+            __m256i* label = reinterpret_cast<__m256i*>(toLabels + block);
+            const __m256i oldLabel = _mm256_load_si256(label);
+            improved = _mm256_or_si256(improved, _mm256_cmpgt_epi32(oldLabel, arrival));
+            _mm256_store_si256(label, _mm256_min_epi32(oldLabel, arrival));
+        }
+        return !_mm256_testz_si256(improved, improved);
+#else
+        bool improved = false;
+        for (size_t lane = 0; lane < BatchSize; lane++) {
+            const int arrival = fromLabels[lane] + travelTime;
+            if (arrival >= toLabels[lane]) continue;
+            toLabels[lane] = arrival;
+            improved = true;
+        }
+        return improved;
+#endif
+    }
+
+private:
+    const Data& data;
+
+    size_t numberOfSources;
+
+    std::vector<int, aligned_allocator<int, 32>> arrivalTimes;
+
+    IndexedSet<false, StopId> stopsUpdatedByRoute;
+    IndexedSet<false, StopId> stopsUpdatedByTransfer;
+    IndexedMap<StopIndex, false, RouteId> routesServingUpdatedStops;
+
+    size_t numberOfRounds;
+};
+
+} // namespace RAPTOR
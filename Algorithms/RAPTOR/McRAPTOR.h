@@ -1,12 +1,14 @@
 #pragma once
 
 #include "Profiler.h"
+#include "TripSearch.h"
 #include <vector>
 
 #include "../../DataStructures/Container/Map.h"
 #include "../../DataStructures/Container/Set.h"
 #include "../../DataStructures/RAPTOR/Data.h"
 #include "../../DataStructures/RAPTOR/Entities/ArrivalLabel.h"
+#include "../../DataStructures/RAPTOR/Entities/ArenaBags.h"
 #include "../../DataStructures/RAPTOR/Entities/Bags.h"
 
 namespace RAPTOR {
@@ -92,31 +94,44 @@ private:
         }
     };
 
-    struct SeparatedBestBag {
-        inline Bag<BestLabel>& byRoute() noexcept { return labelsByRoute; }
+    struct SeparatedBestBags {
+        SeparatedBestBags(const size_t numberOfStops = 0)
+            : labelsByRoute(numberOfStops), labelsByTransfer(numberOfStops) {}
 
-        inline Bag<BestLabel>& byTransfer() noexcept { return labelsByTransfer; }
+        inline ArenaBags<BestLabel>& byRoute() noexcept { return labelsByRoute; }
 
-        Bag<BestLabel> labelsByRoute;
-        Bag<BestLabel> labelsByTransfer;
+        inline ArenaBags<BestLabel>& byTransfer() noexcept { return labelsByTransfer; }
+
+        inline void clear() noexcept {
+            labelsByRoute.clear();
+            labelsByTransfer.clear();
+        }
+
+        ArenaBags<BestLabel> labelsByRoute;
+        ArenaBags<BestLabel> labelsByTransfer;
     };
 
-    struct CombinedBestBag {
-        inline Bag<BestLabel>& byRoute() noexcept { return labels; }
+    struct CombinedBestBags {
+        CombinedBestBags(const size_t numberOfStops = 0) : labels(numberOfStops) {}
+
+        inline ArenaBags<BestLabel>& byRoute() noexcept { return labels; }
+
+        inline ArenaBags<BestLabel>& byTransfer() noexcept { return labels; }
 
-        inline Bag<BestLabel>& byTransfer() noexcept { return labels; }
+        inline void clear() noexcept { labels.clear(); }
 
-        Bag<BestLabel> labels;
+        ArenaBags<BestLabel> labels;
     };
 
-    using BagType = Bag<Label>;
-    using BestBag = Meta::IF<Transitive, CombinedBestBag, SeparatedBestBag>;
-    using Round = std::vector<BagType>;
+    using Round = ArenaBags<Label>;
+    using BagType = typename Round::ConstBagReference;
+    using BestBags = Meta::IF<Transitive, CombinedBestBags, SeparatedBestBags>;
     using RouteBagType = RouteBag<RouteLabel>;
 
 public:
     McRAPTOR(const Data& data, const Profiler& profilerTemplate = Profiler())
         : data(data),
+          rounds(data.numberOfStops()),
           bestLabels(data.numberOfStops()),
           stopsUpdatedByRoute(data.numberOfStops()),
           stopsUpdatedByTransfer(data.numberOfStops()),
@@ -199,7 +214,7 @@ public:
         std::vector<WalkingParetoLabel> result;
         for (size_t round = 0; round < rounds.size(); round += 2) {
             const size_t trueRound = std::min(round + 1, rounds.size() - 1);
-            for (const Label& label : rounds[trueRound][stop].labels) {
+            for (const Label& label : rounds[trueRound][stop]) {
                 result.emplace_back(label, round / 2);
             }
         }
@@ -214,11 +229,11 @@ public:
         targetStop = noStop;
         sourceDepartureTime = never;
         if constexpr (RESET_CAPACITIES) {
-            std::vector<Round>().swap(rounds);
-            std::vector<BestBag>(bestLabels.size()).swap(bestLabels);
+            rounds.reset();
+            bestLabels = BestBags(data.numberOfStops());
         } else {
             rounds.clear();
-            Vector::fill(bestLabels);
+            bestLabels.clear();
         }
     }
 
@@ -270,6 +285,8 @@ private:
 
             const StopEvent* firstTrip = data.firstTripOfRoute(route);
             const StopEvent* lastTrip = data.lastTripOfRoute(route);
+            const int* departureTimes = data.transposedDepartureTimesOfRoute(route);
+            const size_t numberOfTrips = data.numberOfTripsInRoute(route);
 
             RouteBagType routeBag;
 
@@ -277,10 +294,17 @@ private:
                 for (size_t i = 0; i < previousRound()[stop].size(); i++) {
                     const Label& label = previousRound()[stop][i];
                     const StopEvent* trip = firstTrip;
-                    while ((trip < lastTrip) && (trip[stopIndex].departureTime < label.arrivalTime)) {
-                        trip += tripSize;
+                    if (departureTimes) {
+                        const size_t tripIndex = findFirstReachableTrip(departureTimes + (stopIndex * numberOfTrips),
+                                                                        numberOfTrips, label.arrivalTime);
+                        if (tripIndex == numberOfTrips) continue;
+                        trip += tripIndex * tripSize;
+                    } else {
+                        while ((trip < lastTrip) && (trip[stopIndex].departureTime < label.arrivalTime)) {
+                            trip += tripSize;
+                        }
+                        if (trip[stopIndex].departureTime < label.arrivalTime) continue;
                     }
-                    if (trip[stopIndex].departureTime < label.arrivalTime) continue;
 
                     RouteLabel newLabel;
                     newLabel.trip = trip;
@@ -311,15 +335,14 @@ private:
         routesServingUpdatedStops.clear();
         for (const StopId stop : stopsUpdatedByRoute) {
             stopsUpdatedByTransfer.insert(stop);
-            const BagType& bag = previousRound()[stop];
-            currentRound()[stop].resize(bag.size());
+            const BagType bag = previousRound()[stop];
             for (size_t i = 0; i < bag.size(); i++) {
-                currentRound()[stop][i] = Label(bag[i], stop, i);
+                currentRound()[stop].append(Label(bag[i], stop, i));
             }
         }
 
         for (const StopId stop : stopsUpdatedByRoute) {
-            const BagType& bag = previousRound()[stop];
+            const BagType bag = previousRound()[stop];
             for (const Edge edge : data.transferGraph.edgesFrom(stop)) {
                 profiler.countMetric(METRIC_EDGES);
                 const StopId toStop = StopId(data.transferGraph.get(ToVertex, edge));
@@ -344,21 +367,21 @@ private:
         return rounds.back();
     }
 
-    inline Round& previousRound() noexcept {
+    inline const Round& previousRound() const noexcept {
         AssertMsg(rounds.size() >= 2, "Cannot return previous round, because less than two rounds exist!");
         return rounds[rounds.size() - 2];
     }
 
-    inline void startNewRound() noexcept { rounds.emplace_back(data.numberOfStops()); }
+    inline void startNewRound() noexcept { rounds.emplace_back(); }
 
     inline void arrivalByTransfer(const StopId stop, const Label& label) noexcept {
         AssertMsg(data.isStop(stop), "Stop " << stop << " is out of range!");
         if constexpr (TargetPruning)
-            if (bestLabels[targetStop].byTransfer().dominates(label)) return;
-        if (!bestLabels[stop].byTransfer().merge(BestLabel(label))) return;
+            if (bestLabels.byTransfer()[targetStop].dominates(label)) return;
+        if (!bestLabels.byTransfer()[stop].merge(BestLabel(label))) return;
         profiler.countMetric(METRIC_STOPS_BY_TRANSFER);
         currentRound()[stop].mergeUndominated(label);
-        AssertMsg(bestLabels[stop].byTransfer().dominates(currentRound()[stop]),
+        AssertMsg(bestLabels.byTransfer()[stop].dominates(currentRound()[stop]),
                   "Best bag does not dominate current bag!");
         stopsUpdatedByTransfer.insert(stop);
     }
@@ -366,12 +389,12 @@ private:
     inline void arrivalByRoute(const StopId stop, const Label& label) noexcept {
         AssertMsg(data.isStop(stop), "Stop " << stop << " is out of range!");
         if constexpr (TargetPruning)
-            if (bestLabels[targetStop].byTransfer().dominates(label)) return;
-        if (!bestLabels[stop].byRoute().merge(BestLabel(label))) return;
-        bestLabels[stop].byTransfer().merge(BestLabel(label));
+            if (bestLabels.byTransfer()[targetStop].dominates(label)) return;
+        if (!bestLabels.byRoute()[stop].merge(BestLabel(label))) return;
+        bestLabels.byTransfer()[stop].merge(BestLabel(label));
         profiler.countMetric(METRIC_STOPS_BY_TRIP);
         currentRound()[stop].mergeUndominated(label);
-        AssertMsg(bestLabels[stop].byTransfer().dominates(currentRound()[stop]),
+        AssertMsg(bestLabels.byTransfer()[stop].dominates(currentRound()[stop]),
                   "Best bag does not dominate current bag!");
         stopsUpdatedByRoute.insert(stop);
     }
@@ -394,9 +417,9 @@ private:
 private:
     const Data& data;
 
-    std::vector<Round> rounds;
+    ArenaBagRounds<Label> rounds;
 
-    std::vector<BestBag> bestLabels;
+    BestBags bestLabels;
 
     IndexedSet<false, StopId> stopsUpdatedByRoute;
     IndexedSet<false, StopId> stopsUpdatedByTransfer;
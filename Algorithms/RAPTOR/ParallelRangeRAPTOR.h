@@ -0,0 +1,462 @@
+#pragma once
+
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+#include <omp.h>
+
+#include "TripSearch.h"
+
+#include "../../DataStructures/Container/Map.h"
+#include "../../DataStructures/Container/Set.h"
+#include "../../DataStructures/RAPTOR/Data.h"
+#include "../../DataStructures/RAPTOR/Entities/ArrivalLabel.h"
+#include "../../Helpers/MultiThreading.h"
+#include "../../Helpers/Types.h"
+#include "../../Helpers/Vector/Vector.h"
+
+namespace RAPTOR {
+
+struct ProfileEntry {
+    ProfileEntry(const int departureTime = never, const int arrivalTime = never, const size_t numberOfTrips = 0)
+        : departureTime(departureTime), arrivalTime(arrivalTime), numberOfTrips(numberOfTrips) {}
+
+    inline bool dominates(const ProfileEntry& other) const noexcept {
+        return departureTime >= other.departureTime && arrivalTime <= other.arrivalTime
+               && numberOfTrips <= other.numberOfTrips;
+    }
+
+    inline friend std::ostream& operator<<(std::ostream& out, const ProfileEntry& entry) noexcept {
+        return out << "departureTime: " << entry.departureTime << ", arrivalTime: " << entry.arrivalTime
+                   << ", numberOfTrips: " << entry.numberOfTrips;
+    }
+
+    int departureTime;
+    int arrivalTime;
+    size_t numberOfTrips;
+};
+
+// Multi-threaded range RAPTOR (rRAPTOR) on a transitive transfer graph. For a source stop and a departure time range,
+// it computes the profile of every target stop (or of a single target stop), i.e., all journeys with at least one trip
+// that are Pareto-optimal with respect to departure time, arrival time and number of trips. Journeys departing after
+// the range are taken into account, so no profile entry is dominated by such a journey. Walking directly from the
+// source is not part of the profiles; it dominates every journey that arrives later than the direct walk.
+// The departures of the source are sorted by decreasing departure time and split into consecutive chunks, which are
+// processed by the threads independently. Within a chunk, the labels of later departures are kept as upper bounds for
+// earlier departures (self-pruning). Since arrival times are monotone in the departure time, the labels a chunk would
+// have inherited from all later chunks are exactly the labels of a plain RAPTOR query departing right after the chunk.
+// Every chunk therefore starts with such a query, which makes the result identical to a sequential rRAPTOR.
+class ParallelRangeRAPTOR {
+public:
+    using Type = ParallelRangeRAPTOR;
+
+private:
+    struct Departure {
+        Departure(const int departureTime = never, const StopId stop = noStop)
+            : departureTime(departureTime), stop(stop) {}
+
+        inline bool operator<(const Departure& other) const noexcept {
+            return (departureTime > other.departureTime)
+                   || ((departureTime == other.departureTime) && (stop < other.stop));
+        }
+
+        int departureTime;
+        StopId stop;
+    };
+
+    struct TargetEntry {
+        TargetEntry(const StopId target = noStop, const ProfileEntry& entry = ProfileEntry())
+            : target(target), entry(entry) {}
+
+        StopId target;
+        ProfileEntry entry;
+    };
+
+    // Sequential rRAPTOR over one chunk of departures. arrivalTimes[k][stop] is the earliest arrival time at the stop
+    // with at most k trips among the departures that have been processed so far, so it is non-increasing in k.
+    class Search {
+    public:
+        Search(const Data& data)
+            : data(data),
+              stopsUpdatedByRoute(data.numberOfStops()),
+              stopsUpdatedByTransfer(data.numberOfStops()),
+              routesServingUpdatedStops(data.numberOfRoutes()),
+              walkingTime(nullptr),
+              targetStop(noStop) {}
+
+        inline void run(const StopId source, const StopId target, const std::vector<int>& walkingTimes,
+                        const Departure* begin, const Departure* end, const int boundaryTime,
+                        std::vector<TargetEntry>& result) noexcept {
+            walkingTime = &walkingTimes;
+            targetStop = target;
+            clear();
+
+            // Labels of all journeys departing at or after boundaryTime.
+            addSource(source, boundaryTime);
+            for (const Edge edge : data.transferGraph.edgesFrom(source)) {
+                const StopId stop = StopId(data.transferGraph.get(ToVertex, edge));
+                addSource(stop, boundaryTime + data.transferGraph.get(TravelTime, edge));
+            }
+            runRounds(boundaryTime, nullptr);
+
+            for (const Departure* departure = begin; departure != end;) {
+                const int departureTime = departure->departureTime;
+                for (; departure != end && departure->departureTime == departureTime; departure++) {
+                    addSource(departure->stop, departureTime + (*walkingTime)[departure->stop]);
+                }
+                runRounds(departureTime, &result);
+            }
+        }
+
+        inline long long byteSize() const noexcept {
+            long long result = stopsUpdatedByRoute.byteSize() + stopsUpdatedByTransfer.byteSize();
+            for (const std::vector<int>& round : arrivalTimes) {
+                result += Vector::byteSize(round);
+            }
+            return result;
+        }
+
+    private:
+        inline void clear() noexcept {
+            stopsUpdatedByRoute.clear();
+            stopsUpdatedByTransfer.clear();
+            routesServingUpdatedStops.clear();
+            if (arrivalTimes.empty()) arrivalTimes.emplace_back(data.numberOfStops(), never);
+            for (std::vector<int>& round : arrivalTimes) {
+                Vector::fill(round, never);
+            }
+        }
+
+        inline void addSource(const StopId stop, const int arrivalTime) noexcept {
+            if (arrivalTime >= arrivalTimes[0][stop]) return;
+            updateArrivalTime(0, stop, arrivalTime);
+            stopsUpdatedByTransfer.insert(stop);
+        }
+
+        // Sets the arrival time of the stop in the given round and all later rounds that are not better.
+        inline void updateArrivalTime(const size_t round, const StopId stop, const int arrivalTime) noexcept {
+            for (size_t i = round; i < arrivalTimes.size() && arrivalTimes[i][stop] > arrivalTime; i++) {
+                arrivalTimes[i][stop] = arrivalTime;
+            }
+        }
+
+        inline void runRounds(const int departureTime, std::vector<TargetEntry>* result) noexcept {
+            for (size_t round = 1; !stopsUpdatedByTransfer.empty(); round++) {
+                // A new round starts as a copy of the last one, which keeps the labels non-increasing in the round.
+                if (round == arrivalTimes.size()) arrivalTimes.push_back(arrivalTimes.back());
+                startRound(round, departureTime);
+                scanRoutes(round);
+                relaxTransfers(round);
+                if (result) collectEntries(round, departureTime, *result);
+            }
+        }
+
+        inline void startRound(const size_t round, const int departureTime) noexcept {
+            const std::vector<int>& previous = arrivalTimes[round - 1];
+            routesServingUpdatedStops.clear();
+            for (const StopId stop : stopsUpdatedByTransfer) {
+                const int arrivalTime = previous[stop];
+                for (const RouteSegment& route : data.routesContainingStop(stop)) {
+                    if (route.stopIndex + 1 == data.numberOfStopsInRoute(route.routeId)) continue;
+                    if (data.lastTripOfRoute(route.routeId)[route.stopIndex].departureTime < arrivalTime) continue;
+                    if (routesServingUpdatedStops.contains(route.routeId)) {
+                        routesServingUpdatedStops[route.routeId] =
+                            std::min(routesServingUpdatedStops[route.routeId], route.stopIndex);
+                    } else {
+                        routesServingUpdatedStops.insert(route.routeId, route.stopIndex);
+                    }
+                }
+            }
+            targetBound = never;
+            if (targetStop != noStop) {
+                targetBound = std::min(arrivalTimes[round][targetStop], departureTime + (*walkingTime)[targetStop]);
+            }
+        }
+
+        inline void scanRoutes(const size_t round) noexcept {
+            std::vector<int>& current = arrivalTimes[round];
+            const std::vector<int>& previous = arrivalTimes[round - 1];
+            stopsUpdatedByRoute.clear();
+            for (const RouteId route : routesServingUpdatedStops.getKeys()) {
+                StopIndex stopIndex = routesServingUpdatedStops[route];
+                const size_t tripSize = data.numberOfStopsInRoute(route);
+                const StopId* stops = data.stopArrayOfRoute(route);
+                const StopEvent* firstTrip = data.firstTripOfRoute(route);
+                const StopEvent* trip = data.lastTripOfRoute(route);
+                const int* departureTimes = data.transposedDepartureTimesOfRoute(route);
+                const size_t numberOfTrips = data.numberOfTripsInRoute(route);
+                size_t tripIndex = numberOfTrips - 1;
+                StopId stop = stops[stopIndex];
+                while (stopIndex < tripSize - 1) {
+                    if (departureTimes) {
+                        const size_t earliestTripIndex = findEarliestReachableTrip(
+                            departureTimes + (stopIndex * numberOfTrips), tripIndex, previous[stop]);
+                        if (earliestTripIndex < tripIndex) {
+                            tripIndex = earliestTripIndex;
+                            trip = firstTrip + (tripIndex * tripSize);
+                        }
+                    } else {
+                        while ((trip > firstTrip) && ((trip - tripSize + stopIndex)->departureTime >= previous[stop])) {
+                            trip -= tripSize;
+                        }
+                    }
+                    stopIndex++;
+                    stop = stops[stopIndex];
+                    const int arrivalTime = trip[stopIndex].arrivalTime;
+                    if (arrivalTime >= current[stop] || arrivalTime >= targetBound) continue;
+                    updateArrivalTime(round, stop, arrivalTime);
+                    stopsUpdatedByRoute.insert(stop);
+                    if (stop == targetStop) targetBound = arrivalTime;
+                }
+            }
+        }
+
+        inline void relaxTransfers(const size_t round) noexcept {
+            std::vector<int>& current = arrivalTimes[round];
+            stopsUpdatedByTransfer.clear();
+            for (const StopId stop : stopsUpdatedByRoute) {
+                const int earliestArrivalTime = current[stop];
+                for (const Edge edge : data.transferGraph.edgesFrom(stop)) {
+                    const StopId toStop = StopId(data.transferGraph.get(ToVertex, edge));
+                    const int arrivalTime = earliestArrivalTime + data.transferGraph.get(TravelTime, edge);
+                    if (arrivalTime >= current[toStop] || arrivalTime >= targetBound) continue;
+                    updateArrivalTime(round, toStop, arrivalTime);
+                    stopsUpdatedByTransfer.insert(toStop);
+                    if (toStop == targetStop) targetBound = arrivalTime;
+                }
+                stopsUpdatedByTransfer.insert(stop);
+            }
+        }
+
+        inline void collectEntries(const size_t round, const int departureTime,
+                                   std::vector<TargetEntry>& result) const noexcept {
+            if (targetStop != noStop) {
+                if (stopsUpdatedByTransfer.contains(targetStop)) collectEntry(round, departureTime, targetStop, result);
+            } else {
+                for (const StopId stop : stopsUpdatedByTransfer) {
+                    collectEntry(round, departureTime, stop, result);
+                }
+            }
+        }
+
+        inline void collectEntry(const size_t round, const int departureTime, const StopId stop,
+                                 std::vector<TargetEntry>& result) const noexcept {
+            const int arrivalTime = arrivalTimes[round][stop];
+            if (arrivalTime >= arrivalTimes[round - 1][stop]) return;
+            if (arrivalTime >= departureTime + (*walkingTime)[stop]) return;
+            result.emplace_back(stop, ProfileEntry(departureTime, arrivalTime, round));
+        }
+
+    private:
+        const Data& data;
+
+        std::vector<std::vector<int>> arrivalTimes;
+
+        IndexedSet<false, StopId> stopsUpdatedByRoute;
+        IndexedSet<false, StopId> stopsUpdatedByTransfer;
+        IndexedMap<StopIndex, false, RouteId> routesServingUpdatedStops;
+
+        const std::vector<int>* walkingTime;
+        StopId targetStop;
+        int targetBound;
+    };
+
+public:
+    ParallelRangeRAPTOR(const Data& data, const ThreadPinning& threadPinning, const size_t chunksPerThread = 4)
+        : data(data),
+          threadPinning(threadPinning),
+          chunksPerThread(std::max<size_t>(chunksPerThread, 1)),
+          walkingTime(data.numberOfStops(), INFTY),
+          profiles(data.numberOfStops()),
+          sourceStop(noStop),
+          targetStop(noStop) {
+        AssertMsg(data.hasImplicitBufferTimes(), "Departure buffer times have to be implicit!");
+        searches.reserve(threadPinning.numberOfThreads);
+        for (size_t i = 0; i < threadPinning.numberOfThreads; i++) {
+            searches.emplace_back(data);
+        }
+    }
+
+    // One-to-all profiles for departures in [minDepartureTime, maxDepartureTime).
+    inline void run(const StopId source, const int minDepartureTime = 0,
+                    const int maxDepartureTime = 24 * 60 * 60) noexcept {
+        run(source, noStop, minDepartureTime, maxDepartureTime);
+    }
+
+    // One-to-one profile for departures in [minDepartureTime, maxDepartureTime). If target is noStop, the profiles
+    // of all stops are computed.
+    inline void run(const StopId source, const StopId target, const int minDepartureTime,
+                    const int maxDepartureTime) noexcept {
+        AssertMsg(data.isStop(source), "Source " << source << " is not a stop!");
+        AssertMsg(target == noStop || data.isStop(target), "Target " << target << " is not a stop!");
+        AssertMsg(minDepartureTime <= maxDepartureTime, "Departure time range is empty!");
+        clear();
+        sourceStop = source;
+        targetStop = target;
+
+        walkingTime[source] = 0;
+        for (const Edge edge : data.transferGraph.edgesFrom(source)) {
+            const Vertex stop = data.transferGraph.get(ToVertex, edge);
+            walkingTime[stop] = std::min(walkingTime[stop], data.transferGraph.get(TravelTime, edge));
+        }
+        collectDepartures(minDepartureTime, maxDepartureTime);
+        computeChunks();
+
+        const size_t numberOfChunks = chunkBegin.size() - 1;
+        if (chunkEntries.size() < numberOfChunks) chunkEntries.resize(numberOfChunks);
+        omp_set_num_threads(threadPinning.numberOfThreads);
+#pragma omp parallel
+        {
+            threadPinning.pinThread();
+            Search& search = searches[omp_get_thread_num()];
+
+#pragma omp for schedule(dynamic, 1)
+            for (size_t chunk = 0; chunk < numberOfChunks; chunk++) {
+                chunkEntries[chunk].clear();
+                const int boundaryTime =
+                    (chunk == 0) ? maxDepartureTime : departures[chunkBegin[chunk] - 1].departureTime;
+                search.run(source, target, walkingTime, departures.data() + chunkBegin[chunk],
+                           departures.data() + chunkBegin[chunk + 1], boundaryTime, chunkEntries[chunk]);
+            }
+        }
+
+        // Chunks and the entries within a chunk are ordered by decreasing departure time.
+        for (size_t chunk = numberOfChunks; chunk-- > 0;) {
+            for (size_t i = chunkEntries[chunk].size(); i-- > 0;) {
+                const TargetEntry& entry = chunkEntries[chunk][i];
+                if (profiles[entry.target].empty()) targetsWithProfile.emplace_back(entry.target);
+                profiles[entry.target].emplace_back(entry.entry);
+            }
+        }
+    }
+
+    // Returns the profile of the target stop, ordered by increasing departure time.
+    inline const std::vector<ProfileEntry>& getProfile(const StopId target) const noexcept {
+        AssertMsg(data.isStop(target), "Target " << target << " is not a stop!");
+        return profiles[target];
+    }
+
+    inline const std::vector<ProfileEntry>& getProfile() const noexcept { return getProfile(targetStop); }
+
+    // Returns the Pareto-optimal journeys (with respect to arrival time and number of trips) for a departure at the
+    // given time, which are read from the profile.
+    inline std::vector<ArrivalLabel> getArrivals(const StopId target, const int departureTime) const noexcept {
+        std::vector<ProfileEntry> candidates;
+        for (const ProfileEntry& entry : getProfile(target)) {
+            if (entry.departureTime >= departureTime) candidates.emplace_back(entry);
+        }
+        std::sort(candidates.begin(), candidates.end(), [](const ProfileEntry& a, const ProfileEntry& b) {
+            return std::tie(a.numberOfTrips, a.arrivalTime) < std::tie(b.numberOfTrips, b.arrivalTime);
+        });
+        std::vector<ArrivalLabel> arrivals;
+        for (const ProfileEntry& entry : candidates) {
+            if (!arrivals.empty() && arrivals.back().arrivalTime <= entry.arrivalTime) continue;
+            arrivals.emplace_back(entry.arrivalTime, entry.numberOfTrips);
+        }
+        return arrivals;
+    }
+
+    inline int getWalkingTime(const StopId target) const noexcept { return walkingTime[target]; }
+
+    inline size_t numberOfDepartures() const noexcept { return departures.size(); }
+
+    inline size_t numberOfChunks() const noexcept { return chunkBegin.empty() ? 0 : chunkBegin.size() - 1; }
+
+    inline size_t numberOfProfileEntries() const noexcept {
+        size_t result = 0;
+        for (const StopId stop : targetsWithProfile) {
+            result += profiles[stop].size();
+        }
+        return result;
+    }
+
+    inline long long byteSize() const noexcept {
+        long long result = Vector::byteSize(walkingTime) + Vector::byteSize(departures) + Vector::byteSize(chunkBegin);
+        for (const Search& search : searches) {
+            result += search.byteSize();
+        }
+        for (const std::vector<TargetEntry>& entries : chunkEntries) {
+            result += Vector::byteSize(entries);
+        }
+        for (const std::vector<ProfileEntry>& profile : profiles) {
+            result += Vector::byteSize(profile);
+        }
+        return result;
+    }
+
+private:
+    inline void clear() noexcept {
+        if (sourceStop != noStop) {
+            walkingTime[sourceStop] = INFTY;
+            for (const Edge edge : data.transferGraph.edgesFrom(sourceStop)) {
+                walkingTime[data.transferGraph.get(ToVertex, edge)] = INFTY;
+            }
+        }
+        for (const StopId stop : targetsWithProfile) {
+            profiles[stop].clear();
+        }
+        targetsWithProfile.clear();
+        departures.clear();
+        chunkBegin.clear();
+    }
+
+    inline void collectDepartures(const int minDepartureTime, const int maxDepartureTime) noexcept {
+        collectDepartures(sourceStop, minDepartureTime, maxDepartureTime);
+        for (const Edge edge : data.transferGraph.edgesFrom(sourceStop)) {
+            collectDepartures(StopId(data.transferGraph.get(ToVertex, edge)), minDepartureTime, maxDepartureTime);
+        }
+        std::sort(departures.begin(), departures.end());
+    }
+
+    inline void collectDepartures(const StopId stop, const int minDepartureTime, const int maxDepartureTime) noexcept {
+        const int walking = walkingTime[stop];
+        for (const RouteSegment& route : data.routesContainingStop(stop)) {
+            const size_t tripSize = data.numberOfStopsInRoute(route.routeId);
+            if (route.stopIndex + 1 == tripSize) continue;
+            const StopEvent* lastTrip = data.lastTripOfRoute(route.routeId);
+            for (const StopEvent* trip = data.firstTripOfRoute(route.routeId); trip <= lastTrip; trip += tripSize) {
+                const int departureTime = trip[route.stopIndex].departureTime - walking;
+                if (departureTime < minDepartureTime || departureTime >= maxDepartureTime) continue;
+                departures.emplace_back(departureTime, stop);
+            }
+        }
+    }
+
+    // Splits the departures into chunks of roughly equal size. Departures with the same departure time are processed
+    // in the same rRAPTOR iteration and therefore belong to the same chunk.
+    inline void computeChunks() noexcept {
+        const size_t numberOfChunks = std::max<size_t>(1, threadPinning.numberOfThreads * chunksPerThread);
+        const size_t chunkSize = (departures.size() + numberOfChunks - 1) / numberOfChunks;
+        chunkBegin.emplace_back(0);
+        size_t i = 0;
+        while (i < departures.size()) {
+            i = std::min(i + std::max<size_t>(chunkSize, 1), departures.size());
+            while (i < departures.size() && departures[i].departureTime == departures[i - 1].departureTime) {
+                i++;
+            }
+            chunkBegin.emplace_back(i);
+        }
+        if (chunkBegin.size() == 1) chunkBegin.emplace_back(0);
+    }
+
+private:
+    const Data& data;
+    const ThreadPinning threadPinning;
+    const size_t chunksPerThread;
+
+    std::vector<Search> searches;
+
+    std::vector<int> walkingTime;
+    std::vector<Departure> departures;
+    std::vector<size_t> chunkBegin;
+    std::vector<std::vector<TargetEntry>> chunkEntries;
+
+    std::vector<std::vector<ProfileEntry>> profiles;
+    std::vector<StopId> targetsWithProfile;
+
+    StopId sourceStop;
+    StopId targetStop;
+};
+
+} // namespace RAPTOR
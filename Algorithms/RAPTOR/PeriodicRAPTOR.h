@@ -0,0 +1,195 @@
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+#include "../../DataStructures/Container/Map.h"
+#include "../../DataStructures/Container/Set.h"
+#include "../../DataStructures/RAPTOR/Data.h"
+#include "../../Helpers/Assert.h"
+#include "../../Helpers/PeriodicTime.h"
+#include "../../Helpers/Types.h"
+#include "../../Helpers/Vector/Vector.h"
+
+namespace RAPTOR {
+
+// Transitive earliest arrival RAPTOR on a periodic timetable, in which every trip operates once per period (see
+// PeriodicTime.h). A route scan follows a trip instance, i.e., a trip together with the day on which it started, and
+// the earliest instance that can be boarded at a stop is found among the instances of the days that can depart on the
+// day of the arrival. Since every route operates again in the next period, a route can always be boarded. The routes
+// are scanned against the arrival times of the previous round, so round k finds all journeys with k trips. Departure
+// buffer times have to be implicit. Journeys are not retrieved.
+class PeriodicRAPTOR {
+public:
+    PeriodicRAPTOR(const Data& data, const int period = PeriodicTime::DefaultPeriod)
+        : data(data),
+          period(period),
+          maxDayShift(0),
+          arrivalTime(data.numberOfStops(), never),
+          stopsUpdatedByRoute(data.numberOfStops()),
+          stopsUpdatedByTransfer(data.numberOfStops()),
+          routesServingUpdatedStops(data.numberOfRoutes()),
+          targetStop(noStop),
+          numberOfRounds(0),
+          numberOfScannedRouteSegments(0) {
+        AssertMsg(period > 0, "Period must be positive!");
+        AssertMsg(data.hasImplicitBufferTimes(), "Departure buffer times have to be implicit!");
+        for (const StopEvent& stopEvent : data.stopEvents) {
+            AssertMsg(stopEvent.departureTime >= 0, "Departure times must not be negative!");
+            maxDayShift = std::max(maxDayShift, PeriodicTime::dayOf(stopEvent.departureTime, period));
+        }
+    }
+
+    inline void run(const StopId source, const int departureTime, const StopId target = noStop,
+                    const size_t maxRounds = INFTY) noexcept {
+        AssertMsg(data.isStop(source), "Source stop " << source << " is not a valid stop!");
+        clear();
+        targetStop = target;
+        arrivalTime[source] = departureTime;
+        stopsUpdatedByRoute.insert(source);
+        relaxTransfers();
+        for (numberOfRounds = 0; numberOfRounds < maxRounds && !stopsUpdatedByTransfer.empty(); numberOfRounds++) {
+            collectRoutesServingUpdatedStops();
+            scanRoutes();
+            if (stopsUpdatedByRoute.empty()) break;
+            relaxTransfers();
+        }
+    }
+
+    inline bool reachable(const StopId stop) const noexcept { return arrivalTime[stop] < never; }
+
+    inline int getEarliestArrivalTime(const StopId stop) const noexcept { return arrivalTime[stop]; }
+
+    inline int getPeriod() const noexcept { return period; }
+
+    inline int getMaxDayShift() const noexcept { return maxDayShift; }
+
+    inline size_t getNumberOfRounds() const noexcept { return numberOfRounds; }
+
+    inline size_t getNumberOfScannedRouteSegments() const noexcept { return numberOfScannedRouteSegments; }
+
+private:
+    struct RouteArrival {
+        RouteArrival(const StopId stop = noStop, const int arrivalTime = never)
+            : stop(stop), arrivalTime(arrivalTime) {}
+        StopId stop;
+        int arrivalTime;
+    };
+
+    inline void clear() noexcept {
+        Vector::fill(arrivalTime, never);
+        stopsUpdatedByRoute.clear();
+        stopsUpdatedByTransfer.clear();
+        routesServingUpdatedStops.clear();
+        targetStop = noStop;
+        numberOfRounds = 0;
+        numberOfScannedRouteSegments = 0;
+    }
+
+    inline void collectRoutesServingUpdatedStops() noexcept {
+        routesServingUpdatedStops.clear();
+        for (const StopId stop : stopsUpdatedByTransfer) {
+            for (const RouteSegment& route : data.routesContainingStop(stop)) {
+                if (route.stopIndex + 1 == data.numberOfStopsInRoute(route.routeId)) continue;
+                if (routesServingUpdatedStops.contains(route.routeId)) {
+                    routesServingUpdatedStops[route.routeId] =
+                        std::min(routesServingUpdatedStops[route.routeId], route.stopIndex);
+                } else {
+                    routesServingUpdatedStops.insert(route.routeId, route.stopIndex);
+                }
+            }
+        }
+    }
+
+    // The arrivals are applied after all routes have been scanned, so every route is scanned against the arrival
+    // times of the previous round.
+    inline void scanRoutes() noexcept {
+        stopsUpdatedByRoute.clear();
+        routeArrivals.clear();
+        for (const RouteId route : routesServingUpdatedStops.getKeys()) {
+            scanRoute(route, routesServingUpdatedStops[route]);
+        }
+        for (const RouteArrival& arrival : routeArrivals) {
+            if (improvesArrivalTime(arrival.stop, arrival.arrivalTime)) {
+                arrivalTime[arrival.stop] = arrival.arrivalTime;
+                stopsUpdatedByRoute.insert(arrival.stop);
+            }
+        }
+    }
+
+    inline void scanRoute(const RouteId route, StopIndex stopIndex) noexcept {
+        const size_t tripSize = data.numberOfStopsInRoute(route);
+        const size_t numberOfTrips = data.numberOfTripsInRoute(route);
+        const StopId* stops = data.stopArrayOfRoute(route);
+        const StopEvent* firstTrip = data.firstTripOfRoute(route);
+        const int* departureTimes = data.transposedDepartureTimesOfRoute(route);
+        PeriodicTime::TripInstance trip;
+        const StopEvent* tripEvents = nullptr;
+        for (; stopIndex + 1 < tripSize; stopIndex++) {
+            const int stopArrivalTime = arrivalTime[stops[stopIndex]];
+            if (stopArrivalTime < never) {
+                const int currentDepartureTime =
+                    trip.exists() ? tripEvents[stopIndex].departureTime + trip.day * period : never;
+                if (stopArrivalTime < currentDepartureTime) {
+                    const PeriodicTime::TripInstance earliestTrip =
+                        departureTimes
+                            ? PeriodicTime::earliestInstance(
+                                  numberOfTrips,
+                                  [&](const size_t i) { return departureTimes[stopIndex * numberOfTrips + i]; },
+                                  stopArrivalTime, period, maxDayShift)
+                            : PeriodicTime::earliestInstance(
+                                  numberOfTrips,
+                                  [&](const size_t i) { return firstTrip[i * tripSize + stopIndex].departureTime; },
+                                  stopArrivalTime, period, maxDayShift);
+                    if (earliestTrip.departureTime < currentDepartureTime) {
+                        trip = earliestTrip;
+                        tripEvents = firstTrip + trip.index * tripSize;
+                    }
+                }
+            }
+            if (!trip.exists()) continue;
+            numberOfScannedRouteSegments++;
+            const StopId nextStop = stops[stopIndex + 1];
+            const int nextArrivalTime = tripEvents[stopIndex + 1].arrivalTime + trip.day * period;
+            if (improvesArrivalTime(nextStop, nextArrivalTime)) routeArrivals.emplace_back(nextStop, nextArrivalTime);
+        }
+    }
+
+    inline void relaxTransfers() noexcept {
+        stopsUpdatedByTransfer.clear();
+        for (const StopId stop : stopsUpdatedByRoute) {
+            const int time = arrivalTime[stop];
+            for (const Edge edge : data.transferGraph.edgesFrom(stop)) {
+                const StopId toStop = StopId(data.transferGraph.get(ToVertex, edge));
+                const int newArrivalTime = time + data.transferGraph.get(TravelTime, edge);
+                if (!improvesArrivalTime(toStop, newArrivalTime)) continue;
+                arrivalTime[toStop] = newArrivalTime;
+                stopsUpdatedByTransfer.insert(toStop);
+            }
+            stopsUpdatedByTransfer.insert(stop);
+        }
+    }
+
+    inline bool improvesArrivalTime(const StopId stop, const int time) const noexcept {
+        if (targetStop != noStop && arrivalTime[targetStop] <= time) return false;
+        return arrivalTime[stop] > time;
+    }
+
+private:
+    const Data& data;
+    const int period;
+    int maxDayShift;
+
+    std::vector<int> arrivalTime;
+
+    IndexedSet<false, StopId> stopsUpdatedByRoute;
+    IndexedSet<false, StopId> stopsUpdatedByTransfer;
+    IndexedMap<StopIndex, false, RouteId> routesServingUpdatedStops;
+    std::vector<RouteArrival> routeArrivals;
+
+    StopId targetStop;
+    size_t numberOfRounds;
+    size_t numberOfScannedRouteSegments;
+};
+
+} // namespace RAPTOR
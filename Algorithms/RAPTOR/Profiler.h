@@ -80,6 +80,7 @@ public:
     inline void donePhase(const Phase) const noexcept {}
 
     inline void countMetric(const Metric) const noexcept {}
+    inline void countMetric(const Metric, const long long) const noexcept {}
 };
 
 class BasicProfiler : public NoProfiler {
@@ -128,6 +129,8 @@ public:
 
     inline void countMetric(const Metric metric) noexcept { metricValue[metric]++; }
 
+    inline void countMetric(const Metric metric, const long long value) noexcept { metricValue[metric] += value; }
+
     inline void printStatistics() const noexcept {
         std::cout << "Number of scanned routes: " << String::prettyDouble(metricValue[METRIC_ROUTES] / numQueries, 0)
                   << std::endl;
@@ -277,6 +280,10 @@ public:
 
     inline void countMetric(const Metric metric) const noexcept { currentRoundData->metricValue[metric]++; }
 
+    inline void countMetric(const Metric metric, const long long value) const noexcept {
+        currentRoundData->metricValue[metric] += value;
+    }
+
     inline double getTotalTime() const noexcept { return totalTime; }
 
     inline double getExtraRoundTime(const ExtraRound extraRound) const noexcept {
@@ -429,6 +436,10 @@ public:
 
     inline void countMetric(const Metric metric) const noexcept { currentRoundData->metricValue[metric]++; }
 
+    inline void countMetric(const Metric metric, const long long value) const noexcept {
+        currentRoundData->metricValue[metric] += value;
+    }
+
     inline double getTotalTime() const noexcept { return totalTime / numQueries; }
 
     inline double getExtraRoundTime(const ExtraRound extraRound) const noexcept {
@@ -1,7 +1,9 @@
 #pragma once
 
 #include "Profiler.h"
+#include "TripSearch.h"
 #include <iostream>
+#include <omp.h>
 #include <string>
 #include <vector>
 
@@ -9,11 +11,12 @@
 #include "../../DataStructures/Container/Set.h"
 #include "../../DataStructures/RAPTOR/Data.h"
 #include "../../DataStructures/RAPTOR/Entities/EarliestArrivalTime.h"
+#include "../../DataStructures/RAPTOR/Entities/Rounds.h"
 
 namespace RAPTOR {
 
 template <bool TARGET_PRUNING, typename PROFILER = NoProfiler, bool TRANSITIVE = true,
-          bool USE_MIN_TRANSFER_TIMES = false, bool PREVENT_DIRECT_WALKING = false>
+          bool USE_MIN_TRANSFER_TIMES = false, bool PREVENT_DIRECT_WALKING = false, bool SPARSE_ROUNDS = false>
 class RAPTOR {
 public:
     static constexpr bool TargetPruning = TARGET_PRUNING;
@@ -21,10 +24,11 @@ public:
     static constexpr bool Transitive = TRANSITIVE;
     static constexpr bool UseMinTransferTimes = USE_MIN_TRANSFER_TIMES;
     static constexpr bool PreventDirectWalking = PREVENT_DIRECT_WALKING;
+    static constexpr bool SparseRounds = SPARSE_ROUNDS;
     static constexpr bool SeparateRouteAndTransferEntries = !Transitive | UseMinTransferTimes | PreventDirectWalking;
     static constexpr int RoundFactor = SeparateRouteAndTransferEntries ? 2 : 1;
     using ArrivalTime = EarliestArrivalTime<SeparateRouteAndTransferEntries>;
-    using Type = RAPTOR<TargetPruning, Profiler, Transitive, UseMinTransferTimes, PreventDirectWalking>;
+    using Type = RAPTOR<TargetPruning, Profiler, Transitive, UseMinTransferTimes, PreventDirectWalking, SparseRounds>;
     using InitialTransferGraph = TransferGraph;
     using SourceType = StopId;
 
@@ -41,11 +45,27 @@ private:
             Edge transferId;
         };
     };
-    using Round = std::vector<EarliestArrivalLabel>;
+    using RoundLabels = Rounds<EarliestArrivalLabel, SparseRounds>;
+
+    struct RouteArrival {
+        RouteArrival(const StopId stop = noStop, const int arrivalTime = never, const StopId parent = noStop,
+                     const int parentDepartureTime = never, const RouteId routeId = noRouteId)
+            : stop(stop),
+              arrivalTime(arrivalTime),
+              parent(parent),
+              parentDepartureTime(parentDepartureTime),
+              routeId(routeId) {}
+        StopId stop;
+        int arrivalTime;
+        StopId parent;
+        int parentDepartureTime;
+        RouteId routeId;
+    };
 
 public:
     RAPTOR(const Data& data, const Profiler& profilerTemplate = Profiler())
         : data(data),
+          rounds(data.numberOfStops()),
           earliestArrival(data.numberOfStops()),
           stopsUpdatedByRoute(data.numberOfStops()),
           stopsUpdatedByTransfer(data.numberOfStops()),
@@ -54,6 +74,8 @@ public:
           targetStop(noStop),
           sourceDepartureTime(never),
           walkingDistance(INFTY),
+          numberOfThreads(1),
+          minNumberOfRoutesForParallelScan(INFTY),
           profiler(profilerTemplate) {
         if constexpr (UseMinTransferTimes) {
             AssertMsg(!data.hasImplicitBufferTimes(), "Either min transfer times have to be used OR departure buffer "
@@ -179,7 +201,7 @@ public:
         sourceDepartureTime = never;
         walkingDistance = INFTY;
         if constexpr (RESET_CAPACITIES) {
-            std::vector<Round>().swap(rounds);
+            rounds.reset();
             std::vector<ArrivalTime>(earliestArrival.size(), never).swap(earliestArrival);
         } else {
             rounds.clear();
@@ -191,6 +213,14 @@ public:
 
     inline const Profiler& getProfiler() const noexcept { return profiler; }
 
+    // Rounds in which at least minNumberOfRoutes routes have to be scanned are processed by the given number of
+    // threads. A single thread disables the parallel route scans.
+    inline void setParallelRouteScans(const size_t threads, const size_t minNumberOfRoutes = 512) noexcept {
+        numberOfThreads = std::max<size_t>(threads, 1);
+        minNumberOfRoutesForParallelScan = minNumberOfRoutes;
+        routeArrivalsOfThread.resize(numberOfThreads);
+    }
+
     inline int getArrivalTime(const StopId stop, const size_t numberOfTrips) const noexcept {
         size_t round = numberOfTrips * RoundFactor;
         if constexpr (SeparateRouteAndTransferEntries) {
@@ -238,43 +268,102 @@ private:
 
     inline void scanRoutes() noexcept {
         stopsUpdatedByRoute.clear();
+        if (numberOfThreads > 1 && routesServingUpdatedStops.size() >= minNumberOfRoutesForParallelScan) {
+            scanRoutesInParallel();
+            return;
+        }
         for (const RouteId route : routesServingUpdatedStops.getKeys()) {
             profiler.countMetric(METRIC_ROUTES);
-            StopIndex stopIndex = routesServingUpdatedStops[route];
-            const size_t tripSize = data.numberOfStopsInRoute(route);
-            AssertMsg(stopIndex < tripSize - 1, "Cannot scan a route starting at/after the last stop (Route: "
-                                                    << route << ", StopIndex: " << stopIndex
-                                                    << ", TripSize: " << tripSize << ")!");
-
-            const StopId* stops = data.stopArrayOfRoute(route);
-            const StopEvent* trip = data.lastTripOfRoute(route);
-            StopId stop = stops[stopIndex];
-            AssertMsg(trip[stopIndex].departureTime >= previousRound()[stop].arrivalTime,
-                      "Cannot scan a route after the last trip has departed (Route: "
-                          << route << ", Stop: " << stop << ", StopIndex: " << stopIndex
-                          << ", Time: " << previousRound()[stop].arrivalTime
-                          << ", LastDeparture: " << trip[stopIndex].departureTime << ")!");
-
-            StopIndex parentIndex = stopIndex;
-            const StopEvent* firstTrip = data.firstTripOfRoute(route);
-            while (stopIndex < tripSize - 1) {
+            profiler.countMetric(METRIC_ROUTE_SEGMENTS, scanRoute(route, [&](const RouteArrival& arrival) {
+                                     applyRouteArrival(arrival);
+                                 }));
+        }
+    }
+
+    // The routes are split into one contiguous block per thread. The threads only read the labels of the previous
+    // round and collect the arrivals that improve the earliest arrival times known before the round. Afterwards, the
+    // arrivals are applied in the order of the routes, which yields exactly the labels of a sequential scan.
+    inline void scanRoutesInParallel() noexcept {
+        const std::vector<RouteId>& routes = routesServingUpdatedStops.getKeys();
+        for (std::vector<RouteArrival>& arrivals : routeArrivalsOfThread) {
+            arrivals.clear();
+        }
+        long long numberOfRouteSegments = 0;
+#pragma omp parallel num_threads(numberOfThreads) reduction(+ : numberOfRouteSegments)
+        {
+            std::vector<RouteArrival>& arrivals = routeArrivalsOfThread[omp_get_thread_num()];
+#pragma omp for schedule(static)
+            for (size_t i = 0; i < routes.size(); i++) {
+                numberOfRouteSegments += scanRoute(routes[i], [&](const RouteArrival& arrival) {
+                    if (improvesArrivalByRoute(arrival.stop, arrival.arrivalTime)) arrivals.emplace_back(arrival);
+                });
+            }
+        }
+        profiler.countMetric(METRIC_ROUTES, routes.size());
+        profiler.countMetric(METRIC_ROUTE_SEGMENTS, numberOfRouteSegments);
+        for (const std::vector<RouteArrival>& arrivals : routeArrivalsOfThread) {
+            for (const RouteArrival& arrival : arrivals) {
+                applyRouteArrival(arrival);
+            }
+        }
+    }
+
+    // Scans the route without modifying any labels and passes every arrival to the given callback. Returns the number
+    // of scanned route segments.
+    template <typename ARRIVAL_CALLBACK>
+    inline size_t scanRoute(const RouteId route, const ARRIVAL_CALLBACK& arrivalCallback) const noexcept {
+        StopIndex stopIndex = routesServingUpdatedStops[route];
+        const size_t tripSize = data.numberOfStopsInRoute(route);
+        AssertMsg(stopIndex < tripSize - 1, "Cannot scan a route starting at/after the last stop (Route: "
+                                                << route << ", StopIndex: " << stopIndex << ", TripSize: " << tripSize
+                                                << ")!");
+
+        const StopId* stops = data.stopArrayOfRoute(route);
+        const StopEvent* trip = data.lastTripOfRoute(route);
+        StopId stop = stops[stopIndex];
+        AssertMsg(trip[stopIndex].departureTime >= previousRound()[stop].arrivalTime,
+                  "Cannot scan a route after the last trip has departed (Route: "
+                      << route << ", Stop: " << stop << ", StopIndex: " << stopIndex
+                      << ", Time: " << previousRound()[stop].arrivalTime
+                      << ", LastDeparture: " << trip[stopIndex].departureTime << ")!");
+
+        const StopIndex firstStopIndex = stopIndex;
+        StopIndex parentIndex = stopIndex;
+        const StopEvent* firstTrip = data.firstTripOfRoute(route);
+        const int* departureTimes = data.transposedDepartureTimesOfRoute(route);
+        const size_t numberOfTrips = data.numberOfTripsInRoute(route);
+        size_t tripIndex = numberOfTrips - 1;
+        while (stopIndex < tripSize - 1) {
+            if (departureTimes) {
+                const size_t earliestTripIndex = findEarliestReachableTrip(
+                    departureTimes + (stopIndex * numberOfTrips), tripIndex, previousRound()[stop].arrivalTime);
+                if (earliestTripIndex < tripIndex) {
+                    tripIndex = earliestTripIndex;
+                    trip = firstTrip + (tripIndex * tripSize);
+                    parentIndex = stopIndex;
+                }
+            } else {
                 while ((trip > firstTrip)
                        && ((trip - tripSize + stopIndex)->departureTime >= previousRound()[stop].arrivalTime)) {
                     trip -= tripSize;
                     parentIndex = stopIndex;
                 }
-                stopIndex++;
-                stop = stops[stopIndex];
-                profiler.countMetric(METRIC_ROUTE_SEGMENTS);
-                if (arrivalByRoute(stop, trip[stopIndex].arrivalTime)) {
-                    EarliestArrivalLabel& label = currentRound()[stop];
-                    label.parent = stops[parentIndex];
-                    label.parentDepartureTime = trip[parentIndex].departureTime;
-                    label.usesRoute = true;
-                    label.routeId = route;
-                }
             }
+            stopIndex++;
+            stop = stops[stopIndex];
+            arrivalCallback(RouteArrival(stop, trip[stopIndex].arrivalTime, stops[parentIndex],
+                                         trip[parentIndex].departureTime, route));
         }
+        return stopIndex - firstStopIndex;
+    }
+
+    inline void applyRouteArrival(const RouteArrival& arrival) noexcept {
+        if (!arrivalByRoute(arrival.stop, arrival.arrivalTime)) return;
+        EarliestArrivalLabel& label = currentRound()[arrival.stop];
+        label.parent = arrival.parent;
+        label.parentDepartureTime = arrival.parentDepartureTime;
+        label.usesRoute = true;
+        label.routeId = arrival.routeId;
     }
 
     template <bool INITIAL_TRANSFERS = false>
@@ -328,17 +417,23 @@ private:
         }
     }
 
-    inline Round& currentRound() noexcept {
+    inline typename RoundLabels::RoundReference currentRound() noexcept {
         AssertMsg(!rounds.empty(), "Cannot return current round, because no round exists!");
         return rounds.back();
     }
 
-    inline Round& previousRound() noexcept {
+    inline typename RoundLabels::ConstRoundReference previousRound() const noexcept {
         AssertMsg(rounds.size() >= 2, "Cannot return previous round, because less than two rounds exist!");
         return rounds[rounds.size() - 2];
     }
 
-    inline void startNewRound() noexcept { rounds.emplace_back(data.numberOfStops()); }
+    inline void startNewRound() noexcept { rounds.emplace_back(); }
+
+    inline bool improvesArrivalByRoute(const StopId stop, const int time) const noexcept {
+        if constexpr (TargetPruning)
+            if (earliestArrival[targetStop].getArrivalTimeByRoute() <= time) return false;
+        return earliestArrival[stop].getArrivalTimeByRoute() > time;
+    }
 
     inline bool arrivalByRoute(const StopId stop, const int time) noexcept {
         AssertMsg(data.isStop(stop), "Stop " << stop << " is out of range!");
@@ -407,7 +502,7 @@ private:
 private:
     const Data& data;
 
-    std::vector<Round> rounds;
+    RoundLabels rounds;
 
     std::vector<ArrivalTime> earliestArrival;
 
@@ -420,6 +515,10 @@ private:
     int sourceDepartureTime;
     int walkingDistance;
 
+    size_t numberOfThreads;
+    size_t minNumberOfRoutesForParallelScan;
+    std::vector<std::vector<RouteArrival>> routeArrivalsOfThread;
+
     Profiler profiler;
 };
 
@@ -0,0 +1,70 @@
+#pragma once
+
+#ifdef USE_SIMD
+#include <immintrin.h>
+#endif
+
+#include "../../Helpers/Types.h"
+
+namespace RAPTOR {
+
+// Trip search on one column of the transposed departure times of a route (see Data::buildTransposedDepartureTimes()),
+// i.e., on the departure times of all trips of the route at a fixed stop index, ordered by trip.
+
+// Returns the smallest index i <= tripIndex such that all trips in [i, tripIndex) depart at or after the given time.
+// This is the same trip that is found by stepping backwards from tripIndex as long as the previous trip can be reached.
+// The previous trip is checked first, since most route segments do not change the trip. Afterwards, blocks of 8
+// departure times are compared at once with AVX2.
+inline size_t findEarliestReachableTrip(const int* departureTimes, size_t tripIndex, const int time) noexcept {
+    if (tripIndex == 0 || departureTimes[tripIndex - 1] < time) return tripIndex;
+    tripIndex--;
+#if defined(USE_SIMD) && defined(__AVX2__)
+    const __m256i times = _mm256_set1_epi32(time);
+    while (tripIndex >= 8) {
+        const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(departureTimes + tripIndex - 8));
+        const int tooEarly = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(times, block)));
+        if (tooEarly != 0) return tripIndex - 7 + (31 - __builtin_clz(tooEarly));
+        tripIndex -= 8;
+    }
+#endif
+    while (tripIndex > 0 && departureTimes[tripIndex - 1] >= time) {
+        tripIndex--;
+    }
+    return tripIndex;
+}
+
+// Returns the index of the first trip that departs at or after the given time, or numberOfTrips if there is none.
+inline size_t findFirstReachableTrip(const int* departureTimes, const size_t numberOfTrips, const int time) noexcept {
+    size_t tripIndex = 0;
+#if defined(USE_SIMD) && defined(__AVX2__)
+    const __m256i times = _mm256_set1_epi32(time);
+    for (; tripIndex + 8 <= numberOfTrips; tripIndex += 8) {
+        const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(departureTimes + tripIndex));
+        const int reachable = ~_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(times, block))) & 0xFF;
+        if (reachable != 0) return tripIndex + __builtin_ctz(reachable);
+    }
+#endif
+    while (tripIndex < numberOfTrips && departureTimes[tripIndex] < time) {
+        tripIndex++;
+    }
+    return tripIndex;
+}
+
+// Same as findFirstReachableTrip(), but long columns are first narrowed down by binary search, which requires the
+// departure times to be sorted (i.e., the trips of the route do not overtake each other).
+inline size_t findFirstReachableTripInSortedColumn(const int* departureTimes, const size_t numberOfTrips,
+                                                   const int time) noexcept {
+    size_t begin = 0;
+    size_t end = numberOfTrips;
+    while (end - begin > 32) {
+        const size_t middle = begin + ((end - begin) / 2);
+        if (departureTimes[middle] < time) {
+            begin = middle + 1;
+        } else {
+            end = middle;
+        }
+    }
+    return begin + findFirstReachableTrip(departureTimes + begin, end - begin, time);
+}
+
+} // namespace RAPTOR
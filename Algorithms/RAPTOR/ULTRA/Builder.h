@@ -1,7 +1,10 @@
 #pragma once
 
 #include "ShortcutSearch.h"
+#include "../../Dijkstra/Dijkstra.h"
 #include <algorithm>
+#include <tuple>
+#include <vector>
 
 #include "../../../DataStructures/RAPTOR/Data.h"
 #include "../../../Helpers/Console/Progress.h"
@@ -18,56 +21,190 @@ public:
     inline static constexpr bool IgnoreIsolatedCandidates = IGNORE_ISOLATED_CANDIDATES;
     using Type = Builder<Debug, CountOptimalCandidates, IgnoreIsolatedCandidates>;
 
+private:
+    struct ShortcutEntry {
+        ShortcutEntry(const Vertex to = noVertex, const int travelTime = never) : to(to), travelTime(travelTime) {}
+        inline bool operator<(const ShortcutEntry& other) const noexcept {
+            return std::tie(to, travelTime) < std::tie(other.to, other.travelTime);
+        }
+        inline bool operator==(const ShortcutEntry& other) const noexcept {
+            return to == other.to && travelTime == other.travelTime;
+        }
+        Vertex to;
+        int travelTime;
+    };
+
 public:
-    Builder(const Data& data) : data(data) {
+    Builder(const Data& data) : data(data) { initializeShortcutGraph(); }
+
+    void computeShortcuts(const ThreadPinning& threadPinning, const int witnessTransferLimit = 15 * 60,
+                          const int minDepartureTime = -never, const int maxDepartureTime = never,
+                          const bool verbose = true) noexcept {
+        computeShortcuts(threadPinning, Vector::id<StopId>(data.numberOfStops()), witnessTransferLimit,
+                         minDepartureTime, maxDepartureTime, verbose);
+    }
+
+    // Updates the shortcuts of oldShortcutGraph, which were computed for the timetable of data but a different
+    // transfer graph. changedEdges contains every edge (from, to) of the transfer graph that was inserted, removed
+    // or whose travel time was changed. Old shortcuts whose path may contain a changed edge are discarded, all other
+    // shortcuts are kept. The shortcut search is then rerun for every source stop that can walk within the search
+    // radius to a trip towards a discarded shortcut or towards a stop within the search radius of a changed edge.
+    // Changes that only affect journeys beyond the search radius are not detected, so a full recomputation is still
+    // required after large changes to the transfer graph.
+    void updateShortcuts(const ThreadPinning& threadPinning, const TransferGraph& oldShortcutGraph,
+                         const std::vector<std::pair<Vertex, Vertex>>& changedEdges,
+                         const int witnessTransferLimit = 15 * 60, const int searchRadius = 15 * 60,
+                         const int minDepartureTime = -never, const int maxDepartureTime = never,
+                         const bool verbose = true) noexcept {
+        AssertMsg(oldShortcutGraph.numVertices() == data.numberOfStops(),
+                  "Old shortcut graph has " << oldShortcutGraph.numVertices() << " vertices, but there are "
+                                            << data.numberOfStops() << " stops!");
+        int distanceLimit = searchRadius;
+        for (const Edge edge : oldShortcutGraph.edges()) {
+            distanceLimit = std::max(distanceLimit, oldShortcutGraph.get(TravelTime, edge));
+        }
+
+        TransferGraph reverseGraph = data.transferGraph;
+        reverseGraph.revert();
+        Dijkstra<TransferGraph, false> dijkstra(reverseGraph);
+        const auto pruneBeyondLimit = [&](const Vertex from, const Edge edge) {
+            return dijkstra.getDistance(from) + reverseGraph.get(TravelTime, edge) > distanceLimit;
+        };
+
+        // Distance from every stop to the nearest changed edge.
+        std::vector<Vertex> changedEdgeTails;
+        for (const auto& [from, to] : changedEdges) {
+            AssertMsg(data.transferGraph.isVertex(from), from << " is not a valid vertex!");
+            suppressUnusedParameterWarning(to);
+            changedEdgeTails.emplace_back(from);
+        }
+        dijkstra.run(changedEdgeTails, noVertex, NoOperation, NoOperation, pruneBeyondLimit);
+        std::vector<bool> isNearChange(data.numberOfStops(), false);
+        for (const StopId stop : data.stops()) {
+            isNearChange[stop] = dijkstra.reachable(stop) && dijkstra.getDistance(stop) <= searchRadius;
+        }
+
+        initializeShortcutGraph();
+        size_t keptShortcuts = 0;
+        for (const auto [edge, from] : oldShortcutGraph.edgesWithFromVertex()) {
+            const int travelTime = oldShortcutGraph.get(TravelTime, edge);
+            if (dijkstra.reachable(from) && dijkstra.getDistance(from) <= travelTime) {
+                isNearChange[from] = true;
+                continue;
+            }
+            shortcutGraph.addEdge(from, oldShortcutGraph.get(ToVertex, edge)).set(TravelTime, travelTime);
+            keptShortcuts++;
+        }
+
+        // Stops from which a trip towards a stop near the change can be boarded.
+        std::vector<bool> isBoardingStop = isNearChange;
+        for (const StopId stop : data.stops()) {
+            if (!isNearChange[stop]) continue;
+            for (const RouteSegment& route : data.routesContainingStop(stop)) {
+                const StopId* stops = data.stopArrayOfRoute(route.routeId);
+                for (size_t i = 0; i < route.stopIndex; i++) {
+                    isBoardingStop[stops[i]] = true;
+                }
+            }
+        }
+        std::vector<Vertex> boardingStops;
+        for (const StopId stop : data.stops()) {
+            if (isBoardingStop[stop]) boardingStops.emplace_back(stop);
+        }
+
+        // Source stops that can walk to a boarding stop, extended to the representatives of their stations.
+        std::vector<Vertex> affectedStops;
+        distanceLimit = searchRadius;
+        dijkstra.run(boardingStops, noVertex, NoOperation, NoOperation, pruneBeyondLimit);
+        for (const StopId stop : data.stops()) {
+            if (dijkstra.reachable(stop)) affectedStops.emplace_back(stop);
+        }
+        Dijkstra<TransferGraph, false> stationDijkstra(data.transferGraph);
+        stationDijkstra.run(affectedStops, noVertex, NoOperation, NoOperation, [&](const Vertex, const Edge edge) {
+            return data.transferGraph.get(TravelTime, edge) > 0;
+        });
+        std::vector<StopId> sources;
+        for (const StopId stop : data.stops()) {
+            if (stationDijkstra.reachable(stop)) sources.emplace_back(stop);
+        }
+
+        if (verbose) {
+            std::cout << "Kept shortcuts: " << String::prettyInt(keptShortcuts) << " of "
+                      << String::prettyInt(oldShortcutGraph.numEdges()) << std::endl;
+            std::cout << "Affected source stops: " << String::prettyInt(sources.size()) << " of "
+                      << String::prettyInt(data.numberOfStops()) << std::endl;
+        }
+        computeShortcuts(threadPinning, sources, witnessTransferLimit, minDepartureTime, maxDepartureTime, verbose);
+    }
+
+    inline const DynamicTransferGraph& getShortcutGraph() const noexcept { return shortcutGraph; }
+
+    inline DynamicTransferGraph& getShortcutGraph() noexcept { return shortcutGraph; }
+
+private:
+    inline void initializeShortcutGraph() noexcept {
+        shortcutGraph.clear();
         shortcutGraph.addVertices(data.numberOfStops());
         for (const Vertex vertex : shortcutGraph.vertices()) {
             shortcutGraph.set(Coordinates, vertex, data.transferGraph.get(Coordinates, vertex));
         }
     }
 
-    void computeShortcuts(const ThreadPinning& threadPinning, const int witnessTransferLimit = 15 * 60,
-                          const int minDepartureTime = -never, const int maxDepartureTime = never,
-                          const bool verbose = true) noexcept {
+    void computeShortcuts(const ThreadPinning& threadPinning, const std::vector<StopId>& sources,
+                          const int witnessTransferLimit, const int minDepartureTime, const int maxDepartureTime,
+                          const bool verbose) noexcept {
         if (verbose)
             std::cout << "Computing shortcuts with " << threadPinning.numberOfThreads << " threads." << std::endl;
 
         size_t optimalCandidates = 0;
-        Progress progress(data.numberOfStops(), verbose);
+        Progress progress(sources.size(), verbose);
         omp_set_num_threads(threadPinning.numberOfThreads);
+        std::vector<DynamicTransferGraph> localShortcutGraphs(threadPinning.numberOfThreads, shortcutGraph);
+        std::vector<std::vector<ShortcutEntry>> shortcutsFrom(shortcutGraph.numVertices());
 #pragma omp parallel
         {
             threadPinning.pinThread();
 
-            DynamicTransferGraph localShortcutGraph = shortcutGraph;
+            DynamicTransferGraph& localShortcutGraph = localShortcutGraphs[omp_get_thread_num()];
             ShortcutSearch<Debug, CountOptimalCandidates, IgnoreIsolatedCandidates> shortcutSearch(
                 data, localShortcutGraph, witnessTransferLimit);
 
 #pragma omp for schedule(dynamic)
-            for (size_t i = 0; i < data.numberOfStops(); i++) {
-                shortcutSearch.run(StopId(i), minDepartureTime, maxDepartureTime);
+            for (size_t i = 0; i < sources.size(); i++) {
+                shortcutSearch.run(sources[i], minDepartureTime, maxDepartureTime);
                 progress++;
             }
 
-#pragma omp critical
-            {
-                if constexpr (CountOptimalCandidates) {
-                    optimalCandidates += shortcutSearch.getNumberOfOptimalCandidates();
-                }
-                for (const Vertex from : shortcutGraph.vertices()) {
-                    for (const Edge edge : localShortcutGraph.edgesFrom(from)) {
-                        const Vertex to = localShortcutGraph.get(ToVertex, edge);
-                        if (!shortcutGraph.hasEdge(from, to)) {
-                            shortcutGraph.addEdge(from, to).set(TravelTime, localShortcutGraph.get(TravelTime, edge));
-                        } else {
-                            AssertMsg(shortcutGraph.get(TravelTime, shortcutGraph.findEdge(from, to))
-                                          == localShortcutGraph.get(TravelTime, edge),
-                                      "Edge from " << from << " to " << to << " has inconclusive travel time ("
-                                                   << shortcutGraph.get(TravelTime, shortcutGraph.findEdge(from, to))
-                                                   << ", " << localShortcutGraph.get(TravelTime, edge) << ")");
-                        }
+            if constexpr (CountOptimalCandidates) {
+#pragma omp atomic
+                optimalCandidates += shortcutSearch.getNumberOfOptimalCandidates();
+            }
+
+            // Merge the thread-local graphs per origin stop. Sorting the candidates by (to, travel time) makes the
+            // result independent of the number of threads and of the order in which the stops were processed.
+#pragma omp for schedule(dynamic, 64)
+            for (size_t i = 0; i < shortcutsFrom.size(); i++) {
+                const Vertex from(i);
+                std::vector<ShortcutEntry>& shortcuts = shortcutsFrom[from];
+                for (const DynamicTransferGraph& graph : localShortcutGraphs) {
+                    for (const Edge edge : graph.edgesFrom(from)) {
+                        shortcuts.emplace_back(graph.get(ToVertex, edge), graph.get(TravelTime, edge));
                     }
                 }
+                std::sort(shortcuts.begin(), shortcuts.end());
+                shortcuts.erase(std::unique(shortcuts.begin(), shortcuts.end()), shortcuts.end());
+                for (size_t j = 1; j < shortcuts.size(); j++) {
+                    AssertMsg(shortcuts[j - 1].to != shortcuts[j].to,
+                              "Edge from " << from << " to " << shortcuts[j].to << " has inconclusive travel time ("
+                                           << shortcuts[j - 1].travelTime << ", " << shortcuts[j].travelTime << ")");
+                }
+            }
+        }
+
+        initializeShortcutGraph();
+        for (const Vertex from : shortcutGraph.vertices()) {
+            for (const ShortcutEntry& shortcut : shortcutsFrom[from]) {
+                shortcutGraph.addEdge(from, shortcut.to).set(TravelTime, shortcut.travelTime);
             }
         }
         progress.finished();
@@ -78,11 +215,6 @@ public:
         }
     }
 
-    inline const DynamicTransferGraph& getShortcutGraph() const noexcept { return shortcutGraph; }
-
-    inline DynamicTransferGraph& getShortcutGraph() noexcept { return shortcutGraph; }
-
-private:
     const Data& data;
     DynamicTransferGraph shortcutGraph;
 };
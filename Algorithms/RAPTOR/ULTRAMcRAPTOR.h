@@ -2,12 +2,14 @@
 
 #include "InitialTransfers.h"
 #include "Profiler.h"
+#include "TripSearch.h"
 #include <vector>
 
 #include "../../DataStructures/Container/Map.h"
 #include "../../DataStructures/Container/Set.h"
 #include "../../DataStructures/RAPTOR/Data.h"
 #include "../../DataStructures/RAPTOR/Entities/ArrivalLabel.h"
+#include "../../DataStructures/RAPTOR/Entities/ArenaBags.h"
 #include "../../DataStructures/RAPTOR/Entities/Bags.h"
 
 namespace RAPTOR {
@@ -91,15 +93,16 @@ private:
         }
     };
 
-    using BagType = Bag<Label>;
-    using BestBagType = Bag<BestLabel>;
-    using Round = std::vector<BagType>;
+    using Round = ArenaBags<Label>;
+    using BagType = typename Round::ConstBagReference;
+    using BestBagType = ArenaBags<BestLabel>;
     using RouteBagType = RouteBag<RouteLabel>;
 
 public:
     ULTRAMcRAPTOR(const Data& data, const CH::CH& chData, const Profiler& profilerTemplate = Profiler())
         : data(data),
           initialTransfers(chData, FORWARD, data.numberOfStops()),
+          rounds(data.numberOfStops() + 1),
           bestLabels(data.numberOfStops() + 1),
           stopsUpdatedByRoute(data.numberOfStops()),
           stopsUpdatedByTransfer(data.numberOfStops()),
@@ -180,7 +183,7 @@ public:
         std::vector<WalkingParetoLabel> result;
         for (size_t round = 0; round < rounds.size(); round += 2) {
             const size_t trueRound = std::min(round + 1, rounds.size() - 1);
-            for (const Label& label : rounds[trueRound][target].labels) {
+            for (const Label& label : rounds[trueRound][target]) {
                 result.emplace_back(label, round / 2);
             }
         }
@@ -197,11 +200,11 @@ public:
         targetStop = StopId(data.numberOfStops());
         sourceDepartureTime = never;
         if constexpr (RESET_CAPACITIES) {
-            std::vector<Round>().swap(rounds);
-            std::vector<BestBagType>(bestLabels.size()).swap(bestLabels);
+            rounds.reset();
+            bestLabels = BestBagType(data.numberOfStops() + 1);
         } else {
             rounds.clear();
-            Vector::fill(bestLabels);
+            bestLabels.clear();
         }
     }
 
@@ -258,6 +261,8 @@ private:
 
             const StopEvent* firstTrip = data.firstTripOfRoute(route);
             const StopEvent* lastTrip = data.lastTripOfRoute(route);
+            const int* departureTimes = data.transposedDepartureTimesOfRoute(route);
+            const size_t numberOfTrips = data.numberOfTripsInRoute(route);
 
             RouteBagType routeBag;
 
@@ -265,10 +270,17 @@ private:
                 for (size_t i = 0; i < previousRound()[stop].size(); i++) {
                     const Label& label = previousRound()[stop][i];
                     const StopEvent* trip = firstTrip;
-                    while ((trip < lastTrip) && (trip[stopIndex].departureTime < label.arrivalTime)) {
-                        trip += tripSize;
+                    if (departureTimes) {
+                        const size_t tripIndex = findFirstReachableTrip(departureTimes + (stopIndex * numberOfTrips),
+                                                                        numberOfTrips, label.arrivalTime);
+                        if (tripIndex == numberOfTrips) continue;
+                        trip += tripIndex * tripSize;
+                    } else {
+                        while ((trip < lastTrip) && (trip[stopIndex].departureTime < label.arrivalTime)) {
+                            trip += tripSize;
+                        }
+                        if (trip[stopIndex].departureTime < label.arrivalTime) continue;
                     }
-                    if (trip[stopIndex].departureTime < label.arrivalTime) continue;
 
                     RouteLabel newLabel;
                     newLabel.trip = trip;
@@ -297,8 +309,7 @@ private:
     inline void relaxInitialTransfers() noexcept {
         if (data.isStop(sourceVertex)) {
             stopsUpdatedByTransfer.insert(StopId(sourceVertex));
-            currentRound()[sourceVertex].resize(1);
-            currentRound()[sourceVertex][0] = Label(previousRound()[sourceVertex][0], StopId(sourceVertex), 0);
+            currentRound()[sourceVertex].append(Label(previousRound()[sourceVertex][0], StopId(sourceVertex), 0));
         }
         initialTransfers.template run<true>(sourceVertex, targetVertex);
         for (const Vertex stop : initialTransfers.getForwardPOIs()) {
@@ -331,15 +342,14 @@ private:
         routesServingUpdatedStops.clear();
         for (const StopId stop : stopsUpdatedByRoute) {
             stopsUpdatedByTransfer.insert(stop);
-            const BagType& bag = previousRound()[stop];
-            currentRound()[stop].resize(bag.size());
+            const BagType bag = previousRound()[stop];
             for (size_t i = 0; i < bag.size(); i++) {
-                currentRound()[stop][i] = Label(bag[i], stop, i);
+                currentRound()[stop].append(Label(bag[i], stop, i));
             }
         }
 
         for (const StopId stop : stopsUpdatedByRoute) {
-            const BagType& bag = previousRound()[stop];
+            const BagType bag = previousRound()[stop];
             for (const Edge edge : data.transferGraph.edgesFrom(stop)) {
                 profiler.countMetric(METRIC_EDGES);
                 const StopId toStop = StopId(data.transferGraph.get(ToVertex, edge));
@@ -377,12 +387,12 @@ private:
         return rounds.back();
     }
 
-    inline Round& previousRound() noexcept {
+    inline const Round& previousRound() const noexcept {
         AssertMsg(rounds.size() >= 2, "Cannot return previous round, because less than two rounds exist!");
         return rounds[rounds.size() - 2];
     }
 
-    inline void startNewRound() noexcept { rounds.emplace_back(data.numberOfStops() + 1); }
+    inline void startNewRound() noexcept { rounds.emplace_back(); }
 
     inline void arrival(const StopId stop, const Label& label, IndexedSet<false, StopId>& updatedStops,
                         Metric metric) noexcept {
@@ -423,9 +433,9 @@ private:
 
     BucketCHInitialTransfers initialTransfers;
 
-    std::vector<Round> rounds;
+    ArenaBagRounds<Label> rounds;
 
-    std::vector<BestBagType> bestLabels;
+    BestBagType bestLabels;
 
     IndexedSet<false, StopId> stopsUpdatedByRoute;
     IndexedSet<false, StopId> stopsUpdatedByTransfer;
@@ -2,6 +2,7 @@
 
 #include "InitialTransfers.h"
 #include "Profiler.h"
+#include "TripSearch.h"
 #include <iostream>
 #include <string>
 #include <vector>
@@ -10,21 +11,23 @@
 #include "../../DataStructures/Container/Set.h"
 #include "../../DataStructures/RAPTOR/Data.h"
 #include "../../DataStructures/RAPTOR/Entities/EarliestArrivalTime.h"
+#include "../../DataStructures/RAPTOR/Entities/Rounds.h"
 
 namespace RAPTOR {
 
 template <typename PROFILER = NoProfiler, bool PREVENT_DIRECT_WALKING = false,
-          typename INITIAL_TRANSFERS = BucketCHInitialTransfers>
+          typename INITIAL_TRANSFERS = BucketCHInitialTransfers, bool SPARSE_ROUNDS = false>
 class ULTRARAPTOR {
 public:
     using Profiler = PROFILER;
     static constexpr bool PreventDirectWalking = PREVENT_DIRECT_WALKING;
+    static constexpr bool SparseRounds = SPARSE_ROUNDS;
     using InitialTransferType = INITIAL_TRANSFERS;
     using InitialTransferGraph = typename InitialTransferType::Graph;
     static constexpr bool SeparateRouteAndTransferEntries = PreventDirectWalking;
     static constexpr int RoundFactor = SeparateRouteAndTransferEntries ? 2 : 1;
     using ArrivalTime = EarliestArrivalTime<SeparateRouteAndTransferEntries>;
-    using Type = ULTRARAPTOR<Profiler, PreventDirectWalking, InitialTransferType>;
+    using Type = ULTRARAPTOR<Profiler, PreventDirectWalking, InitialTransferType, SparseRounds>;
     using SourceType = Vertex;
 
 private:
@@ -40,13 +43,14 @@ private:
             Edge transferId;
         };
     };
-    using Round = std::vector<EarliestArrivalLabel>;
+    using RoundLabels = Rounds<EarliestArrivalLabel, SparseRounds>;
 
 public:
     ULTRARAPTOR(const Data& data, const InitialTransferType initialTransfers,
                 const Profiler& profilerTemplate = Profiler())
         : data(data),
           initialTransfers(initialTransfers),
+          rounds(data.numberOfStops() + 1),
           earliestArrival(data.numberOfStops() + 1),
           stopsUpdatedByRoute(data.numberOfStops() + 1),
           stopsUpdatedByTransfer(data.numberOfStops() + 1),
@@ -230,7 +234,7 @@ public:
         targetStop = StopId(data.numberOfStops());
         sourceDepartureTime = never;
         if constexpr (RESET_CAPACITIES) {
-            std::vector<Round>().swap(rounds);
+            rounds.reset();
             std::vector<int>(earliestArrival.size(), never).swap(earliestArrival);
         } else {
             rounds.clear();
@@ -301,11 +305,24 @@ private:
 
             StopIndex parentIndex = stopIndex;
             const StopEvent* firstTrip = data.firstTripOfRoute(route);
+            const int* departureTimes = data.transposedDepartureTimesOfRoute(route);
+            const size_t numberOfTrips = data.numberOfTripsInRoute(route);
+            size_t tripIndex = numberOfTrips - 1;
             while (stopIndex < tripSize - 1) {
-                while ((trip > firstTrip)
-                       && ((trip - tripSize + stopIndex)->departureTime >= previousRound()[stop].arrivalTime)) {
-                    trip -= tripSize;
-                    parentIndex = stopIndex;
+                if (departureTimes) {
+                    const size_t earliestTripIndex = findEarliestReachableTrip(
+                        departureTimes + (stopIndex * numberOfTrips), tripIndex, previousRound()[stop].arrivalTime);
+                    if (earliestTripIndex < tripIndex) {
+                        tripIndex = earliestTripIndex;
+                        trip = firstTrip + (tripIndex * tripSize);
+                        parentIndex = stopIndex;
+                    }
+                } else {
+                    while ((trip > firstTrip)
+                           && ((trip - tripSize + stopIndex)->departureTime >= previousRound()[stop].arrivalTime)) {
+                        trip -= tripSize;
+                        parentIndex = stopIndex;
+                    }
                 }
                 stopIndex++;
                 stop = stops[stopIndex];
@@ -394,17 +411,17 @@ private:
         }
     }
 
-    inline Round& currentRound() noexcept {
+    inline typename RoundLabels::RoundReference currentRound() noexcept {
         AssertMsg(!rounds.empty(), "Cannot return current round, because no round exists!");
         return rounds.back();
     }
 
-    inline Round& previousRound() noexcept {
+    inline typename RoundLabels::ConstRoundReference previousRound() const noexcept {
         AssertMsg(rounds.size() >= 2, "Cannot return previous round, because less than two rounds exist!");
         return rounds[rounds.size() - 2];
     }
 
-    inline void startNewRound() noexcept { rounds.emplace_back(data.numberOfStops() + 1); }
+    inline void startNewRound() noexcept { rounds.emplace_back(); }
 
     inline bool arrivalByRoute(const StopId stop, const int time) noexcept {
         AssertMsg(data.isStop(stop), "Stop " << stop << " is out of range!");
@@ -475,7 +492,7 @@ private:
 
     InitialTransferType initialTransfers;
 
-    std::vector<Round> rounds;
+    RoundLabels rounds;
 
     std::vector<ArrivalTime> earliestArrival;
 
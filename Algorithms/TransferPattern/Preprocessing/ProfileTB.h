@@ -508,7 +508,7 @@ private:
             const StopId arrivalStop = data.getStopOfStopEvent(arrivalStopEvent);
             const int arrivalTime = data.raptorData.stopEvents[arrivalStopEvent].arrivalTime;
             const int transferArrivalTime =
-                (edge == noEdge) ? targetLabel.arrivalTime : arrivalTime + data.stopEventGraph.get(TravelTime, edge);
+                (edge == noEdge) ? targetLabel.arrivalTime : arrivalTime + transferTime(arrivalStop, StopId(departureStop));
             result.emplace_back(arrivalStop, departureStop, arrivalTime, transferArrivalTime, edge);
 
             departureStopEvent = StopEventId(label.begin - 1);
@@ -526,6 +526,15 @@ private:
         return result;
     }
 
+    // The edges of the stop event graph computed by ComputeStopEventGraph carry no travel time, so the time of an
+    // intermediate transfer is taken from the transfer graph.
+    inline int transferTime(const StopId from, const StopId to) const noexcept {
+        if (from == to) return 0;
+        const Edge edge = data.raptorData.transferGraph.findEdge(from, to);
+        AssertMsg(data.raptorData.transferGraph.isEdge(edge), "There is no transfer from " << from << " to " << to << "!");
+        return data.raptorData.transferGraph.get(TravelTime, edge);
+    }
+
     inline std::pair<StopEventId, Edge> getParent(const TripLabel& parentLabel,
                                                   const StopEventId departureStopEvent) const noexcept {
         for (StopEventId i = parentLabel.begin; i < parentLabel.end; i++) {
@@ -2,36 +2,26 @@
 
 #include "ProfileTB.h"
 
+#include <map>
+#include <string>
+#include <unordered_map>
+
 #include "../../../DataStructures/Graph/Utils/Utils.h"
 #include "../../../DataStructures/RAPTOR/Entities/JourneyWithStopEvent.h"
 #include "../../../DataStructures/TransferPattern/Data.h"
 #include "../../../DataStructures/TripBased/Data.h"
 #include "../../../Helpers/Console/Progress.h"
+#include "../../../Helpers/IO/Serialization.h"
+#include "../../../Helpers/Meta.h"
 #include "../../../Helpers/MultiThreading.h"
 #include "../../../Helpers/Vector/Vector.h"
-#include <google/dense_hash_map>
 
 namespace TransferPattern {
-struct VectorHasher {
-    template <typename T>
-    std::size_t operator()(const std::vector<T>& vec) const {
-        std::size_t seed = 0;
-        for (const auto& elem : vec) {
-            seed ^= std::hash<std::size_t>{}(elem.value()) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
-        }
-        return seed;
-    }
-};
-
-struct eqVecStopid {
-    bool operator()(const std::vector<StopId>& a, const std::vector<StopId>& b) const { return a == b; }
-};
 
 class TransferPatternBuilder {
 public:
     TransferPatternBuilder(TripBased::Data& data)
         : data(data), query(data), dynamicDAG(), minDep(0), maxDep(24 * 60 * 60 - 1) {
-        seenPrefix.set_empty_key({noStop});
         clear();
     }
 
@@ -39,34 +29,26 @@ public:
 
     inline DynamicDAGTransferPattern& getDAG() noexcept { return dynamicDAG; }
 
-    inline void addPrefixToDAG(std::vector<StopId>& prefix, const int travelTime = -1) {
-        AssertMsg(prefix.size() > 0, "Prefix is empty?");
-        if (seenPrefix.find(prefix) != seenPrefix.end()) return;
-
-        std::vector<StopId> prefixBefore(prefix);
-        prefixBefore.pop_back();
-
-        // a bit ugly, but this is to allow A->B via route and A->B via foot
-        if (prefixBefore.back() == noStop) prefixBefore.pop_back();
+    // The prefixes of the journeys form a trie, whose vertices are the non-stop vertices of the DAG. The child of a
+    // prefix vertex is identified by the next stop and by whether it is reached via footpath, which allows A->B via
+    // route and A->B via foot.
+    inline Vertex addPrefixToDAG(const Vertex parent, const StopId stop, const int travelTime = -1) {
+        const u_int64_t key = prefixKey(parent, stop, travelTime != -1);
+        const auto child = childOfPrefix.find(key);
+        if (child != childOfPrefix.end()) return child->second;
 
-        Vertex beforeVertex = seenPrefix[prefixBefore];
-        Vertex newVertex = dynamicDAG.addVertex();
-        dynamicDAG.set(ViaVertex, newVertex, Vertex(prefix.back()));
+        const Vertex newVertex = dynamicDAG.addVertex();
+        dynamicDAG.set(ViaVertex, newVertex, Vertex(stop));
+        childOfPrefix.emplace(key, newVertex);
 
-        seenPrefix[prefix] = newVertex;
-
-        dynamicDAG.addEdge(newVertex, beforeVertex).set(TravelTime, travelTime);
+        dynamicDAG.addEdge(newVertex, parent).set(TravelTime, travelTime);
+        return newVertex;
     }
 
     inline void computeTransferPatternForStop(const StopId stop) {
         AssertMsg(data.raptorData.isStop(stop), "Stop is not valid!");
         clear();
 
-        std::vector<StopId> currentPrefix;
-        currentPrefix.reserve(32);
-        currentPrefix.push_back(stop);
-        seenPrefix[currentPrefix] = Vertex(stop);
-
         // This solves one-to-all
         query.run(Vertex(stop), minDep, maxDep);
 
@@ -74,10 +56,7 @@ public:
         StopId target(0);
 
         for (RAPTOR::Journey& j : query.getAllJourneys()) {
-            currentPrefix.clear();
-            currentPrefix.reserve(32);
-
-            currentPrefix.push_back(stop);
+            Vertex currentPrefix(stop);
             target = StopId(j.back().to);
 
             for (size_t i(0); i < j.size(); ++i) {
@@ -94,14 +73,11 @@ public:
                 }
                 if (leg.to == j.back().to) {
                     // add last leg (this is the special stop-vertex)
-                    AssertMsg(seenPrefix.find(currentPrefix) != seenPrefix.end(), "Current Prefix is not in the map?");
-                    if (!dynamicDAG.hasEdge(Vertex(target), seenPrefix[currentPrefix]))
-                        dynamicDAG.addEdge(Vertex(target), seenPrefix[currentPrefix]).set(TravelTime, travelTime);
+                    if (!dynamicDAG.hasEdge(Vertex(target), currentPrefix))
+                        dynamicDAG.addEdge(Vertex(target), currentPrefix).set(TravelTime, travelTime);
                     break;
                 } else {
-                    if (travelTime != -1) currentPrefix.push_back(noStop);
-                    currentPrefix.push_back(StopId(leg.to));
-                    addPrefixToDAG(currentPrefix, travelTime);
+                    currentPrefix = addPrefixToDAG(currentPrefix, StopId(leg.to), travelTime);
                 }
             }
         }
@@ -120,14 +96,9 @@ public:
             dynamicDAG.set(ViaVertex, vertex, vertex);
         }
 
-        seenPrefix.resize(1 << 6);
-        seenPrefix.clear_no_resize();
+        childOfPrefix.clear();
     }
 
-    inline std::vector<int> getMinTravelTimes() noexcept { return query.getMinTravelTimes(); }
-
-    inline std::vector<uint8_t> getMinNumberOfTransfers() noexcept { return query.getMinNumberOfTransfers(); }
-
     inline int getTravelTimeByFootpath(StopId from, StopId to) noexcept {
         AssertMsg(data.isStop(from), "From is not a valid stop!");
         AssertMsg(data.isStop(to), "To is not a valid stop!");
@@ -140,36 +111,100 @@ public:
         return data.raptorData.transferGraph.get(TravelTime, usedEdge);
     }
 
+private:
+    inline static u_int64_t prefixKey(const Vertex parent, const StopId stop, const bool viaFootpath) noexcept {
+        return (u_int64_t(parent.value()) << 32) | (u_int64_t(stop.value()) << 1) | u_int64_t(viaFootpath);
+    }
+
 private:
     TripBased::Data& data;
     TripBased::ProfileTB<TripBased::NoProfiler> query;
 
     DynamicDAGTransferPattern dynamicDAG;
 
-    google::dense_hash_map<std::vector<StopId>, Vertex, VectorHasher, eqVecStopid> seenPrefix;
+    std::unordered_map<u_int64_t, Vertex> childOfPrefix;
     const int minDep;
     const int maxDep;
 };
 
-inline void ComputeTransferPatternUsingTripBased(TripBased::Data& data, TransferPattern::Data& tpData) {
-    Progress progress(data.numberOfStops());
-    TransferPatternBuilder bobTheBuilder(data);
+// Writes the transfer patterns of all stops to a file in the format of std::vector<StaticDAGTransferPattern>, as soon
+// as they are finished. Patterns that are finished out of order are buffered until all patterns of the smaller stops
+// have been written, so only a few patterns have to be kept in memory.
+class TransferPatternWriter {
+public:
+    TransferPatternWriter(const std::string& fileName, const size_t numberOfStops)
+        : serialization(fileName),
+          numberOfStops(numberOfStops),
+          nextStop(0),
+          totalNumberOfVertices(0),
+          totalNumberOfEdges(0),
+          maxNumberOfBufferedPatterns(0) {
+        serialization(Meta::type<StaticDAGTransferPattern>(), numberOfStops);
+    }
 
-    for (const StopId stop : data.stops()) {
-        bobTheBuilder.computeTransferPatternForStop(stop);
-        AssertMsg(Graph::isAcyclic<DynamicDAGTransferPattern>(bobTheBuilder.getDAG()), "Graph is not acyclic!");
+    ~TransferPatternWriter() {
+        AssertMsg(nextStop == numberOfStops, "Only " << nextStop << " of " << numberOfStops << " patterns written!");
+    }
+
+    inline void write(const StopId stop, StaticDAGTransferPattern&& dag) noexcept {
+#pragma omp critical(TransferPatternWriter)
+        {
+            AssertMsg(stop >= nextStop && !bufferedPatterns.count(stop),
+                      "Pattern of stop " << stop << " is written twice!");
+            totalNumberOfVertices += dag.numVertices();
+            totalNumberOfEdges += dag.numEdges();
+            bufferedPatterns.emplace(stop, std::move(dag));
+            maxNumberOfBufferedPatterns = std::max(maxNumberOfBufferedPatterns, bufferedPatterns.size());
+            while (!bufferedPatterns.empty() && bufferedPatterns.begin()->first == nextStop) {
+                serialization(bufferedPatterns.begin()->second);
+                bufferedPatterns.erase(bufferedPatterns.begin());
+                nextStop++;
+            }
+        }
+    }
+
+    inline long long getTotalNumberOfVertices() const noexcept { return totalNumberOfVertices; }
+
+    inline long long getTotalNumberOfEdges() const noexcept { return totalNumberOfEdges; }
 
-        Graph::move(std::move(bobTheBuilder.getDAG()), tpData.transferPatternOfStop[stop]);
-        tpData.transferPatternOfStop[stop].sortEdges(ToVertex);
+    inline size_t getMaxNumberOfBufferedPatterns() const noexcept { return maxNumberOfBufferedPatterns; }
 
-        tpData.assignLowerBounds(stop, bobTheBuilder.getMinTravelTimes(), bobTheBuilder.getMinNumberOfTransfers());
+private:
+    IO::Serialization serialization;
+    const size_t numberOfStops;
+    size_t nextStop;
+    std::map<size_t, StaticDAGTransferPattern> bufferedPatterns;
+
+    long long totalNumberOfVertices;
+    long long totalNumberOfEdges;
+    size_t maxNumberOfBufferedPatterns;
+};
 
+inline void computeTransferPatternOfStop(TransferPatternBuilder& bobTheBuilder, TransferPatternWriter& writer,
+                                         const StopId stop) {
+    bobTheBuilder.computeTransferPatternForStop(stop);
+    AssertMsg(Graph::isAcyclic<DynamicDAGTransferPattern>(bobTheBuilder.getDAG()), "Graph is not acyclic!");
+
+    StaticDAGTransferPattern dag;
+    Graph::move(std::move(bobTheBuilder.getDAG()), dag);
+    dag.sortEdges(ToVertex);
+    writer.write(stop, std::move(dag));
+}
+
+// The transfer patterns are not kept in memory, but streamed to the file fileName.transferPattern, which
+// TransferPattern::Data::deserialize reads.
+inline void ComputeTransferPatternUsingTripBased(TripBased::Data& data, TransferPatternWriter& writer) {
+    Progress progress(data.numberOfStops());
+    TransferPatternBuilder bobTheBuilder(data);
+
+    for (const StopId stop : data.stops()) {
+        computeTransferPatternOfStop(bobTheBuilder, writer, stop);
         ++progress;
     }
     progress.finished();
 }
 
-inline void ComputeTransferPatternUsingTripBased(TripBased::Data& data, TransferPattern::Data& tpData,
+inline void ComputeTransferPatternUsingTripBased(TripBased::Data& data, TransferPatternWriter& writer,
                                                  const int numberOfThreads, const int pinMultiplier = 1) {
     Progress progress(data.numberOfStops());
 
@@ -188,14 +223,7 @@ inline void ComputeTransferPatternUsingTripBased(TripBased::Data& data, Transfer
 
 #pragma omp for schedule(dynamic, 1)
         for (size_t i = 0; i < numberOfStops; ++i) {
-            bobTheBuilder.computeTransferPatternForStop(StopId(i));
-            AssertMsg(Graph::isAcyclic<DynamicDAGTransferPattern>(bobTheBuilder.getDAG()), "Graph is not acyclic!");
-
-            Graph::move(std::move(bobTheBuilder.getDAG()), tpData.transferPatternOfStop[i]);
-            tpData.transferPatternOfStop[i].sortEdges(ToVertex);
-
-            tpData.assignLowerBounds(StopId(i), bobTheBuilder.getMinTravelTimes(),
-                                     bobTheBuilder.getMinNumberOfTransfers());
+            computeTransferPatternOfStop(bobTheBuilder, writer, StopId(i));
             ++progress;
         }
     }
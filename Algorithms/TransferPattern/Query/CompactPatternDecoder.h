@@ -0,0 +1,93 @@
+#pragma once
+
+#include "TimestampedAlreadySeen.h"
+
+#include "../../../DataStructures/Graph/Graph.h"
+#include "../../../DataStructures/TransferPattern/Entities/CompactTransferPatterns.h"
+#include "../../../Helpers/Assert.h"
+#include "../../../Helpers/Types.h"
+
+namespace TransferPattern {
+
+// Decodes the query graph of a source and a target from the compact transfer patterns. Starting at the root of the
+// source, every node whose subtrie contains a journey to the target contributes its legs towards the target. Shared
+// nodes are decoded only once per query.
+class CompactPatternDecoder {
+public:
+    CompactPatternDecoder(const CompactTransferPatterns& patterns)
+        : patterns(patterns),
+          visited(patterns.numberOfNodes()),
+          reachesTarget(patterns.numberOfNodes()),
+          targetStop(noStop),
+          targetSignature(0),
+          numberOfDecodedNodes(0) {}
+
+    // Calls addEdge(from, to, travelTime) for every leg of a journey from source to target. A travel time of -1 marks
+    // a leg that uses a route. The same leg can be reported more than once.
+    template <typename ADD_EDGE>
+    inline void run(const StopId source, const StopId target, const ADD_EDGE& addEdge) noexcept {
+        visited.clear();
+        reachesTarget.clear();
+        targetStop = target;
+        targetSignature = CompactTransferPatterns::signatureOf(target);
+        numberOfDecodedNodes = 0;
+        decode(patterns.rootOfStop(source), addEdge);
+    }
+
+    // Adds the legs of all journeys from source to target to the query graph. Between two stops, at most one route
+    // edge and one footpath edge are added; onNewEdge() is called for every added edge.
+    template <typename ON_NEW_EDGE>
+    inline void extractQueryGraph(const StopId source, const StopId target, DynamicQueryGraph& queryGraph,
+                                  const ON_NEW_EDGE& onNewEdge) noexcept {
+        run(source, target, [&](const StopId from, const StopId to, const int travelTime) {
+            for (const Edge edge : queryGraph.edgesFrom(Vertex(from))) {
+                if (queryGraph.get(ToVertex, edge) != to) continue;
+                if ((queryGraph.get(TravelTime, edge) == -1) == (travelTime == -1)) return;
+            }
+            queryGraph.addEdge(Vertex(from), Vertex(to)).set(TravelTime, travelTime);
+            onNewEdge();
+        });
+    }
+
+    inline size_t getNumberOfDecodedNodes() const noexcept { return numberOfDecodedNodes; }
+
+private:
+    template <typename ADD_EDGE>
+    inline bool decode(const size_t node, const ADD_EDGE& addEdge) noexcept {
+        if (visited.contains(node)) return reachesTarget.contains(node);
+        visited.insert(node);
+        if (!(patterns.signatureOfNode(node) & targetSignature)) return false;
+        numberOfDecodedNodes++;
+
+        const StopId via = patterns.viaStopOfNode(node);
+        bool result = false;
+        for (const CompactTransferPatterns::Entry* target = patterns.beginTargets(node);
+             target != patterns.endTargets(node); target++) {
+            if (CompactTransferPatterns::idOf(*target) != targetStop) continue;
+            addEdge(via, targetStop, CompactTransferPatterns::travelTimeOf(*target));
+            result = true;
+        }
+        for (const CompactTransferPatterns::Entry* child = patterns.beginChildren(node);
+             child != patterns.endChildren(node); child++) {
+            const size_t childNode = CompactTransferPatterns::idOf(*child);
+            if (!decode(childNode, addEdge)) continue;
+            const StopId childVia = patterns.viaStopOfNode(childNode);
+            addEdge(via, childVia, CompactTransferPatterns::travelTimeOf(*child));
+            result = true;
+        }
+        if (result) reachesTarget.insert(node);
+        return result;
+    }
+
+private:
+    const CompactTransferPatterns& patterns;
+
+    TimestampedAlreadySeen visited;
+    TimestampedAlreadySeen reachesTarget;
+
+    StopId targetStop;
+    CompactTransferPatterns::Signature targetSignature;
+    size_t numberOfDecodedNodes;
+};
+
+} // namespace TransferPattern
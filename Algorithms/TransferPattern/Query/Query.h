@@ -1,5 +1,6 @@
 #pragma once
 
+#include "CompactPatternDecoder.h"
 #include "Profiler.h"
 #include "TimestampedAlreadySeen.h"
 #include <unordered_map>
@@ -154,6 +155,7 @@ public:
           left(0),
           right(0),
           alreadySeen(data.maxNumVerticesAndNumEdgesInTP().first),
+          decoder(data.compactTransferPatterns),
           dijkstraBags(data.raptorData.numberOfStops()),
           timestampsForBags(data.raptorData.numberOfStops(), 0),
           currentTimestamp(0) {
@@ -252,6 +254,13 @@ private:
     inline void extractQueryGraph() {
         profiler.startPhase();
 
+        if (!data.compactTransferPatterns.empty()) {
+            decoder.extractQueryGraph(StopId(sourceStop), StopId(targetStop), queryGraph,
+                                      [&]() { profiler.countMetric(METRIC_NUM_EDGES_QUERY_GRAPH); });
+            profiler.donePhase(PHASE_EXTRACT_QUERY_GRAPH);
+            return;
+        }
+
         const StaticDAGTransferPattern& sourceTP = data.transferPatternOfStop[sourceStop];
 
         Vertex currentVertex(targetStop);
@@ -412,53 +421,8 @@ private:
     // * eval direct connection
 
     inline std::pair<RouteId, int> directConnectionIntersection(const Vertex from, const Vertex to,
-                                                                const int departureTime) {
-        AssertMsg(data.raptorData.isStop(StopId(from)), "From " << from << " is not a valid stop");
-        AssertMsg(data.raptorData.isStop(StopId(to)), "To " << to << "is not a valid stop");
-
-        std::vector<RAPTOR::RouteSegment>& fromLookup = data.stopLookup[from].incidentLines;
-        std::vector<RAPTOR::RouteSegment>& toLookup = data.stopLookup[to].incidentLines;
-
-        AssertMsg(std::is_sorted(fromLookup.begin(), fromLookup.end()), "StopLookup from From is not sorted!");
-        AssertMsg(std::is_sorted(toLookup.begin(), toLookup.end()), "StopLookup from From is not sorted!");
-
-        std::pair<RouteId, int> result = std::make_pair(noRouteId, INFTY);
-
-        size_t i(0);
-        size_t j(0);
-
-        size_t firstReachableTripIndex(-1);
-        int currentArrivalTime(-1);
-
-        while (i < fromLookup.size() && j < toLookup.size()) {
-            // if fromLookup[i] and toLookup[j] are on the same line ...
-            // ... *and* fromLookup[i] is before toLookup[j] ...
-            // ... then evaluate and get the intersection
-            if (fromLookup[i].routeId == toLookup[j].routeId && fromLookup[i].stopIndex < toLookup[j].stopIndex) {
-                // get the first reachable trip departing >= departureTime
-                firstReachableTripIndex = data.earliestTripIndexOfLineByStopIndex(fromLookup[i].stopIndex,
-                                                                                  fromLookup[i].routeId, departureTime);
-
-                // is this firstReachableTripIndex valid? I.e., firstReachableTripIndex != (-1)
-                if (firstReachableTripIndex != (size_t)-1) {
-                    currentArrivalTime =
-                        data.getArrivalTime(fromLookup[i].routeId, firstReachableTripIndex, toLookup[j].stopIndex);
-                    if (currentArrivalTime < result.second) {
-                        result = std::make_pair(fromLookup[i].routeId, currentArrivalTime);
-                    }
-                }
-                ++i;
-                ++j;
-            } else {
-                if (fromLookup[i] < toLookup[j]) {
-                    ++i;
-                } else {
-                    ++j;
-                }
-            }
-        }
-
-        return result;
+                                                                const int departureTime) const {
+        return data.earliestDirectConnection(StopId(from), StopId(to), departureTime);
     }
 
 public:
@@ -475,6 +439,7 @@ private:
     std::vector<Vertex> queue;
     size_t left, right;
     TimestampedAlreadySeen alreadySeen;
+    CompactPatternDecoder decoder;
 
     std::vector<DijkstraBagType> dijkstraBags;
     std::vector<uint16_t> timestampsForBags;
@@ -1,6 +1,8 @@
 #pragma once
 
+#include "CompactPatternDecoder.h"
 #include "Profiler.h"
+#include "QueryGraphLowerBounds.h"
 #include "TimestampedAlreadySeen.h"
 #include <unordered_map>
 #include <vector>
@@ -44,9 +46,9 @@ public:
               bestNumTrips(0) {}
 
         DijkstraLabel(const DijkstraLabel& other)
-            : arrivalTime(other.arrivalTime + other.bestTravelTime),
+            : arrivalTime(other.arrivalTime),
               parentDepartureTime(other.parentDepartureTime),
-              numberOfTrips(other.numberOfTrips + other.bestNumTrips),
+              numberOfTrips(other.numberOfTrips),
               routeId(other.routeId),
               parentStop(other.parentStop),
               parentIndex(other.parentIndex),
@@ -146,7 +148,11 @@ public:
 
         inline int getKey() const { return arrivalTime + bestTravelTime; }
 
-        inline bool hasSmallerKey(DijkstraLabel* other) const { return getKey() < other->getKey(); }
+        // Ties are broken by the trips, so a label at the target is never dominated by a label that is settled later.
+        inline bool hasSmallerKey(const DijkstraLabel* const other) const {
+            if (getKey() != other->getKey()) return getKey() < other->getKey();
+            return numberOfTrips + bestNumTrips < other->numberOfTrips + other->bestNumTrips;
+        }
 
         template <typename OTHER_LABEL>
         inline bool dominates(OTHER_LABEL& other) const {
@@ -176,11 +182,15 @@ public:
           sourceStop(noVertex),
           targetStop(noVertex),
           sourceDepartureTime(0),
+          queryGraphSourceStop(noVertex),
+          queryGraphTargetStop(noVertex),
           queryGraph(),
           queue(data.maxNumVerticesAndNumEdgesInTP().first),
           left(0),
           right(0),
           alreadySeen(data.maxNumVerticesAndNumEdgesInTP().first),
+          decoder(data.compactTransferPatterns),
+          lowerBounds(data),
           dijkstraBags(data.raptorData.numberOfStops()),
           timestampsForBags(data.raptorData.numberOfStops(), 0),
           currentTimestamp(0) {
@@ -204,7 +214,10 @@ public:
     inline void run(StopId source, int departureTime, StopId target) {
         profiler.start();
 
-        clear();
+        // The query graph and its lower bounds only depend on source and target, so they are reused if a query asks
+        // for the same stops again, e.g., at another departure time.
+        const bool reuseQueryGraph = (source == queryGraphSourceStop) && (target == queryGraphTargetStop);
+        clear(reuseQueryGraph);
         sourceStop = source;
         targetStop = target;
         sourceDepartureTime = departureTime;
@@ -212,7 +225,12 @@ public:
         prepBag(sourceStop);
         prepBag(targetStop);
 
-        extractQueryGraph();
+        if (!reuseQueryGraph) {
+            extractQueryGraph();
+            computeLowerBounds();
+            queryGraphSourceStop = source;
+            queryGraphTargetStop = target;
+        }
         initializeSourceLabels();
         evaluateQueryGraph();
         profiler.done();
@@ -245,21 +263,23 @@ public:
 
 private:
     // @todo check performance
-    inline void clear() noexcept {
+    inline void clear(const bool keepQueryGraph) noexcept {
         profiler.startPhase();
 
-        /* profiler.startPhase(); */
-        queryGraph.clear();
-        queryGraph.addVertices(data.raptorData.numberOfStops());
+        if (!keepQueryGraph) {
+            /* profiler.startPhase(); */
+            queryGraph.clear();
+            queryGraph.addVertices(data.raptorData.numberOfStops());
 
-        // should prop be evaluated which reserve size is fastest
-        queryGraph.reserve(data.raptorData.numberOfStops(), data.raptorData.numberOfStops() << 1);
-        /* profiler.donePhase(PHASE_CLEAR_QUERY_GRAPH); */
+            // should prop be evaluated which reserve size is fastest
+            queryGraph.reserve(data.raptorData.numberOfStops(), data.raptorData.numberOfStops() << 1);
+            /* profiler.donePhase(PHASE_CLEAR_QUERY_GRAPH); */
 
-        left = 0;
-        right = 0;
+            left = 0;
+            right = 0;
 
-        alreadySeen.clear();
+            alreadySeen.clear();
+        }
 
         /* profiler.startPhase(); */
         Q.clear();
@@ -279,6 +299,13 @@ private:
     inline void extractQueryGraph() {
         profiler.startPhase();
 
+        if (!data.compactTransferPatterns.empty()) {
+            decoder.extractQueryGraph(StopId(sourceStop), StopId(targetStop), queryGraph,
+                                      [&]() { profiler.countMetric(METRIC_NUM_EDGES_QUERY_GRAPH); });
+            profiler.donePhase(PHASE_EXTRACT_QUERY_GRAPH);
+            return;
+        }
+
         const StaticDAGTransferPattern& sourceTP = data.transferPatternOfStop[sourceStop];
 
         Vertex currentVertex(targetStop);
@@ -316,6 +343,13 @@ private:
         profiler.donePhase(PHASE_EXTRACT_QUERY_GRAPH);
     }
 
+    // The lower bounds are part of building the query graph.
+    inline void computeLowerBounds() {
+        profiler.startPhase();
+        lowerBounds.run(queryGraph, StopId(targetStop));
+        profiler.donePhase(PHASE_EXTRACT_QUERY_GRAPH);
+    }
+
     inline void addVertexToQueryGraph(Vertex vertex) {
         insertIntoQueue(vertex);
         alreadySeen.insert(vertex);
@@ -403,8 +437,7 @@ private:
                 }
 
                 vLabel.set(newArrivalTime, uLabel.arrivalTime, newNumberOfTrips, usedRoute, StopId(u), parentIndex,
-                           data.getLowerBoundTravelTime(StopId(targetStop), StopId(v)),
-                           data.getLowerBoundNumberOfTrips(StopId(targetStop), StopId(v)));
+                           lowerBounds.getTravelTime(StopId(v)), lowerBounds.getNumberOfTrips(StopId(v)));
 
                 arrivalByEdge(v, vLabel);
             }
@@ -423,8 +456,10 @@ private:
 
         profiler.countMetric(METRIC_RELAXED_TRANSFER_EDGES);
         // Target Pruning - adapted
-        // copy label and add the lower bound for trips
+        // copy label and add the lower bounds for the remaining travel time and trips
         DijkstraLabel skewedCopy(label);
+        skewedCopy.arrivalTime += label.bestTravelTime;
+        skewedCopy.numberOfTrips += label.bestNumTrips;
 
         if (dijkstraBags[targetStop].dominates(skewedCopy)) return false;
 
@@ -443,53 +478,8 @@ private:
     // * eval direct connection
 
     inline std::pair<RouteId, int> directConnectionIntersection(const Vertex from, const Vertex to,
-                                                                const int departureTime) {
-        AssertMsg(data.raptorData.isStop(StopId(from)), "From " << from << " is not a valid stop");
-        AssertMsg(data.raptorData.isStop(StopId(to)), "To " << to << "is not a valid stop");
-
-        std::vector<RAPTOR::RouteSegment>& fromLookup = data.stopLookup[from].incidentLines;
-        std::vector<RAPTOR::RouteSegment>& toLookup = data.stopLookup[to].incidentLines;
-
-        AssertMsg(std::is_sorted(fromLookup.begin(), fromLookup.end()), "StopLookup from From is not sorted!");
-        AssertMsg(std::is_sorted(toLookup.begin(), toLookup.end()), "StopLookup from From is not sorted!");
-
-        std::pair<RouteId, int> result = std::make_pair(noRouteId, INFTY);
-
-        size_t i(0);
-        size_t j(0);
-
-        size_t firstReachableTripIndex(-1);
-        int currentArrivalTime(-1);
-
-        while (i < fromLookup.size() && j < toLookup.size()) {
-            // if fromLookup[i] and toLookup[j] are on the same line ...
-            // ... *and* fromLookup[i] is before toLookup[j] ...
-            // ... then evaluate and get the intersection
-            if (fromLookup[i].routeId == toLookup[j].routeId && fromLookup[i].stopIndex < toLookup[j].stopIndex) {
-                // get the first reachable trip departing >= departureTime
-                firstReachableTripIndex = data.earliestTripIndexOfLineByStopIndex(fromLookup[i].stopIndex,
-                                                                                  fromLookup[i].routeId, departureTime);
-
-                // is this firstReachableTripIndex valid? I.e., firstReachableTripIndex != (-1)
-                if (firstReachableTripIndex != (size_t)-1) {
-                    currentArrivalTime =
-                        data.getArrivalTime(fromLookup[i].routeId, firstReachableTripIndex, toLookup[j].stopIndex);
-                    if (currentArrivalTime < result.second) {
-                        result = std::make_pair(fromLookup[i].routeId, currentArrivalTime);
-                    }
-                }
-                ++i;
-                ++j;
-            } else {
-                if (fromLookup[i] < toLookup[j]) {
-                    ++i;
-                } else {
-                    ++j;
-                }
-            }
-        }
-
-        return result;
+                                                                const int departureTime) const {
+        return data.earliestDirectConnection(StopId(from), StopId(to), departureTime);
     }
 
 public:
@@ -502,10 +492,16 @@ private:
     Vertex targetStop;
     int sourceDepartureTime;
 
+    // The stops for which queryGraph and lowerBounds were built.
+    Vertex queryGraphSourceStop;
+    Vertex queryGraphTargetStop;
+
     DynamicQueryGraph queryGraph;
     std::vector<Vertex> queue;
     size_t left, right;
     TimestampedAlreadySeen alreadySeen;
+    CompactPatternDecoder decoder;
+    QueryGraphLowerBounds lowerBounds;
 
     std::vector<DijkstraBagType> dijkstraBags;
     std::vector<uint16_t> timestampsForBags;
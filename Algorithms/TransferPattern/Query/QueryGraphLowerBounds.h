@@ -0,0 +1,94 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "../../../DataStructures/Container/ExternalKHeap.h"
+#include "../../../DataStructures/Graph/Graph.h"
+#include "../../../DataStructures/TransferPattern/Data.h"
+#include "../../../Helpers/Types.h"
+
+namespace TransferPattern {
+
+// A* potentials for the query graph of one query. Every journey that the query can find uses the edges of the query
+// graph, so backward searches from the target on the query graph yield lower bounds on the remaining travel time and
+// number of trips. Route edges are weighted with the minimum ride time between their stops. The query graph is small,
+// so this replaces a precomputed table of lower bounds between all pairs of stops.
+class QueryGraphLowerBounds {
+private:
+    struct Label : public ExternalKHeapElement {
+        Label() : distance(0), timestamp(0) {}
+
+        inline bool hasSmallerKey(const Label* const other) const noexcept { return distance < other->distance; }
+
+        int distance;
+        uint16_t timestamp;
+    };
+
+public:
+    QueryGraphLowerBounds(const Data& data)
+        : data(data),
+          travelTimeLabels(data.raptorData.numberOfStops()),
+          numberOfTripsLabels(data.raptorData.numberOfStops()),
+          currentTimestamp(0) {}
+
+    inline void run(const DynamicQueryGraph& queryGraph, const StopId target) noexcept {
+        ++currentTimestamp;
+        if (currentTimestamp == 0) [[unlikely]] {
+            Vector::fill(travelTimeLabels);
+            Vector::fill(numberOfTripsLabels);
+            currentTimestamp = 1;
+        }
+        runDijkstra(queryGraph, target, travelTimeLabels,
+                    [&](const Vertex from, const Vertex to, const int travelTime) {
+            return (travelTime == -1) ? data.getMinRideTime(StopId(from), StopId(to)) : travelTime;
+        });
+        runDijkstra(queryGraph, target, numberOfTripsLabels,
+                    [&](const Vertex, const Vertex, const int travelTime) { return (travelTime == -1) ? 1 : 0; });
+    }
+
+    // Stops that cannot reach the target in the query graph get a lower bound of 0.
+    inline int getTravelTime(const StopId stop) const noexcept { return distance(travelTimeLabels[stop]); }
+
+    inline uint8_t getNumberOfTrips(const StopId stop) const noexcept {
+        return std::min(distance(numberOfTripsLabels[stop]), 255);
+    }
+
+private:
+    inline int distance(const Label& label) const noexcept {
+        return (label.timestamp == currentTimestamp) ? label.distance : 0;
+    }
+
+    template <typename WEIGHT>
+    inline void runDijkstra(const DynamicQueryGraph& queryGraph, const StopId target, std::vector<Label>& labels,
+                            const WEIGHT& weight) noexcept {
+        labels[target].distance = 0;
+        labels[target].timestamp = currentTimestamp;
+        Q.update(&labels[target]);
+        while (!Q.empty()) {
+            const Label* label = Q.extractFront();
+            const Vertex v = Vertex(label - &(labels[0]));
+            for (const Edge edge : queryGraph.edgesTo(v)) {
+                const Vertex u = queryGraph.get(FromVertex, edge);
+                const int edgeWeight = weight(u, v, queryGraph.get(TravelTime, edge));
+                if (edgeWeight >= INFTY) continue;
+                const int newDistance = label->distance + edgeWeight;
+                if (labels[u].timestamp == currentTimestamp && labels[u].distance <= newDistance) continue;
+                labels[u].distance = newDistance;
+                labels[u].timestamp = currentTimestamp;
+                Q.update(&labels[u]);
+            }
+        }
+    }
+
+private:
+    const Data& data;
+
+    std::vector<Label> travelTimeLabels;
+    std::vector<Label> numberOfTripsLabels;
+    uint16_t currentTimestamp;
+    ExternalKHeap<2, Label> Q;
+};
+
+} // namespace TransferPattern
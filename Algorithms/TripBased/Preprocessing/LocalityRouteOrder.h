@@ -0,0 +1,69 @@
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+#include "../../../DataStructures/Geometry/Point.h"
+#include "../../../DataStructures/Geometry/Rectangle.h"
+#include "../../../DataStructures/TripBased/Data.h"
+#include "../../../Helpers/Vector/Permutation.h"
+
+namespace TripBased {
+
+// Computes an order of the routes (new id -> old id) that improves the memory locality of the queries: Routes are
+// grouped by the partition cell that contains most of their stops, and within a cell they are sorted along a
+// Z-order curve over the centers of their stops. Trips that are likely to be scanned together in a query are thus
+// stored close to each other.
+inline Order computeLocalityRouteOrder(const Data& data) noexcept {
+    struct RouteKey {
+        int cell;
+        u_int64_t zOrder;
+        RouteId route;
+        inline bool operator<(const RouteKey& other) const noexcept {
+            if (cell != other.cell) return cell < other.cell;
+            if (zOrder != other.zOrder) return zOrder < other.zOrder;
+            return route < other.route;
+        }
+    };
+
+    const Geometry::Rectangle boundingBox = data.raptorData.boundingBox();
+    const double dx = std::max(boundingBox.dx(), 1e-9);
+    const double dy = std::max(boundingBox.dy(), 1e-9);
+    const auto zOrderOf = [&](const Geometry::Point& point) {
+        const u_int32_t x = std::min<double>(65535, 65535 * (point.x - boundingBox.min.x) / dx);
+        const u_int32_t y = std::min<double>(65535, 65535 * (point.y - boundingBox.min.y) / dy);
+        u_int64_t result = 0;
+        for (u_int64_t bit = 0; bit < 16; bit++) {
+            result |= ((x >> bit) & 1) << (2 * bit);
+            result |= ((y >> bit) & 1) << (2 * bit + 1);
+        }
+        return result;
+    };
+
+    std::vector<RouteKey> keys;
+    keys.reserve(data.numberOfRoutes());
+    std::vector<size_t> stopsInCell(std::max(1, data.getNumberOfPartitionCells()), 0);
+    for (const RouteId route : data.routes()) {
+        std::fill(stopsInCell.begin(), stopsInCell.end(), 0);
+        Geometry::Point center;
+        for (const StopId stop : data.raptorData.stopsOfRoute(route)) {
+            const int cell = data.getPartitionCell(stop);
+            if (static_cast<size_t>(cell) < stopsInCell.size()) stopsInCell[cell]++;
+            center.x += data.raptorData.stopData[stop].coordinates.x;
+            center.y += data.raptorData.stopData[stop].coordinates.y;
+        }
+        center /= data.numberOfStopsInRoute(route);
+        const int cell = std::max_element(stopsInCell.begin(), stopsInCell.end()) - stopsInCell.begin();
+        keys.emplace_back(RouteKey{cell, zOrderOf(center), route});
+    }
+    std::sort(keys.begin(), keys.end());
+
+    Order order;
+    order.reserve(keys.size());
+    for (const RouteKey& key : keys) {
+        order.emplace_back(key.route);
+    }
+    return order;
+}
+
+} // namespace TripBased
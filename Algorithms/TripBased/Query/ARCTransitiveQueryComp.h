@@ -24,9 +24,11 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 **********************************************************************************/
 #pragma once
 
+#include "FinalTransfers.h"
 #include "Profiler.h"
 #include "TimestampedReachedIndex.h"
 
+#include "../../../DataStructures/Container/GrowableArray.h"
 #include "../../../DataStructures/Container/Set.h"
 #include "../../../DataStructures/Graph/Utils/Conversion.h"
 #include "../../../DataStructures/RAPTOR/Entities/ArrivalLabel.h"
@@ -35,11 +37,12 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 namespace TripBased {
 
-template <typename PROFILER = NoProfiler>
+template <typename PROFILER = NoProfiler, typename REACHED_INDEX = TimestampedReachedIndex<>>
 class ARCTransitiveQueryComp {
 public:
     using Profiler = PROFILER;
-    using Type = ARCTransitiveQueryComp<Profiler>;
+    using ReachedIndexType = REACHED_INDEX;
+    using Type = ARCTransitiveQueryComp<Profiler, ReachedIndexType>;
 
 private:
     struct TripLabel {
@@ -82,7 +85,7 @@ private:
     };
 
 public:
-    ARCTransitiveQueryComp(Data& data, const std::string name = "")
+    ARCTransitiveQueryComp(Data& data, const std::string name = "", const size_t initialQueueCapacity = 1024)
         : data(data),
           reverseTransferGraph(data.raptorData.transferGraph),
           transferFromSource(data.numberOfStops(), INFTY),
@@ -90,8 +93,8 @@ public:
           lastSource(StopId(0)),
           lastTarget(StopId(0)),
           reachedRoutes(data.numberOfRoutes()),
-          queue(data.numberOfStopEvents()),
-          edgeRanges(data.numberOfStopEvents()),
+          queue(initialQueueCapacity),
+          edgeRanges(initialQueueCapacity),
           queueSize(0),
           reachedIndex(data),
           targetLabels(1),
@@ -133,6 +136,8 @@ public:
          * METRIC_SCANNED_STOPS, METRIC_RELAXED_TRANSFERS, */
         /*     METRIC_ENQUEUES, METRIC_ADD_JOURNEYS }); */
         profiler.registerMetrics({METRIC_SCANNED_TRIPS});
+        profiler.registerMaximumMetrics({METRIC_QUEUE_HIGH_WATER_MARK, METRIC_SCRATCH_MEMORY});
+        targetLabels.reserve(16);
     }
 
     inline void run(const Vertex source, const int departureTime, const Vertex target) noexcept {
@@ -153,6 +158,8 @@ public:
         computeInitialAndFinalTransfers();
         evaluateInitialTransfers();
         scanTrips();
+        profiler.recordMaximum(METRIC_QUEUE_HIGH_WATER_MARK, queueSize);
+        profiler.recordMaximum(METRIC_SCRATCH_MEMORY, getScratchMemoryUsage());
         profiler.done();
     }
 
@@ -189,6 +196,11 @@ public:
 
     inline Profiler& getProfiler() noexcept { return profiler; }
 
+    // Memory used by the per-query buffers, which grow on demand and are reused by subsequent queries.
+    inline long long getScratchMemoryUsage() const noexcept {
+        return queue.byteSize() + edgeRanges.byteSize() + targetLabels.capacity() * sizeof(TargetLabel);
+    }
+
 private:
     inline void clear() noexcept {
         queueSize = 0;
@@ -285,16 +297,11 @@ private:
             for (size_t i = roundBegin; i < roundEnd; ++i) {
                 const TripLabel& label = queue[i];
                 profiler.countMetric(METRIC_SCANNED_TRIPS);
-                for (StopEventId j = label.begin; j < label.end; j++) {
-                    // profiler.countMetric(METRIC_SCANNED_STOPS);
-                    if (data.arrivalEvents[j].arrivalTime >= minArrivalTime) break;
-                    const int timeToTarget = transferToTarget[data.arrivalEvents[j].stop];
-                    if (timeToTarget != INFTY) [[unlikely]] {
-                        addTargetLabel(data.arrivalEvents[j].arrivalTime + timeToTarget, i);
-                    }
-                }
+                evaluateFinalTransfers(data.arrivalEvents, label.begin, label.end, transferToTarget, minArrivalTime,
+                                       [&](const int arrivalTime) { addTargetLabel(arrivalTime, i); });
             }
             // Find the range of transfers for each trip
+            edgeRanges.reserve(roundEnd);
             for (size_t i = roundBegin; i < roundEnd; ++i) {
                 TripLabel& label = queue[i];
                 for (StopEventId j = label.begin; j < label.end; j++) {
@@ -321,9 +328,9 @@ private:
         // profiler.countMetric(METRIC_ENQUEUES);
         if (reachedIndex.alreadyReached(trip, index)) return;
         const StopEventId firstEvent = data.firstStopEventOfTrip[trip];
+        queue.reserve(queueSize + 1);
         queue[queueSize] = TripLabel(StopEventId(firstEvent + index), StopEventId(firstEvent + reachedIndex(trip)));
         ++queueSize;
-        AssertMsg(queueSize <= queue.size(), "Queue is overfull!");
         reachedIndex.update(trip, index);
     }
 
@@ -333,9 +340,9 @@ private:
         if (!compressedFlags[compressedIndizes[edge]][targetFlag]
             || reachedIndex.alreadyReached(label.trip, label.stopEvent - label.firstEvent)) [[likely]]
             return;
+        queue.reserve(queueSize + 1);
         queue[queueSize] = TripLabel(label.stopEvent, StopEventId(label.firstEvent + reachedIndex(label.trip)), parent);
         ++queueSize;
-        AssertMsg(queueSize <= queue.size(), "Queue is overfull!");
         reachedIndex.update(label.trip, StopIndex(label.stopEvent - label.firstEvent));
     }
 
@@ -425,10 +432,10 @@ private:
 
     IndexedSet<false, RouteId> reachedRoutes;
 
-    std::vector<TripLabel> queue;
-    std::vector<EdgeRange> edgeRanges;
+    GrowableArray<TripLabel> queue;
+    GrowableArray<EdgeRange> edgeRanges;
     size_t queueSize;
-    TimestampedReachedIndex reachedIndex;
+    ReachedIndexType reachedIndex;
 
     std::vector<TargetLabel> targetLabels;
     int minArrivalTime;
@@ -0,0 +1,296 @@
+#pragma once
+
+#include <algorithm>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+#include "ARCProfileQuery.h"
+#include "ARCTransitiveQuery.h"
+#include "Profiler.h"
+
+#include "../../../DataStructures/RAPTOR/Entities/ArrivalLabel.h"
+#include "../../../DataStructures/RAPTOR/Entities/Journey.h"
+#include "../../../DataStructures/TripBased/Data.h"
+#include "../../../Helpers/String/String.h"
+
+namespace TripBased {
+
+typedef enum { CACHE_EVICT_LRU, CACHE_EVICT_FIFO, NUM_CACHE_EVICTION_POLICIES } CacheEvictionPolicy;
+
+constexpr const char* CacheEvictionPolicyNames[] = {"LRU", "FIFO"};
+
+inline CacheEvictionPolicy cacheEvictionPolicyFromString(const std::string& name) noexcept {
+    for (int i = 0; i < NUM_CACHE_EVICTION_POLICIES; i++) {
+        if (name == CacheEvictionPolicyNames[i]) return CacheEvictionPolicy(i);
+    }
+    warning("Unknown cache eviction policy ", name, ", using ", CacheEvictionPolicyNames[CACHE_EVICT_LRU], "!");
+    return CACHE_EVICT_LRU;
+}
+
+// Result cache in front of the Arc-Flag TB queries. The departure times are divided into buckets of fixed size. For
+// every (source, target, bucket) triple, the cache stores a profile fragment, i.e., all Pareto-optimal journeys (with
+// respect to departure time, arrival time and number of trips) that depart within the bucket, together with the
+// journeys that are optimal for a departure at the end of the bucket. A query whose departure time falls into a cached
+// bucket is answered by a lookup in this fragment, without running any search. On a miss, the fragment is computed
+// with one ARCProfileQuery over the bucket and one ARCTransitiveQuery at the end of the bucket. Queries between stops
+// that are connected by a direct transfer are passed through to the ARCTransitiveQuery.
+template <typename PROFILER = NoProfiler>
+class CachedARCQuery {
+public:
+    using Profiler = PROFILER;
+    using Type = CachedARCQuery<Profiler>;
+
+private:
+    struct Key {
+        Key(const StopId source = noStop, const StopId target = noStop, const int bucket = -1)
+            : source(source), target(target), bucket(bucket) {}
+
+        inline bool operator==(const Key& other) const noexcept {
+            return source == other.source && target == other.target && bucket == other.bucket;
+        }
+
+        StopId source;
+        StopId target;
+        int bucket;
+    };
+
+    struct KeyHash {
+        inline size_t operator()(const Key& key) const noexcept {
+            size_t seed = std::hash<u_int32_t>{}(key.source.value());
+            seed ^= std::hash<u_int32_t>{}(key.target.value()) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+            seed ^= std::hash<int>{}(key.bucket) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+            return seed;
+        }
+    };
+
+    struct CachedJourney {
+        CachedJourney(const int departureTime = never, const int arrivalTime = INFTY, const size_t numberOfTrips = 0,
+                      const RAPTOR::Journey& journey = RAPTOR::Journey())
+            : departureTime(departureTime), arrivalTime(arrivalTime), numberOfTrips(numberOfTrips), journey(journey) {}
+
+        inline bool dominates(const CachedJourney& other) const noexcept {
+            return departureTime >= other.departureTime && arrivalTime <= other.arrivalTime
+                   && numberOfTrips <= other.numberOfTrips;
+        }
+
+        int departureTime;
+        int arrivalTime;
+        size_t numberOfTrips;
+        RAPTOR::Journey journey;
+    };
+
+    struct Fragment {
+        Key key;
+        std::vector<CachedJourney> journeys;
+        size_t byteSize;
+    };
+
+    using FragmentList = std::list<Fragment>;
+
+public:
+    CachedARCQuery(Data& data, const int bucketSize = 60 * 60, const size_t memoryLimit = 1024 * 1024 * 1024,
+                   const CacheEvictionPolicy evictionPolicy = CACHE_EVICT_LRU)
+        : data(data),
+          transitiveQuery(data),
+          profileQuery(data),
+          bucketSize(bucketSize),
+          memoryLimit(memoryLimit),
+          evictionPolicy(evictionPolicy),
+          memoryUsage(0),
+          sourceStop(noStop),
+          targetStop(noStop),
+          sourceDepartureTime(never) {
+        AssertMsg(bucketSize > 0, "Bucket size has to be positive!");
+        profiler.registerMetrics({METRIC_CACHE_HITS, METRIC_CACHE_MISSES, METRIC_CACHE_EVICTIONS});
+    }
+
+    inline void run(const Vertex source, const int departureTime, const Vertex target) noexcept {
+        AssertMsg(data.isStop(source), "Source " << source << " is not a stop!");
+        AssertMsg(data.isStop(target), "Target " << target << " is not a stop!");
+        run(StopId(source), departureTime, StopId(target));
+    }
+
+    inline void run(const StopId source, const int departureTime, const StopId target) noexcept {
+        AssertMsg(departureTime >= 0, "Departure time " << departureTime << " is negative!");
+        profiler.start();
+        sourceStop = source;
+        targetStop = target;
+        sourceDepartureTime = departureTime;
+
+        // ARCProfileQuery prunes with the direct transfer from the source at the beginning of the departure time
+        // range, so its profile is incomplete if such a transfer exists. These queries are not cached.
+        if (directTransferTime() != INFTY) {
+            profiler.countMetric(METRIC_CACHE_MISSES);
+            transitiveQuery.run(source, departureTime, target);
+            result.clear();
+            for (const RAPTOR::Journey& journey : transitiveQuery.getJourneys()) {
+                result.emplace_back(journey.front().departureTime, journey.back().arrivalTime,
+                                    RAPTOR::countTrips(journey), journey);
+            }
+            profiler.done();
+            return;
+        }
+
+        const Key key(source, target, departureTime / bucketSize);
+        auto it = fragmentOfKey.find(key);
+        if (it != fragmentOfKey.end()) {
+            profiler.countMetric(METRIC_CACHE_HITS);
+            if (evictionPolicy == CACHE_EVICT_LRU) fragments.splice(fragments.begin(), fragments, it->second);
+        } else {
+            profiler.countMetric(METRIC_CACHE_MISSES);
+            computeFragment(key);
+            it = fragmentOfKey.find(key);
+        }
+        evaluateFragment(*it->second);
+        evict();
+        profiler.done();
+    }
+
+    inline int getEarliestArrivalTime() const noexcept {
+        return result.empty() ? INFTY : result.back().arrivalTime;
+    }
+
+    inline std::vector<RAPTOR::Journey> getJourneys() const noexcept {
+        std::vector<RAPTOR::Journey> journeys;
+        for (const CachedJourney& journey : result) {
+            journeys.emplace_back(journey.journey);
+        }
+        return journeys;
+    }
+
+    inline std::vector<RAPTOR::ArrivalLabel> getArrivals() const noexcept {
+        std::vector<RAPTOR::ArrivalLabel> arrivals;
+        for (const CachedJourney& journey : result) {
+            arrivals.emplace_back(journey.arrivalTime, journey.numberOfTrips);
+        }
+        return arrivals;
+    }
+
+    inline void clearCache() noexcept {
+        fragments.clear();
+        fragmentOfKey.clear();
+        memoryUsage = 0;
+    }
+
+    inline size_t numberOfCachedFragments() const noexcept { return fragments.size(); }
+
+    inline size_t getMemoryUsage() const noexcept { return memoryUsage; }
+
+    inline Profiler& getProfiler() noexcept { return profiler; }
+
+    inline void printInfo() const noexcept {
+        std::cout << "Query cache:" << std::endl;
+        std::cout << "   Bucket size:              " << std::setw(12) << String::secToString(bucketSize) << std::endl;
+        std::cout << "   Eviction policy:          " << std::setw(12) << CacheEvictionPolicyNames[evictionPolicy]
+                  << std::endl;
+        std::cout << "   Cached fragments:         " << std::setw(12) << String::prettyInt(fragments.size())
+                  << std::endl;
+        std::cout << "   Memory usage:             " << std::setw(12) << String::bytesToString(memoryUsage)
+                  << std::endl;
+        std::cout << "   Memory limit:             " << std::setw(12) << String::bytesToString(memoryLimit)
+                  << std::endl;
+    }
+
+private:
+    inline void computeFragment(const Key& key) noexcept {
+        const int bucketBegin = key.bucket * bucketSize;
+        const int bucketEnd = bucketBegin + bucketSize;
+
+        std::vector<CachedJourney> candidates;
+        profileQuery.run(key.source, key.target, bucketBegin, bucketEnd);
+        for (const RAPTOR::Journey& journey : profileQuery.getAllJourneys()) {
+            const size_t numberOfTrips = RAPTOR::countTrips(journey);
+            candidates.emplace_back(journey.front().departureTime, journey.back().arrivalTime, numberOfTrips,
+                                    journey);
+        }
+        // Every journey departing after the bucket is dominated by one of the journeys for a departure at its end.
+        transitiveQuery.run(key.source, bucketEnd, key.target);
+        for (const RAPTOR::Journey& journey : transitiveQuery.getJourneys()) {
+            const size_t numberOfTrips = RAPTOR::countTrips(journey);
+            candidates.emplace_back(bucketEnd, journey.back().arrivalTime, numberOfTrips, journey);
+        }
+
+        Fragment fragment;
+        fragment.key = key;
+        fragment.byteSize = sizeof(Fragment) + sizeof(Key) + 4 * sizeof(void*);
+        for (size_t i = 0; i < candidates.size(); i++) {
+            bool dominated = false;
+            for (size_t j = 0; j < candidates.size(); j++) {
+                if (i == j || !candidates[j].dominates(candidates[i])) continue;
+                if (candidates[i].dominates(candidates[j]) && i < j) continue;
+                dominated = true;
+                break;
+            }
+            if (dominated) continue;
+            fragment.byteSize += sizeof(CachedJourney) + candidates[i].journey.size() * sizeof(RAPTOR::JourneyLeg);
+            fragment.journeys.emplace_back(candidates[i]);
+        }
+        memoryUsage += fragment.byteSize;
+        fragments.emplace_front(std::move(fragment));
+        fragmentOfKey[key] = fragments.begin();
+    }
+
+    inline void evaluateFragment(const Fragment& fragment) noexcept {
+        result.clear();
+        std::vector<const CachedJourney*> candidates;
+        for (const CachedJourney& journey : fragment.journeys) {
+            if (journey.departureTime < sourceDepartureTime) continue;
+            candidates.emplace_back(&journey);
+        }
+        std::sort(candidates.begin(), candidates.end(), [](const CachedJourney* a, const CachedJourney* b) {
+            return std::tie(a->numberOfTrips, a->arrivalTime) < std::tie(b->numberOfTrips, b->arrivalTime);
+        });
+
+        int bestArrivalTime = INFTY;
+        for (const CachedJourney* journey : candidates) {
+            if (journey->arrivalTime >= bestArrivalTime) continue;
+            bestArrivalTime = journey->arrivalTime;
+            result.emplace_back(*journey);
+        }
+    }
+
+    inline int directTransferTime() const noexcept {
+        if (sourceStop == targetStop) return 0;
+        for (const Edge edge : data.raptorData.transferGraph.edgesFrom(sourceStop)) {
+            if (data.raptorData.transferGraph.get(ToVertex, edge) != targetStop) continue;
+            return data.raptorData.transferGraph.get(TravelTime, edge);
+        }
+        return INFTY;
+    }
+
+    inline void evict() noexcept {
+        // The most recently used (or inserted) fragment is kept even if it exceeds the memory limit on its own.
+        while (memoryUsage > memoryLimit && fragments.size() > 1) {
+            profiler.countMetric(METRIC_CACHE_EVICTIONS);
+            const Fragment& fragment = fragments.back();
+            memoryUsage -= fragment.byteSize;
+            fragmentOfKey.erase(fragment.key);
+            fragments.pop_back();
+        }
+    }
+
+private:
+    Data& data;
+
+    ARCTransitiveQuery<NoProfiler> transitiveQuery;
+    ARCProfileQuery<NoProfiler> profileQuery;
+
+    const int bucketSize;
+    const size_t memoryLimit;
+    const CacheEvictionPolicy evictionPolicy;
+
+    FragmentList fragments;
+    std::unordered_map<Key, typename FragmentList::iterator, KeyHash> fragmentOfKey;
+    size_t memoryUsage;
+
+    StopId sourceStop;
+    StopId targetStop;
+    int sourceDepartureTime;
+
+    std::vector<CachedJourney> result;
+
+    Profiler profiler;
+};
+
+} // namespace TripBased
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <vector>
+
+#ifdef USE_SIMD
+#include <immintrin.h>
+#endif
+
+#include "../../../DataStructures/TripBased/Data.h"
+#include "../../../Helpers/Types.h"
+
+namespace TripBased {
+
+static_assert(sizeof(ArrivalEvent) == 2 * sizeof(int), "ArrivalEvent is expected to consist of two 32-bit values!");
+
+namespace Impl {
+
+template <bool STRICT_CUT_OFF>
+inline bool isCutOff(const int arrivalTime, const int cutOff) noexcept {
+    return STRICT_CUT_OFF ? (arrivalTime > cutOff) : (arrivalTime >= cutOff);
+}
+
+template <bool STRICT_CUT_OFF, typename ADD_TARGET_LABEL>
+inline bool evaluateFinalTransfersScalar(const ArrivalEvent* arrivalEvents, size_t begin, const size_t end,
+                                         const int* transferToTarget, const int& cutOff,
+                                         const ADD_TARGET_LABEL& addTargetLabel) noexcept {
+    for (size_t j = begin; j < end; j++) {
+        if (isCutOff<STRICT_CUT_OFF>(arrivalEvents[j].arrivalTime, cutOff)) return false;
+        const int timeToTarget = transferToTarget[arrivalEvents[j].stop];
+        if (timeToTarget != INFTY) [[unlikely]] {
+            addTargetLabel(arrivalEvents[j].arrivalTime + timeToTarget);
+        }
+    }
+    return true;
+}
+
+} // namespace Impl
+
+// Evaluates the final transfers from the stop events [begin, end) of a trip segment to the target. The scan stops at
+// the first stop event arriving at or after the cut-off (or strictly after it, if STRICT_CUT_OFF is set), which is
+// usually the current best arrival time at the target and may be decreased by addTargetLabel(arrivalTime).
+// With AVX2, blocks of 8 stop events are checked at once: If none of them is cut off and none has a transfer to the
+// target (the common case), the whole block is skipped without branching on the individual events. Otherwise, the
+// block is evaluated by the scalar code, which keeps the order of the addTargetLabel calls unchanged.
+template <bool STRICT_CUT_OFF = false, typename ADD_TARGET_LABEL>
+inline void evaluateFinalTransfers(const std::vector<ArrivalEvent>& arrivalEvents, const StopEventId begin,
+                                   const StopEventId end, const std::vector<int>& transferToTarget, const int& cutOff,
+                                   const ADD_TARGET_LABEL& addTargetLabel) noexcept {
+    const ArrivalEvent* events = arrivalEvents.data();
+    const int* transferTimes = transferToTarget.data();
+    size_t j = begin;
+#if defined(USE_SIMD) && defined(__AVX2__)
+    const __m256i infinity = _mm256_set1_epi32(INFTY);
+    for (; j + 8 <= end; j += 8) {
+        const __m256 low = _mm256_castsi256_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(events + j)));
+        const __m256 high = _mm256_castsi256_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(events + j + 4)));
+        const __m256i arrivalTimes = _mm256_castps_si256(_mm256_shuffle_ps(low, high, _MM_SHUFFLE(2, 0, 2, 0)));
+        const __m256i stops = _mm256_castps_si256(_mm256_shuffle_ps(low, high, _MM_SHUFFLE(3, 1, 3, 1)));
+        // The lanes are not in the order of the stop events, which does not matter since only the whole block is tested.
+        const __m256i timesToTarget = _mm256_i32gather_epi32(transferTimes, stops, sizeof(int));
+        const __m256i limit = _mm256_set1_epi32(STRICT_CUT_OFF ? cutOff : cutOff - 1);
+        const __m256i cutOffLanes = _mm256_cmpgt_epi32(arrivalTimes, limit);
+        const __m256i targetLanes = _mm256_andnot_si256(_mm256_cmpeq_epi32(timesToTarget, infinity),
+                                                        _mm256_set1_epi32(-1));
+        if (_mm256_testz_si256(_mm256_or_si256(cutOffLanes, targetLanes), _mm256_set1_epi32(-1))) [[likely]]
+            continue;
+        if (!Impl::evaluateFinalTransfersScalar<STRICT_CUT_OFF>(events, j, j + 8, transferTimes, cutOff,
+                                                                 addTargetLabel))
+            return;
+    }
+#endif
+    Impl::evaluateFinalTransfersScalar<STRICT_CUT_OFF>(events, j, end, transferTimes, cutOff, addTargetLabel);
+}
+
+} // namespace TripBased
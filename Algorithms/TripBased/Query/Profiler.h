@@ -1,5 +1,6 @@
 #pragma once
 
+#include <algorithm>
 #include <iostream>
 
 #include "../../../Helpers/String/String.h"
@@ -41,16 +42,24 @@ typedef enum {
     METRIC_ADD_JOURNEYS,
     METRIC_COUNT_DISTANCE,
     NUMBER_OF_RUNS,
+    METRIC_CACHE_HITS,
+    METRIC_CACHE_MISSES,
+    METRIC_CACHE_EVICTIONS,
+    METRIC_QUEUE_HIGH_WATER_MARK,
+    METRIC_SCRATCH_MEMORY,
     NUM_METRICS
 } Metric;
 
 constexpr const char* MetricNames[] = {"Rounds",         "Scanned trips",  "Scanned stops",       "Relaxed transfers",
-                                       "Enqueued trips", "Added journeys", "Distance / MaxSpeed", "Number of Runs"};
+                                       "Enqueued trips", "Added journeys", "Distance / MaxSpeed", "Number of Runs",
+                                       "Cache hits",     "Cache misses",   "Cache evictions",     "Queue high-water mark",
+                                       "Scratch memory (bytes)"};
 
 class NoProfiler {
 public:
     inline void registerPhases(const std::initializer_list<Phase>&) const noexcept {}
     inline void registerMetrics(const std::initializer_list<Metric>&) const noexcept {}
+    inline void registerMaximumMetrics(const std::initializer_list<Metric>&) const noexcept {}
 
     inline void start() const noexcept {}
     inline void done() const noexcept {}
@@ -59,13 +68,19 @@ public:
     inline void donePhase(const Phase) const noexcept {}
 
     inline void countMetric(const Metric) const noexcept {}
+    inline void recordMaximum(const Metric, const long long) const noexcept {}
 
     inline void printStatistics() const noexcept {}
 };
 
 class AggregateProfiler : public NoProfiler {
 public:
-    AggregateProfiler() : totalTime(0.0), phaseTime(NUM_PHASES, 0.0), metricValue(NUM_METRICS, 0), numQueries(0) {}
+    AggregateProfiler()
+        : totalTime(0.0),
+          phaseTime(NUM_PHASES, 0.0),
+          metricValue(NUM_METRICS, 0),
+          maximumValue(NUM_METRICS, 0),
+          numQueries(0) {}
 
     inline void registerPhases(const std::initializer_list<Phase>& phaseList) noexcept {
         for (const Phase phase : phaseList) {
@@ -79,6 +94,13 @@ public:
         }
     }
 
+    // Metrics that are reported as the maximum over all queries instead of the average, e.g., high-water marks.
+    inline void registerMaximumMetrics(const std::initializer_list<Metric>& metricList) noexcept {
+        for (const Metric metric : metricList) {
+            maximumMetrics.push_back(metric);
+        }
+    }
+
     inline void start() noexcept { totalTimer.restart(); }
 
     inline void done() noexcept {
@@ -92,6 +114,12 @@ public:
 
     inline void countMetric(const Metric metric) noexcept { metricValue[metric]++; }
 
+    inline void recordMaximum(const Metric metric, const long long value) noexcept {
+        maximumValue[metric] = std::max(maximumValue[metric], value);
+    }
+
+    inline long long getMaximum(const Metric metric) const noexcept { return maximumValue[metric]; }
+
     inline double getTotalTime() const noexcept { return totalTime / numQueries; }
 
     inline double getPhaseTime(const Phase phase) const noexcept { return phaseTime[phase] / numQueries; }
@@ -105,6 +133,9 @@ public:
             std::cout << MetricNames[metric] << ": "
                       << String::prettyDouble(metricValue[metric] / static_cast<double>(numQueries), 2) << std::endl;
         }
+        for (const Metric metric : maximumMetrics) {
+            std::cout << MetricNames[metric] << ": " << String::prettyInt(maximumValue[metric]) << std::endl;
+        }
         for (const Phase phase : phases) {
             std::cout << PhaseNames[phase] << ": "
                       << String::musToString(phaseTime[phase] / static_cast<double>(numQueries)) << std::endl;
@@ -120,6 +151,8 @@ private:
     Timer phaseTimer;
     std::vector<double> phaseTime;
     std::vector<long long> metricValue;
+    std::vector<Metric> maximumMetrics;
+    std::vector<long long> maximumValue;
     size_t numQueries;
 };
 
@@ -6,15 +6,16 @@
 #include "../../../DataStructures/RAPTOR/Entities/ArrivalLabel.h"
 #include "../../../DataStructures/RAPTOR/Entities/Journey.h"
 #include "../../../DataStructures/TripBased/Data.h"
-#include "../../CH/Query/BucketQuery.h"
+#include "../../RAPTOR/InitialTransfers.h"
 
 namespace TripBased {
 
-template <typename PROFILER = NoProfiler>
+template <typename PROFILER = NoProfiler, typename INITIAL_TRANSFERS = RAPTOR::BucketCHInitialTransfers>
 class Query {
 public:
     using Profiler = PROFILER;
-    using Type = Query<Profiler>;
+    using InitialTransferType = INITIAL_TRANSFERS;
+    using Type = Query<Profiler, InitialTransferType>;
 
 private:
     struct TripLabel {
@@ -58,9 +59,9 @@ private:
     };
 
 public:
-    Query(const Data& data, const RAPTOR::BucketCHInitialTransfers& initialTransfers)
+    Query(const Data& data, const InitialTransferType& initialTransfers)
         : data(data),
-          bucketQuery(initialTransfers),
+          initialTransfers(initialTransfers),
           queue(data.numberOfStopEvents()),
           edgeRanges(data.numberOfStopEvents()),
           queueSize(0),
@@ -96,7 +97,7 @@ public:
     }
 
     Query(const Data& data, const CH::CH& chData)
-        : Query(data, RAPTOR::BucketCHInitialTransfers(chData.forward, chData.backward, data.numberOfStops(), Weight)) {
+        : Query(data, InitialTransferType(chData.forward, chData.backward, data.numberOfStops(), Weight)) {
     }
 
     inline void run(const Vertex source, const int departureTime, const Vertex target) noexcept {
@@ -155,9 +156,9 @@ private:
 
     inline void computeInitialAndFinalTransfers() noexcept {
         profiler.startPhase();
-        bucketQuery.run(sourceVertex, targetVertex);
-        if (bucketQuery.getDistance() != INFTY) {
-            addTargetLabel(sourceDepartureTime + bucketQuery.getDistance());
+        initialTransfers.run(sourceVertex, targetVertex);
+        if (initialTransfers.getDistance() != INFTY) {
+            addTargetLabel(sourceDepartureTime + initialTransfers.getDistance());
         }
         profiler.donePhase(PHASE_SCAN_INITIAL);
     }
@@ -165,7 +166,7 @@ private:
     inline void evaluateInitialTransfers() noexcept {
         profiler.startPhase();
         std::vector<bool> reachedRoutes(data.raptorData.numberOfRoutes(), false);
-        for (const Vertex stop : bucketQuery.getForwardPOIs()) {
+        for (const Vertex stop : initialTransfers.getForwardPOIs()) {
             for (const RAPTOR::RouteSegment& route : data.raptorData.routesContainingStop(StopId(stop))) {
                 reachedRoutes[route.routeId] = true;
             }
@@ -178,7 +179,7 @@ private:
             const StopId* stops = data.raptorData.stopArrayOfRoute(route);
             TripId tripIndex = noTripId;
             for (StopIndex stopIndex(0); stopIndex < endIndex; stopIndex++) {
-                const int timeFromSource = bucketQuery.getForwardDistance(stops[stopIndex]);
+                const int timeFromSource = initialTransfers.getForwardDistance(stops[stopIndex]);
                 if (timeFromSource == INFTY) continue;
                 const int stopDepartureTime = sourceDepartureTime + timeFromSource;
                 const u_int32_t labelIndex = stopIndex * label.numberOfTrips;
@@ -217,7 +218,7 @@ private:
                 for (StopEventId j = label.begin; j < label.end; j++) {
                     profiler.countMetric(METRIC_SCANNED_STOPS);
                     if (data.arrivalEvents[j].arrivalTime >= minArrivalTime) break;
-                    const int timeToTarget = bucketQuery.getBackwardDistance(data.arrivalEvents[j].stop);
+                    const int timeToTarget = initialTransfers.getBackwardDistance(data.arrivalEvents[j].stop);
                     if (timeToTarget != INFTY) addTargetLabel(data.arrivalEvents[j].arrivalTime + timeToTarget, i);
                 }
             }
@@ -304,7 +305,7 @@ private:
 
             parent = label.parent;
         }
-        const int timeFromSource = bucketQuery.getForwardDistance(departureStop);
+        const int timeFromSource = initialTransfers.getForwardDistance(departureStop);
         result.emplace_back(sourceVertex, departureStop, sourceDepartureTime, sourceDepartureTime + timeFromSource,
                             noEdge);
         Vector::reverse(result);
@@ -329,7 +330,7 @@ private:
         const TripId trip = data.tripOfStopEvent[parentLabel.begin];
         const StopEventId end = data.firstStopEventOfTrip[trip + 1];
         for (StopEventId i = parentLabel.begin; i < end; i++) {
-            const int timeToTarget = bucketQuery.getBackwardDistance(data.arrivalEvents[i].stop);
+            const int timeToTarget = initialTransfers.getBackwardDistance(data.arrivalEvents[i].stop);
             if (timeToTarget == INFTY) continue;
             if (data.arrivalEvents[i].arrivalTime + timeToTarget == targetLabel.arrivalTime)
                 return std::make_pair(i, noEdge);
@@ -341,7 +342,7 @@ private:
 private:
     const Data& data;
 
-    RAPTOR::BucketCHInitialTransfers bucketQuery;
+    InitialTransferType initialTransfers;
     std::vector<TripLabel> queue;
     std::vector<EdgeRange> edgeRanges;
     size_t queueSize;
@@ -1,44 +1,61 @@
 #pragma once
 
 #include <algorithm>
+#include <limits>
+#include <type_traits>
 
 #include "../../../DataStructures/TripBased/Data.h"
 
 namespace TripBased {
 
+// The label, the timestamp and the default label of a trip are stored interleaved, such that checking a trip touches
+// only one cache line. With 32-bit timestamps, the timestamps practically never wrap around, which avoids the full
+// reset of all labels (every 65,536 queries with 16-bit timestamps).
+template <typename TIMESTAMP_TYPE = u_int32_t>
 class TimestampedReachedIndex {
+    static_assert(std::is_unsigned<TIMESTAMP_TYPE>::value, "Timestamps must be unsigned!");
+
+public:
+    using TimestampType = TIMESTAMP_TYPE;
+    using Type = TimestampedReachedIndex<TimestampType>;
+
+private:
+    struct Entry {
+        TimestampType timestamp;
+        u_int8_t label;
+        u_int8_t defaultLabel;
+    };
+
 public:
-    TimestampedReachedIndex(const Data& data)
-        : data(data),
-          labels(data.numberOfTrips(), -1),
-          timestamps(data.numberOfTrips(), 0),
-          timestamp(0),
-          defaultLabels(data.numberOfTrips(), -1) {
+    TimestampedReachedIndex(const Data& data) : data(data), entries(data.numberOfTrips(), {0, 255, 255}), timestamp(0) {
         for (const TripId trip : data.trips()) {
             if (data.numberOfStopsInTrip(trip) > 255)
                 warning("Trip ", trip, " has ", data.numberOfStopsInTrip(trip), " stops!");
-            defaultLabels[trip] = data.numberOfStopsInTrip(trip);
+            entries[trip].label = data.numberOfStopsInTrip(trip);
+            entries[trip].defaultLabel = data.numberOfStopsInTrip(trip);
         }
     }
 
 public:
     inline void clear() noexcept {
-        ++timestamp;
-        if (timestamp == 0) {
-            labels = defaultLabels;
-            std::fill(timestamps.begin(), timestamps.end(), 0);
+        if (timestamp == std::numeric_limits<TimestampType>::max()) [[unlikely]] {
+            for (Entry& entry : entries) {
+                entry.timestamp = 0;
+            }
+            timestamp = 0;
         }
+        ++timestamp;
     }
 
     inline StopIndex operator()(const TripId trip) noexcept {
-        AssertMsg(trip < labels.size(), "Trip " << trip << " is out of bounds!");
+        AssertMsg(trip < entries.size(), "Trip " << trip << " is out of bounds!");
         return StopIndex(getLabel(trip));
     }
 
     inline bool alreadyReached(const TripId trip, const u_int8_t index) noexcept { return getLabel(trip) <= index; }
 
     inline void update(const TripId trip, const StopIndex index) noexcept {
-        AssertMsg(trip < labels.size(), "Trip " << trip << " is out of bounds!");
+        AssertMsg(trip < entries.size(), "Trip " << trip << " is out of bounds!");
         const TripId routeEnd = data.firstTripOfRoute[data.routeOfTrip[trip] + 1];
         for (TripId i = trip; i < routeEnd; i++) {
             u_int8_t& label = getLabel(i);
@@ -49,20 +66,18 @@ public:
 
 private:
     inline u_int8_t& getLabel(const TripId trip) noexcept {
-        if (timestamps[trip] != timestamp) {
-            labels[trip] = defaultLabels[trip];
-            timestamps[trip] = timestamp;
+        Entry& entry = entries[trip];
+        if (entry.timestamp != timestamp) {
+            entry.label = entry.defaultLabel;
+            entry.timestamp = timestamp;
         }
-        return labels[trip];
+        return entry.label;
     }
 
     const Data& data;
 
-    std::vector<u_int8_t> labels;
-    std::vector<u_int16_t> timestamps;
-    u_int16_t timestamp;
-
-    std::vector<u_int8_t> defaultLabels;
+    std::vector<Entry> entries;
+    TimestampType timestamp;
 };
 
 } // namespace TripBased
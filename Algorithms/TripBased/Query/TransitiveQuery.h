@@ -1,8 +1,10 @@
 #pragma once
 
+#include "FinalTransfers.h"
 #include "Profiler.h"
 #include "ReachedIndex.h"
 
+#include "../../../DataStructures/Container/GrowableArray.h"
 #include "../../../DataStructures/Container/Set.h"
 #include "../../../DataStructures/RAPTOR/Entities/ArrivalLabel.h"
 #include "../../../DataStructures/RAPTOR/Entities/Journey.h"
@@ -10,11 +12,12 @@
 
 namespace TripBased {
 
-template <typename PROFILER = NoProfiler>
+template <typename PROFILER = NoProfiler, typename REACHED_INDEX = ReachedIndex>
 class TransitiveQuery {
 public:
     using Profiler = PROFILER;
-    using Type = TransitiveQuery<Profiler>;
+    using ReachedIndexType = REACHED_INDEX;
+    using Type = TransitiveQuery<Profiler, ReachedIndexType>;
 
 private:
     struct TripLabel {
@@ -58,7 +61,7 @@ private:
     };
 
 public:
-    TransitiveQuery(const Data& data)
+    TransitiveQuery(const Data& data, const size_t initialQueueCapacity = 1024)
         : data(data),
           reverseTransferGraph(data.raptorData.transferGraph),
           transferFromSource(data.numberOfStops(), INFTY),
@@ -66,8 +69,8 @@ public:
           lastSource(StopId(0)),
           lastTarget(StopId(0)),
           reachedRoutes(data.numberOfRoutes()),
-          queue(data.numberOfStopEvents()),
-          edgeRanges(data.numberOfStopEvents()),
+          queue(initialQueueCapacity),
+          edgeRanges(initialQueueCapacity),
           queueSize(0),
           reachedIndex(data),
           targetLabels(1),
@@ -103,6 +106,8 @@ public:
         /*     METRIC_ENQUEUES, METRIC_ADD_JOURNEYS, METRIC_COUNT_DISTANCE }); */
 
         profiler.registerMetrics({METRIC_SCANNED_TRIPS});
+        profiler.registerMaximumMetrics({METRIC_QUEUE_HIGH_WATER_MARK, METRIC_SCRATCH_MEMORY});
+        targetLabels.reserve(16);
     }
 
     inline void run(const Vertex source, const int departureTime, const Vertex target) noexcept {
@@ -120,6 +125,8 @@ public:
         computeInitialAndFinalTransfers();
         evaluateInitialTransfers();
         scanTrips();
+        profiler.recordMaximum(METRIC_QUEUE_HIGH_WATER_MARK, queueSize);
+        profiler.recordMaximum(METRIC_SCRATCH_MEMORY, getScratchMemoryUsage());
         profiler.done();
     }
 
@@ -156,6 +163,11 @@ public:
 
     inline Profiler& getProfiler() noexcept { return profiler; }
 
+    // Memory used by the per-query buffers, which grow on demand and are reused by subsequent queries.
+    inline long long getScratchMemoryUsage() const noexcept {
+        return queue.byteSize() + edgeRanges.byteSize() + targetLabels.capacity() * sizeof(TargetLabel);
+    }
+
 private:
     inline void clear() noexcept {
         queueSize = 0;
@@ -269,14 +281,11 @@ private:
 
                 const TripLabel& label = queue[i];
                 profiler.countMetric(METRIC_SCANNED_TRIPS);
-                for (StopEventId j = label.begin; j < label.end; j++) {
-                    // profiler.countMetric(METRIC_SCANNED_STOPS);
-                    if (data.arrivalEvents[j].arrivalTime >= minArrivalTime) break;
-                    const int timeToTarget = transferToTarget[data.arrivalEvents[j].stop];
-                    if (timeToTarget != INFTY) addTargetLabel(data.arrivalEvents[j].arrivalTime + timeToTarget, i);
-                }
+                evaluateFinalTransfers(data.arrivalEvents, label.begin, label.end, transferToTarget, minArrivalTime,
+                                       [&](const int arrivalTime) { addTargetLabel(arrivalTime, i); });
             }
             // Find the range of transfers for each trip
+            edgeRanges.reserve(roundEnd);
             for (size_t i = roundBegin; i < roundEnd; i++) {
 #ifdef ENABLE_PREFETCH
                 if (i + 4 < roundEnd) {
@@ -310,9 +319,9 @@ private:
         // profiler.countMetric(METRIC_ENQUEUES);
         if (reachedIndex.alreadyReached(trip, index)) return;
         const StopEventId firstEvent = data.firstStopEventOfTrip[trip];
+        queue.reserve(queueSize + 1);
         queue[queueSize] = TripLabel(StopEventId(firstEvent + index), StopEventId(firstEvent + reachedIndex(trip)));
         queueSize++;
-        AssertMsg(queueSize <= queue.size(), "Queue is overfull!");
         reachedIndex.update(trip, index);
     }
 
@@ -332,9 +341,9 @@ private:
             return;
         }
         */
+        queue.reserve(queueSize + 1);
         queue[queueSize] = TripLabel(label.stopEvent, StopEventId(label.firstEvent + reachedIndex(label.trip)), parent);
         queueSize++;
-        AssertMsg(queueSize <= queue.size(), "Queue is overfull!");
         reachedIndex.update(label.trip, StopIndex(label.stopEvent - label.firstEvent));
     }
 
@@ -423,10 +432,10 @@ private:
 
     IndexedSet<false, RouteId> reachedRoutes;
 
-    std::vector<TripLabel> queue;
-    std::vector<EdgeRange> edgeRanges;
+    GrowableArray<TripLabel> queue;
+    GrowableArray<EdgeRange> edgeRanges;
     size_t queueSize;
-    ReachedIndex reachedIndex;
+    ReachedIndexType reachedIndex;
 
     std::vector<TargetLabel> targetLabels;
     int minArrivalTime;
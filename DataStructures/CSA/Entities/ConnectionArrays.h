@@ -0,0 +1,109 @@
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+#include "../../../Helpers/Assert.h"
+#include "../../../Helpers/Meta.h"
+#include "../../../Helpers/Types.h"
+#include "../../../Helpers/Vector/Vector.h"
+#include "Connection.h"
+
+namespace CSA {
+
+// Struct-of-arrays copy of a connection array that is sorted by departure time. The fields that are read for every
+// scanned connection (departure stop and trip) are packed into one array, departure times are kept in a separate
+// array, and the arrival fields, which are only needed for reachable connections, are split out. Connection ids are
+// the same as in the original array.
+// If COMPRESSED_TIMES is set, departure times are stored as 16-bit offsets. The time axis is then divided into blocks
+// of 2^16 seconds, which is the largest block that fits a 16-bit offset, and each block stores its base time and its
+// range of connections. Without compression, all connections form a single block with base time 0.
+template <bool COMPRESSED_TIMES = false>
+class ConnectionArrays {
+public:
+    static constexpr bool CompressedTimes = COMPRESSED_TIMES;
+    using Type = ConnectionArrays<CompressedTimes>;
+    using DepartureTimeOffset = Meta::IF<CompressedTimes, u_int16_t, int>;
+    static constexpr int BlockLength = 1 << 16;
+
+    struct HotConnection {
+        HotConnection(const StopId departureStopId = noStop, const TripId tripId = noTripId)
+            : departureStopId(departureStopId), tripId(tripId) {}
+        StopId departureStopId;
+        TripId tripId;
+    };
+
+public:
+    ConnectionArrays(const std::vector<Connection>& connections) {
+        AssertMsg(Vector::isSorted(connections), "Connections must be sorted in ascending order!");
+        hotConnections.reserve(connections.size());
+        departureTimeOffsets.reserve(connections.size());
+        arrivalStopIds.reserve(connections.size());
+        arrivalTimes.reserve(connections.size());
+        firstConnectionOfBlock.emplace_back(0);
+        baseTimeOfBlock.emplace_back(0);
+        if constexpr (CompressedTimes) {
+            if (!connections.empty()) baseTimeOfBlock[0] = connections.front().departureTime;
+        }
+        for (size_t i = 0; i < connections.size(); i++) {
+            const Connection& connection = connections[i];
+            if constexpr (CompressedTimes) {
+                while (connection.departureTime - baseTimeOfBlock.back() >= BlockLength) {
+                    firstConnectionOfBlock.emplace_back(i);
+                    baseTimeOfBlock.emplace_back(baseTimeOfBlock.back() + BlockLength);
+                }
+            }
+            hotConnections.emplace_back(connection.departureStopId, connection.tripId);
+            departureTimeOffsets.emplace_back(connection.departureTime - baseTimeOfBlock.back());
+            arrivalStopIds.emplace_back(connection.arrivalStopId);
+            arrivalTimes.emplace_back(connection.arrivalTime);
+        }
+        firstConnectionOfBlock.emplace_back(connections.size());
+    }
+
+    inline size_t size() const noexcept { return hotConnections.size(); }
+
+    inline size_t numberOfBlocks() const noexcept { return baseTimeOfBlock.size(); }
+
+    inline size_t blockOf(const size_t connection) const noexcept {
+        return std::upper_bound(firstConnectionOfBlock.begin(), firstConnectionOfBlock.end() - 1, connection)
+               - firstConnectionOfBlock.begin() - 1;
+    }
+
+    inline size_t beginOfBlock(const size_t block) const noexcept { return firstConnectionOfBlock[block]; }
+
+    inline size_t endOfBlock(const size_t block) const noexcept { return firstConnectionOfBlock[block + 1]; }
+
+    inline int baseTime(const size_t block) const noexcept { return baseTimeOfBlock[block]; }
+
+    inline const HotConnection& hot(const size_t connection) const noexcept { return hotConnections[connection]; }
+
+    inline DepartureTimeOffset departureTimeOffset(const size_t connection) const noexcept {
+        return departureTimeOffsets[connection];
+    }
+
+    inline int departureTime(const size_t connection) const noexcept {
+        return baseTimeOfBlock[blockOf(connection)] + departureTimeOffsets[connection];
+    }
+
+    inline StopId arrivalStopId(const size_t connection) const noexcept { return arrivalStopIds[connection]; }
+
+    inline int arrivalTime(const size_t connection) const noexcept { return arrivalTimes[connection]; }
+
+    inline long long byteSize() const noexcept {
+        return Vector::byteSize(hotConnections) + Vector::byteSize(departureTimeOffsets)
+               + Vector::byteSize(arrivalStopIds) + Vector::byteSize(arrivalTimes)
+               + Vector::byteSize(firstConnectionOfBlock) + Vector::byteSize(baseTimeOfBlock);
+    }
+
+private:
+    std::vector<HotConnection> hotConnections;
+    std::vector<DepartureTimeOffset> departureTimeOffsets;
+    std::vector<StopId> arrivalStopIds;
+    std::vector<int> arrivalTimes;
+
+    std::vector<size_t> firstConnectionOfBlock;
+    std::vector<int> baseTimeOfBlock;
+};
+
+} // namespace CSA
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+#include "../../../Helpers/Assert.h"
+#include "../../../Helpers/Types.h"
+#include "../../../Helpers/Vector/Vector.h"
+#include "Connection.h"
+
+namespace CSA {
+
+// Index into a connection array sorted by departure time. The time axis is split into buckets of fixed width, and for
+// each bucket the id of the first connection departing in or after it is stored. The first connection departing at or
+// after a given time is then found by a binary search within a single bucket instead of the whole array.
+class DepartureTimeIndex {
+public:
+    DepartureTimeIndex(const std::vector<Connection>& connections, const int bucketWidth = 60)
+        : connections(connections), minDepartureTime(0), bucketWidth(bucketWidth) {
+        AssertMsg(bucketWidth > 0, "Bucket width must be positive!");
+        AssertMsg(Vector::isSorted(connections), "Connections must be sorted in ascending order!");
+        if (connections.empty()) {
+            firstConnectionOfBucket.assign(1, ConnectionId(0));
+            return;
+        }
+        minDepartureTime = connections.front().departureTime;
+        const size_t numberOfBuckets = bucketOf(connections.back().departureTime) + 1;
+        firstConnectionOfBucket.assign(numberOfBuckets + 1, ConnectionId(connections.size()));
+        for (size_t i = connections.size(); i > 0; i--) {
+            firstConnectionOfBucket[bucketOf(connections[i - 1].departureTime)] = ConnectionId(i - 1);
+        }
+        for (size_t bucket = numberOfBuckets; bucket > 0; bucket--) {
+            firstConnectionOfBucket[bucket - 1] =
+                std::min(firstConnectionOfBucket[bucket - 1], firstConnectionOfBucket[bucket]);
+        }
+    }
+
+    inline ConnectionId firstConnectionDepartingAt(const int departureTime) const noexcept {
+        if (departureTime <= minDepartureTime) return ConnectionId(0);
+        const size_t bucket = bucketOf(departureTime);
+        if (bucket + 1 >= firstConnectionOfBucket.size()) return ConnectionId(connections.size());
+        const auto begin = connections.begin() + firstConnectionOfBucket[bucket];
+        const auto end = connections.begin() + firstConnectionOfBucket[bucket + 1];
+        return ConnectionId(std::lower_bound(begin, end, departureTime,
+                                             [](const Connection& connection, const int time) {
+            return connection.departureTime < time;
+        }) - connections.begin());
+    }
+
+    inline long long byteSize() const noexcept { return Vector::byteSize(firstConnectionOfBucket); }
+
+private:
+    inline size_t bucketOf(const int departureTime) const noexcept {
+        return static_cast<size_t>(departureTime - minDepartureTime) / bucketWidth;
+    }
+
+private:
+    const std::vector<Connection>& connections;
+    int minDepartureTime;
+    int bucketWidth;
+    std::vector<ConnectionId> firstConnectionOfBucket;
+};
+
+} // namespace CSA
@@ -0,0 +1,219 @@
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+#ifdef USE_SIMD
+#include <immintrin.h>
+#endif
+
+#include "../../../Helpers/Assert.h"
+#include "../../../Helpers/Types.h"
+#include "../../../Helpers/Vector/Vector.h"
+#include "../../../Helpers/aligned_allocator.h"
+
+namespace CSA {
+
+// Flat storage for the profiles of all stops during a profile query. A profile is a list of entries (departure time,
+// arrival time, enter connection, exit connection) sorted by decreasing departure time, where no entry dominates a
+// later one. The fields are stored in separate arrays, and the entries of a profile occupy a contiguous range of these
+// arrays, whose capacity is a multiple of 8. A profile that outgrows its range is moved to a range of twice the size at
+// the end of the arena. Memory is not freed until clear(), which only resets the profiles that were used.
+// The last entry departing at or after a given time is found by comparing 8 departure times at once if USE_SIMD is
+// set. Since departure times are decreasing, this is the entry with the earliest arrival time among those entries.
+class ProfileArena {
+public:
+    static constexpr size_t BlockSize = 8;
+    static constexpr size_t InitialCapacity = BlockSize;
+    // Number of entries that are checked one by one before the search switches to SIMD.
+    static constexpr size_t ScalarSearchLength = 16;
+
+private:
+    struct Range {
+        Range(const size_t begin = 0, const size_t size = 0, const size_t capacity = 0)
+            : begin(begin), size(size), capacity(capacity) {}
+
+        size_t begin;
+        size_t size;
+        size_t capacity;
+    };
+
+public:
+    ProfileArena(const size_t numberOfStops = 0) : ranges(numberOfStops), end(0) {}
+
+    inline void clear() noexcept {
+        for (const StopId stop : usedStops) {
+            ranges[stop] = Range();
+        }
+        usedStops.clear();
+        end = 0;
+    }
+
+    inline size_t size(const StopId stop) const noexcept { return ranges[stop].size; }
+
+    inline bool empty(const StopId stop) const noexcept { return ranges[stop].size == 0; }
+
+    inline int departureTime(const StopId stop, const size_t i) const noexcept {
+        return departureTimes[entry(stop, i)];
+    }
+
+    inline int arrivalTime(const StopId stop, const size_t i) const noexcept { return arrivalTimes[entry(stop, i)]; }
+
+    inline ConnectionId enterConnection(const StopId stop, const size_t i) const noexcept {
+        return enterConnections[entry(stop, i)];
+    }
+
+    inline ConnectionId exitConnection(const StopId stop, const size_t i) const noexcept {
+        return exitConnections[entry(stop, i)];
+    }
+
+    // Returns the index of the last entry departing at or after the given time, or -1 if there is no such entry.
+    inline int lastEntryDepartingAtOrAfter(const StopId stop, const int time) const noexcept {
+        const Range& range = ranges[stop];
+        const int* departures = departureTimes.data() + range.begin;
+        int i = static_cast<int>(range.size) - 1;
+#if defined(USE_SIMD) && defined(__AVX2__)
+        // Profiles are built by decreasing departure time, so the entry is almost always among the last few, which
+        // are checked one by one. Only longer searches compare 8 departure times at once.
+        const int scalarEnd = std::max(-1, i - static_cast<int>(ScalarSearchLength));
+        while (i > scalarEnd) {
+            if (departures[i] >= time) return i;
+            i--;
+        }
+        return lastEntryDepartingAtOrAfterSIMD(departures, i, time);
+#else
+        while (i >= 0 && departures[i] < time) {
+            i--;
+        }
+        return i;
+#endif
+    }
+
+    // Returns the earliest arrival time of an entry departing at or after the given time.
+    inline int earliestArrivalTime(const StopId stop, const int time) const noexcept {
+        const int i = lastEntryDepartingAtOrAfter(stop, time);
+        return (i < 0) ? never : arrivalTime(stop, i);
+    }
+
+    inline bool isDominated(const StopId stop, const int departureTime, const int arrivalTime) const noexcept {
+        return earliestArrivalTime(stop, departureTime) <= arrivalTime;
+    }
+
+    // Inserts the entry behind all entries departing at or after its departure time, and removes all entries it
+    // dominates from the profile.
+    inline void incorporate(const StopId stop, const int departureTime, const int arrivalTime,
+                            const ConnectionId enterConnection, const ConnectionId exitConnection) noexcept {
+        const size_t index = lastEntryDepartingAtOrAfter(stop, departureTime) + 1;
+        reserve(stop, ranges[stop].size + 1);
+        Range& range = ranges[stop];
+        size_t newSize = index;
+        for (size_t i = index; i < range.size; i++) {
+            const size_t from = range.begin + i;
+            if (departureTime >= departureTimes[from] && arrivalTime <= arrivalTimes[from]) continue;
+            moveEntry(from, range.begin + newSize);
+            newSize++;
+        }
+        for (size_t i = newSize; i > index; i--) {
+            moveEntry(range.begin + i - 1, range.begin + i);
+        }
+        setEntry(range.begin + index, departureTime, arrivalTime, enterConnection, exitConnection);
+        range.size = newSize + 1;
+    }
+
+    // Appends an entry that departs no later than the last entry of the profile.
+    inline void append(const StopId stop, const int departureTime, const int arrivalTime,
+                       const ConnectionId enterConnection, const ConnectionId exitConnection) noexcept {
+        AssertMsg(empty(stop) || departureTime <= this->departureTime(stop, size(stop) - 1),
+                  "Entries must be appended in order of decreasing departure time!");
+        reserve(stop, ranges[stop].size + 1);
+        Range& range = ranges[stop];
+        setEntry(range.begin + range.size, departureTime, arrivalTime, enterConnection, exitConnection);
+        range.size++;
+    }
+
+    inline long long byteSize() const noexcept {
+        return departureTimes.size() * sizeof(int) + Vector::byteSize(arrivalTimes)
+               + Vector::byteSize(enterConnections) + Vector::byteSize(exitConnections) + Vector::byteSize(ranges)
+               + Vector::byteSize(usedStops);
+    }
+
+private:
+#if defined(USE_SIMD) && defined(__AVX2__)
+    // Searches the entries 0 to last backwards, starting with the entries up to the next block boundary.
+    inline static int lastEntryDepartingAtOrAfterSIMD(const int* departures, int last, const int time) noexcept {
+        while (last >= 0 && (last + 1) % BlockSize != 0) {
+            if (departures[last] >= time) return last;
+            last--;
+        }
+        const __m256i times = _mm256_set1_epi32(time);
+        for (int blockEnd = last + 1; blockEnd > 0; blockEnd -= BlockSize) {
+            const __m256i departure =
+                _mm256_load_si256(reinterpret_cast<const __m256i*>(departures + blockEnd - BlockSize));
+            const int tooEarly = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(times, departure)));
+            if (tooEarly != 0xFF) return blockEnd - BlockSize + __builtin_popcount(~tooEarly & 0xFF) - 1;
+        }
+        return -1;
+    }
+#endif
+
+    inline size_t entry(const StopId stop, const size_t i) const noexcept {
+        AssertMsg(i < ranges[stop].size, "Entry " << i << " of stop " << stop << " is out of range!");
+        return ranges[stop].begin + i;
+    }
+
+    inline void reserve(const StopId stop, const size_t capacity) noexcept {
+        Range& range = ranges[stop];
+        if (capacity <= range.capacity) return;
+        if (range.capacity == 0) usedStops.emplace_back(stop);
+        const size_t newCapacity = std::max(InitialCapacity, 2 * range.capacity);
+        if (range.capacity > 0 && range.begin + range.capacity == end) {
+            // The range is the last one in the arena and can grow in place.
+            growArena(range.begin + newCapacity);
+            end = range.begin + newCapacity;
+        } else {
+            growArena(end + newCapacity);
+            for (size_t i = 0; i < range.size; i++) {
+                moveEntry(range.begin + i, end + i);
+            }
+            range.begin = end;
+            end += newCapacity;
+        }
+        range.capacity = newCapacity;
+    }
+
+    inline void growArena(const size_t minSize) noexcept {
+        if (minSize <= departureTimes.size()) return;
+        const size_t newSize = std::max(minSize, 2 * departureTimes.size());
+        departureTimes.resize(newSize);
+        arrivalTimes.resize(newSize);
+        enterConnections.resize(newSize);
+        exitConnections.resize(newSize);
+    }
+
+    inline void moveEntry(const size_t from, const size_t to) noexcept {
+        departureTimes[to] = departureTimes[from];
+        arrivalTimes[to] = arrivalTimes[from];
+        enterConnections[to] = enterConnections[from];
+        exitConnections[to] = exitConnections[from];
+    }
+
+    inline void setEntry(const size_t i, const int departureTime, const int arrivalTime,
+                         const ConnectionId enterConnection, const ConnectionId exitConnection) noexcept {
+        departureTimes[i] = departureTime;
+        arrivalTimes[i] = arrivalTime;
+        enterConnections[i] = enterConnection;
+        exitConnections[i] = exitConnection;
+    }
+
+private:
+    std::vector<int, aligned_allocator<int, 32>> departureTimes;
+    std::vector<int> arrivalTimes;
+    std::vector<ConnectionId> enterConnections;
+    std::vector<ConnectionId> exitConnections;
+
+    std::vector<Range> ranges;
+    std::vector<StopId> usedStops;
+    size_t end;
+};
+
+} // namespace CSA
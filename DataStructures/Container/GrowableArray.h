@@ -0,0 +1,45 @@
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+#include "../../Helpers/Assert.h"
+
+// Scratch buffer for query algorithms. It starts with a small capacity, which is doubled whenever a larger size is
+// requested, and it is never shrunk, such that the memory is reused by subsequent queries.
+template <typename VALUE>
+class GrowableArray {
+public:
+    using Value = VALUE;
+    using Type = GrowableArray<Value>;
+
+public:
+    GrowableArray(const size_t initialCapacity = 1024) : values(std::max<size_t>(initialCapacity, 1)) {}
+
+    inline void reserve(const size_t size) noexcept {
+        if (size <= values.size()) [[likely]]
+            return;
+        size_t newCapacity = values.size();
+        while (newCapacity < size) {
+            newCapacity *= 2;
+        }
+        values.resize(newCapacity);
+    }
+
+    inline Value& operator[](const size_t i) noexcept {
+        AssertMsg(i < values.size(), "Index " << i << " is out of bounds!");
+        return values[i];
+    }
+
+    inline const Value& operator[](const size_t i) const noexcept {
+        AssertMsg(i < values.size(), "Index " << i << " is out of bounds!");
+        return values[i];
+    }
+
+    inline size_t capacity() const noexcept { return values.size(); }
+
+    inline long long byteSize() const noexcept { return values.capacity() * sizeof(Value); }
+
+private:
+    std::vector<Value> values;
+};
@@ -0,0 +1,397 @@
+#pragma once
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifdef USE_SIMD
+#include <immintrin.h>
+#endif
+
+#include "../../Helpers/Assert.h"
+#include "../../Helpers/IO/Serialization.h"
+#include "../../Helpers/Ranges/Range.h"
+#include "../../Helpers/String/String.h"
+#include "../../Helpers/Types.h"
+#include "../../Helpers/Vector/Vector.h"
+#include "../Graph/Graph.h"
+
+// Hub labels of all vertices in one flat array. The label of a vertex is the entry range [beginEntry(v), endEntry(v)),
+// and every entry consists of a 32-bit hub id and a 32-bit distance, which are stored in two parallel arrays. Within
+// a label, the entries are either sorted by hub id, which allows computing distances by intersecting an out-label with
+// an in-label (see getDistance()), or by distance, which allows label scans to stop as soon as a bound is exceeded.
+// The hub ids of hub-sorted labels can be delta encoded, i.e., stored as varint-encoded differences between
+// consecutive hubs. Delta-encoded labels can only be read sequentially with forEachEntry().
+class HubLabels {
+public:
+    using Type = HubLabels;
+
+private:
+    inline static const std::string FormatName = "HubLabels";
+
+    class HubDecoder {
+    public:
+        HubDecoder(const u_int8_t* bytes) : bytes(bytes), hub(0) {}
+
+        inline u_int32_t next() noexcept {
+            u_int32_t delta = 0;
+            for (int shift = 0;; shift += 7) {
+                const u_int8_t byte = *(bytes++);
+                delta |= u_int32_t(byte & 0x7F) << shift;
+                if (!(byte & 0x80)) break;
+            }
+            hub += delta;
+            return hub;
+        }
+
+    private:
+        const u_int8_t* bytes;
+        u_int32_t hub;
+    };
+
+    class LabelCursor {
+    public:
+        LabelCursor(const HubLabels& labels, const Vertex vertex)
+            : labels(labels),
+              entry(labels.beginEntry(vertex)),
+              end(labels.endEntry(vertex)),
+              decoder(labels.deltaEncoded ? (labels.encodedHubs.data() + labels.firstByte[vertex]) : nullptr),
+              currentHub(0) {
+            if (entry < end) readHub();
+        }
+
+        inline bool done() const noexcept { return entry >= end; }
+        inline u_int32_t hub() const noexcept { return currentHub; }
+        inline int distance() const noexcept { return labels.distances[entry]; }
+
+        inline void next() noexcept {
+            entry++;
+            if (entry < end) readHub();
+        }
+
+    private:
+        inline void readHub() noexcept { currentHub = labels.deltaEncoded ? decoder.next() : labels.hubs[entry]; }
+
+        const HubLabels& labels;
+        size_t entry;
+        size_t end;
+        HubDecoder decoder;
+        u_int32_t currentHub;
+    };
+
+public:
+    HubLabels() : sortedByDistance(false), deltaEncoded(false) {}
+
+    HubLabels(const std::string& fileName) : HubLabels() { deserialize(fileName); }
+
+    // Every edge (v, h) of the hub graph is an entry of hub h with the travel time of the edge in the label of v.
+    // Sorting by distance is stable, i.e., entries with equal distance keep the order of the hub graph.
+    HubLabels(const TransferGraph& hubGraph, const bool sortByDistance = false)
+        : firstEntry(1, 0), sortedByDistance(sortByDistance), deltaEncoded(false) {
+        hubs.reserve(hubGraph.numEdges());
+        distances.reserve(hubGraph.numEdges());
+        for (const Vertex vertex : hubGraph.vertices()) {
+            const size_t begin = hubs.size();
+            for (const Edge edge : hubGraph.edgesFrom(vertex)) {
+                AssertMsg(hubGraph.isVertex(hubGraph.get(ToVertex, edge)), "Hub is not a vertex!");
+                hubs.emplace_back(hubGraph.get(ToVertex, edge));
+                distances.emplace_back(hubGraph.get(TravelTime, edge));
+            }
+            sortLabel(begin);
+            firstEntry.emplace_back(hubs.size());
+        }
+    }
+
+    inline size_t numVertices() const noexcept { return firstEntry.size() - 1; }
+
+    inline bool isVertex(const Vertex vertex) const noexcept { return vertex < numVertices(); }
+
+    inline Range<Vertex> vertices() const noexcept { return Range<Vertex>(Vertex(0), Vertex(numVertices())); }
+
+    inline size_t numEntries() const noexcept { return distances.size(); }
+
+    inline size_t labelSize(const Vertex vertex) const noexcept {
+        AssertMsg(isVertex(vertex), "Vertex " << vertex << " is out of range!");
+        return firstEntry[vertex + 1] - firstEntry[vertex];
+    }
+
+    inline bool isSortedByDistance() const noexcept { return sortedByDistance; }
+
+    inline bool isDeltaEncoded() const noexcept { return deltaEncoded; }
+
+    inline size_t beginEntry(const Vertex vertex) const noexcept { return firstEntry[vertex]; }
+
+    inline size_t endEntry(const Vertex vertex) const noexcept { return firstEntry[vertex + 1]; }
+
+    inline Range<size_t> entries(const Vertex vertex) const noexcept {
+        AssertMsg(isVertex(vertex), "Vertex " << vertex << " is out of range!");
+        return Range<size_t>(firstEntry[vertex], firstEntry[vertex + 1]);
+    }
+
+    inline Vertex hub(const size_t entry) const noexcept {
+        AssertMsg(!deltaEncoded, "Hubs of delta-encoded labels cannot be accessed directly!");
+        return Vertex(hubs[entry]);
+    }
+
+    inline int distance(const size_t entry) const noexcept { return distances[entry]; }
+
+    template <typename FUNCTION>
+    inline void forEachEntry(const Vertex vertex, const FUNCTION& function) const noexcept {
+        if (deltaEncoded) {
+            HubDecoder decoder(encodedHubs.data() + firstByte[vertex]);
+            for (const size_t entry : entries(vertex)) {
+                function(Vertex(decoder.next()), distances[entry]);
+            }
+        } else {
+            for (const size_t entry : entries(vertex)) {
+                function(Vertex(hubs[entry]), distances[entry]);
+            }
+        }
+    }
+
+    // Distance from the given vertex to the given hub according to its label, or INFTY if the hub is not contained.
+    inline int getDistanceToHub(const Vertex vertex, const Vertex hubVertex) const noexcept {
+        AssertMsg(!sortedByDistance, "Labels must be sorted by hub!");
+        if (deltaEncoded) {
+            for (LabelCursor cursor(*this, vertex); !cursor.done(); cursor.next()) {
+                if (cursor.hub() >= hubVertex) return (cursor.hub() == hubVertex) ? cursor.distance() : INFTY;
+            }
+            return INFTY;
+        }
+        const u_int32_t* const begin = hubs.data() + firstEntry[vertex];
+        const u_int32_t* const end = hubs.data() + firstEntry[vertex + 1];
+        const u_int32_t* const entry = std::lower_bound(begin, end, u_int32_t(hubVertex));
+        return (entry != end && *entry == hubVertex) ? distances[entry - hubs.data()] : INFTY;
+    }
+
+    // Distance from the given vertex (with respect to these out-labels) to the given target (with respect to the
+    // given in-labels). The vertices themselves are treated as implicit hubs with distance 0.
+    inline int getDistance(const Vertex from, const HubLabels& inLabels, const Vertex to) const noexcept {
+        AssertMsg(!sortedByDistance && !inLabels.isSortedByDistance(), "Labels must be sorted by hub!");
+        if (from == to) return 0;
+        int result = std::min(getDistanceToHub(from, to), inLabels.getDistanceToHub(to, from));
+        if (deltaEncoded || inLabels.isDeltaEncoded()) {
+            result = std::min(result, mergeEncoded(from, inLabels, to));
+        } else {
+            result = std::min(result, intersect(hubs.data() + firstEntry[from], distances.data() + firstEntry[from],
+                                                labelSize(from), inLabels.hubs.data() + inLabels.firstEntry[to],
+                                                inLabels.distances.data() + inLabels.firstEntry[to],
+                                                inLabels.labelSize(to)));
+        }
+        return result;
+    }
+
+    // Labels of the inverse relation, restricted to the vertices for which keepVertex() returns true: the label of a
+    // hub h contains an entry (v, d) for every entry (h, d) in the label of a kept vertex v.
+    template <typename KEEP_VERTEX>
+    inline HubLabels reverse(const KEEP_VERTEX& keepVertex) const noexcept {
+        HubLabels result;
+        result.sortedByDistance = sortedByDistance;
+        result.firstEntry.assign(numVertices() + 1, 0);
+        for (const Vertex vertex : vertices()) {
+            if (!keepVertex(vertex)) continue;
+            forEachEntry(vertex, [&](const Vertex hubVertex, const int) { result.firstEntry[hubVertex + 1]++; });
+        }
+        for (size_t i = 1; i < result.firstEntry.size(); i++) {
+            result.firstEntry[i] += result.firstEntry[i - 1];
+        }
+        result.hubs.resize(result.firstEntry.back());
+        result.distances.resize(result.firstEntry.back());
+        std::vector<size_t> nextEntry(result.firstEntry.begin(), result.firstEntry.end() - 1);
+        for (const Vertex vertex : vertices()) {
+            if (!keepVertex(vertex)) continue;
+            forEachEntry(vertex, [&](const Vertex hubVertex, const int dist) {
+                result.hubs[nextEntry[hubVertex]] = vertex;
+                result.distances[nextEntry[hubVertex]++] = dist;
+            });
+        }
+        for (const Vertex vertex : result.vertices()) {
+            result.sortLabel(result.firstEntry[vertex], result.firstEntry[vertex + 1]);
+        }
+        return result;
+    }
+
+    inline void setSortedByDistance(const bool sortByDistance) noexcept {
+        if (sortedByDistance == sortByDistance) return;
+        deltaDecode();
+        sortedByDistance = sortByDistance;
+        for (const Vertex vertex : vertices()) {
+            sortLabel(firstEntry[vertex], firstEntry[vertex + 1]);
+        }
+    }
+
+    inline void deltaEncode() noexcept {
+        AssertMsg(!sortedByDistance, "Only labels sorted by hub can be delta encoded!");
+        if (deltaEncoded) return;
+        firstByte.assign(1, 0);
+        encodedHubs.clear();
+        for (const Vertex vertex : vertices()) {
+            u_int32_t previousHub = 0;
+            for (const size_t entry : entries(vertex)) {
+                u_int32_t delta = hubs[entry] - previousHub;
+                previousHub = hubs[entry];
+                while (delta >= 0x80) {
+                    encodedHubs.emplace_back(u_int8_t(delta | 0x80));
+                    delta >>= 7;
+                }
+                encodedHubs.emplace_back(u_int8_t(delta));
+            }
+            firstByte.emplace_back(encodedHubs.size());
+        }
+        encodedHubs.shrink_to_fit();
+        std::vector<u_int32_t>().swap(hubs);
+        deltaEncoded = true;
+    }
+
+    inline void deltaDecode() noexcept {
+        if (!deltaEncoded) return;
+        hubs.resize(numEntries());
+        for (const Vertex vertex : vertices()) {
+            HubDecoder decoder(encodedHubs.data() + firstByte[vertex]);
+            for (const size_t entry : entries(vertex)) {
+                hubs[entry] = decoder.next();
+            }
+        }
+        std::vector<size_t>().swap(firstByte);
+        std::vector<u_int8_t>().swap(encodedHubs);
+        deltaEncoded = false;
+    }
+
+    inline void printInfo() const noexcept {
+        size_t maxLabelSize = 0;
+        for (const Vertex vertex : vertices()) {
+            maxLabelSize = std::max(maxLabelSize, labelSize(vertex));
+        }
+        std::cout << "Hub labels:" << std::endl;
+        std::cout << "   Number of vertices:   " << std::setw(12) << String::prettyInt(numVertices()) << std::endl;
+        std::cout << "   Number of entries:    " << std::setw(12) << String::prettyInt(numEntries()) << std::endl;
+        std::cout << "   Avg. label size:      " << std::setw(12)
+                  << String::prettyDouble(numEntries() / static_cast<double>(std::max<size_t>(numVertices(), 1)))
+                  << std::endl;
+        std::cout << "   Max. label size:      " << std::setw(12) << String::prettyInt(maxLabelSize) << std::endl;
+        std::cout << "   Sorted by:            " << std::setw(12) << (sortedByDistance ? "distance" : "hub")
+                  << std::endl;
+        std::cout << "   Delta encoded:        " << std::setw(12) << (deltaEncoded ? "yes" : "no") << std::endl;
+        std::cout << "   Total size:           " << std::setw(12) << String::bytesToString(byteSize()) << std::endl;
+    }
+
+    inline void serialize(const std::string& fileName) const noexcept {
+        IO::serialize(fileName, FormatName, sortedByDistance, deltaEncoded, firstEntry, hubs, distances, firstByte,
+                      encodedHubs);
+    }
+
+    inline void deserialize(const std::string& fileName) noexcept {
+        std::string formatName;
+        IO::deserialize(fileName, formatName, sortedByDistance, deltaEncoded, firstEntry, hubs, distances, firstByte,
+                        encodedHubs);
+        AssertMsg(formatName == FormatName, fileName << " does not contain hub labels!");
+    }
+
+    inline long long byteSize() const noexcept {
+        long long result = Vector::byteSize(firstEntry);
+        result += Vector::byteSize(hubs);
+        result += Vector::byteSize(distances);
+        result += Vector::byteSize(firstByte);
+        result += Vector::byteSize(encodedHubs);
+        return result;
+    }
+
+private:
+    inline void sortLabel(const size_t begin) noexcept { sortLabel(begin, hubs.size()); }
+
+    inline void sortLabel(const size_t begin, const size_t end) noexcept {
+        std::vector<std::pair<u_int32_t, int>> label;
+        label.reserve(end - begin);
+        for (size_t entry = begin; entry < end; entry++) {
+            label.emplace_back(hubs[entry], distances[entry]);
+        }
+        if (sortedByDistance) {
+            std::stable_sort(label.begin(), label.end(),
+                             [](const auto& a, const auto& b) { return a.second < b.second; });
+        } else {
+            std::sort(label.begin(), label.end());
+            AssertMsg(std::adjacent_find(label.begin(), label.end(), [](const auto& a, const auto& b) {
+                return a.first == b.first;
+            }) == label.end(), "Label contains a hub more than once!");
+        }
+        for (size_t i = 0; i < label.size(); i++) {
+            hubs[begin + i] = label[i].first;
+            distances[begin + i] = label[i].second;
+        }
+    }
+
+    // Minimum distance over all common hubs of two hub-sorted labels. Blocks of 8 hubs of both labels are compared
+    // all-against-all with AVX2 by rotating one of the blocks; the block with the smaller last hub is skipped.
+    inline static int intersect(const u_int32_t* hubsA, const int* distancesA, const size_t sizeA,
+                                const u_int32_t* hubsB, const int* distancesB, const size_t sizeB) noexcept {
+        int result = INFTY;
+        size_t i = 0;
+        size_t j = 0;
+#if defined(USE_SIMD) && defined(__AVX2__)
+        const __m256i rotate = _mm256_setr_epi32(1, 2, 3, 4, 5, 6, 7, 0);
+        while (i + 8 <= sizeA && j + 8 <= sizeB) {
+            const __m256i blockA = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(hubsA + i));
+            __m256i blockB = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(hubsB + j));
+            __m256i matches = _mm256_cmpeq_epi32(blockA, blockB);
+            for (int r = 1; r < 8; r++) {
+                blockB = _mm256_permutevar8x32_epi32(blockB, rotate);
+                matches = _mm256_or_si256(matches, _mm256_cmpeq_epi32(blockA, blockB));
+            }
+            int mask = _mm256_movemask_ps(_mm256_castsi256_ps(matches));
+            while (mask != 0) {
+                const int k = __builtin_ctz(mask);
+                mask &= mask - 1;
+                const u_int32_t* const match = std::lower_bound(hubsB + j, hubsB + j + 8, hubsA[i + k]);
+                result = std::min(result, distancesA[i + k] + distancesB[match - hubsB]);
+            }
+            const u_int32_t lastA = hubsA[i + 7];
+            const u_int32_t lastB = hubsB[j + 7];
+            if (lastA <= lastB) i += 8;
+            if (lastB <= lastA) j += 8;
+        }
+#endif
+        while (i < sizeA && j < sizeB) {
+            if (hubsA[i] < hubsB[j]) {
+                i++;
+            } else if (hubsB[j] < hubsA[i]) {
+                j++;
+            } else {
+                result = std::min(result, distancesA[i++] + distancesB[j++]);
+            }
+        }
+        return result;
+    }
+
+    // Merge join for labels of which at least one is delta encoded.
+    inline int mergeEncoded(const Vertex from, const HubLabels& inLabels, const Vertex to) const noexcept {
+        int result = INFTY;
+        LabelCursor a(*this, from);
+        LabelCursor b(inLabels, to);
+        while (!a.done() && !b.done()) {
+            if (a.hub() < b.hub()) {
+                a.next();
+            } else if (b.hub() < a.hub()) {
+                b.next();
+            } else {
+                result = std::min(result, a.distance() + b.distance());
+                a.next();
+                b.next();
+            }
+        }
+        return result;
+    }
+
+private:
+    std::vector<size_t> firstEntry;
+    std::vector<u_int32_t> hubs;
+    std::vector<int> distances;
+
+    std::vector<size_t> firstByte;
+    std::vector<u_int8_t> encodedHubs;
+
+    bool sortedByDistance;
+    bool deltaEncoded;
+};
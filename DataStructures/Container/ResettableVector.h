@@ -0,0 +1,55 @@
+#pragma once
+
+#include <type_traits>
+#include <vector>
+
+#include "../../Helpers/Assert.h"
+#include "../../Helpers/Meta.h"
+
+// Fixed-size vector that can be reset to a default value in time proportional to the number of entries that were
+// changed since the last reset. The indices of entries that are changed from the default value are recorded, and
+// clear() only restores these entries. Reads are plain array accesses, which keeps the scan loops of the query
+// algorithms as fast as with a std::vector, while short queries no longer pay for resetting the whole vector.
+// Boolean values are stored as bytes, since std::vector<bool> cannot hand out references to its entries.
+template <typename VALUE>
+class ResettableVector {
+public:
+    using Value = VALUE;
+    using Type = ResettableVector<Value>;
+    using Entry = Meta::IF<std::is_same_v<Value, bool>, u_int8_t, Value>;
+
+public:
+    ResettableVector(const size_t size = 0, const Value& defaultValue = Value())
+        : values(size, defaultValue), defaultValue(defaultValue) {}
+
+    inline size_t size() const noexcept { return values.size(); }
+
+    inline void clear() noexcept {
+        for (const size_t i : changedEntries) {
+            values[i] = defaultValue;
+        }
+        changedEntries.clear();
+    }
+
+    inline const Entry& operator[](const size_t i) const noexcept {
+        AssertMsg(i < values.size(), "Index " << i << " is out of bounds!");
+        return values[i];
+    }
+
+    inline void set(const size_t i, const Value& value) noexcept {
+        AssertMsg(i < values.size(), "Index " << i << " is out of bounds!");
+        if (values[i] == defaultValue) changedEntries.emplace_back(i);
+        values[i] = value;
+    }
+
+    inline size_t numberOfChangedEntries() const noexcept { return changedEntries.size(); }
+
+    inline long long byteSize() const noexcept {
+        return values.size() * sizeof(Entry) + changedEntries.capacity() * sizeof(size_t) + sizeof(Type);
+    }
+
+private:
+    std::vector<Entry> values;
+    std::vector<size_t> changedEntries;
+    Entry defaultValue;
+};
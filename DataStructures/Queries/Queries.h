@@ -1,5 +1,6 @@
 #pragma once
 
+#include <algorithm>
 #include <random>
 #include <vector>
 
@@ -79,3 +80,24 @@ inline std::vector<StopQuery> generateRandomStopQueries(const size_t numStops, c
     }
     return queries;
 }
+
+// Generates queries whose source/target pairs are drawn from a small pool of random pairs, which resembles the skewed
+// demand of real-world query logs (e.g., for benchmarking result caches).
+inline std::vector<StopQuery> generateSkewedStopQueries(const size_t numStops, const size_t numQueries,
+                                                        const size_t numPairs, const int startTime = 0,
+                                                        const int endTime = 24 * 60 * 60) noexcept {
+    std::mt19937 randomGenerator(42);
+    std::uniform_int_distribution<> stopDistribution(0, numStops - 1);
+    std::uniform_int_distribution<> timeDistribution(startTime, endTime - 1);
+    std::vector<std::pair<StopId, StopId>> pairs;
+    for (size_t i = 0; i < std::max<size_t>(numPairs, 1); i++) {
+        pairs.emplace_back(StopId(stopDistribution(randomGenerator)), StopId(stopDistribution(randomGenerator)));
+    }
+    std::uniform_int_distribution<> pairDistribution(0, pairs.size() - 1);
+    std::vector<StopQuery> queries;
+    for (size_t i = 0; i < numQueries; i++) {
+        const std::pair<StopId, StopId>& pair = pairs[pairDistribution(randomGenerator)];
+        queries.emplace_back(pair.first, pair.second, timeDistribution(randomGenerator));
+    }
+    return queries;
+}
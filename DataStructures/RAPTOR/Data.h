@@ -213,6 +213,16 @@ public:
         return firstTripOfRoute(route) + tripNum * numberOfStopsInRoute(route);
     }
 
+    inline bool hasTransposedDepartureTimes() const noexcept { return !transposedDepartureTimes.empty(); }
+
+    // Returns the transposed departure times of the route, where the departure time of trip i at stop index j is
+    // stored at position j * numberOfTripsInRoute(route) + i, or nullptr if they have not been built.
+    inline const int* transposedDepartureTimesOfRoute(const RouteId route) const noexcept {
+        AssertMsg(isRoute(route), "The id " << route << " does not represent a route!");
+        if (!hasTransposedDepartureTimes()) return nullptr;
+        return &(transposedDepartureTimes[firstStopEventOfRoute[route]]);
+    }
+
     inline TripIterator getTripIterator(const RouteId route, const StopIndex stopIndex,
                                         const StopEvent* const currentTrip) const noexcept {
         AssertMsg(isRoute(route), "The id " << route << " does not represent a route!");
@@ -287,9 +297,32 @@ private:
                 }
             }
         }
+        if (hasTransposedDepartureTimes()) buildTransposedDepartureTimes();
     }
 
 public:
+    // Builds a stop-major copy of the departure times of every route, such that the departure times of all trips at
+    // the same stop are contiguous. This allows route scans to search for the earliest reachable trip without touching
+    // a different cache line for every trip. The copy is not serialized and kept up to date by the functions that
+    // modify the departure times, except for rebuildRoutes() and applyRouteOrder(), which discard it.
+    inline void buildTransposedDepartureTimes() noexcept {
+        transposedDepartureTimes.resize(stopEvents.size());
+        for (const RouteId route : routes()) {
+            const size_t tripSize = numberOfStopsInRoute(route);
+            const size_t numberOfTrips = numberOfTripsInRoute(route);
+            const StopEvent* trips = firstTripOfRoute(route);
+            int* departureTimes = &(transposedDepartureTimes[firstStopEventOfRoute[route]]);
+            for (size_t trip = 0; trip < numberOfTrips; trip++) {
+                for (size_t stopIndex = 0; stopIndex < tripSize; stopIndex++) {
+                    departureTimes[(stopIndex * numberOfTrips) + trip] =
+                        trips[(trip * tripSize) + stopIndex].departureTime;
+                }
+            }
+        }
+    }
+
+    inline void clearTransposedDepartureTimes() noexcept { std::vector<int>().swap(transposedDepartureTimes); }
+
     inline void useImplicitDepartureBufferTimes() noexcept {
         if (implicitDepartureBufferTimes | implicitArrivalBufferTimes) return;
         adjustTimes([&](StopEvent& stopEvent, const StopId stop) { stopEvent.departureTime -= minTransferTime(stop); });
@@ -956,6 +989,7 @@ public:
         result += Vector::byteSize(routeSegments);
         result += Vector::byteSize(stopIds);
         result += Vector::byteSize(stopEvents);
+        result += Vector::byteSize(transposedDepartureTimes);
         result += Vector::byteSize(stopData);
         result += Vector::byteSize(routeData);
         result += transferGraph.byteSize();
@@ -964,6 +998,7 @@ public:
     }
 
     inline Order rebuildRoutes() noexcept {
+        clearTransposedDepartureTimes();
         Order stopEventOrder;
         stopEventOrder.reserve(stopEvents.size());
         std::vector<std::vector<std::vector<size_t>>> newRoutes(numberOfRoutes());
@@ -1049,6 +1084,55 @@ public:
         return stopEventOrder;
     }
 
+    // Renumbers the routes according to the given order (new id -> old id). Stop ids are not changed. Returns the
+    // resulting order of the stop events, which can be used to update data indexed by stop events.
+    inline Order applyRouteOrder(const Order& routeOrder) noexcept {
+        AssertMsg(routeOrder.size() == numberOfRoutes(),
+                  "Route order size (" << routeOrder.size() << ") must be the same as number of routes ("
+                                       << numberOfRoutes() << ")!");
+        AssertMsg(routeOrder.isValid(), "The route order is not valid!");
+        clearTransposedDepartureTimes();
+        const Permutation routePermutation(Construct::Invert, routeOrder);
+
+        Order stopEventOrder;
+        stopEventOrder.reserve(stopEvents.size());
+        std::vector<StopId> newStopIds;
+        newStopIds.reserve(stopIds.size());
+        std::vector<size_t> newFirstStopIdOfRoute;
+        newFirstStopIdOfRoute.reserve(firstStopIdOfRoute.size());
+        std::vector<size_t> newFirstStopEventOfRoute;
+        newFirstStopEventOfRoute.reserve(firstStopEventOfRoute.size());
+
+        for (const size_t route : routeOrder) {
+            newFirstStopIdOfRoute.emplace_back(newStopIds.size());
+            for (size_t i = firstStopIdOfRoute[route]; i < firstStopIdOfRoute[route + 1]; i++) {
+                newStopIds.emplace_back(stopIds[i]);
+            }
+            newFirstStopEventOfRoute.emplace_back(stopEventOrder.size());
+            for (size_t i = firstStopEventOfRoute[route]; i < firstStopEventOfRoute[route + 1]; i++) {
+                stopEventOrder.emplace_back(i);
+            }
+        }
+        newFirstStopIdOfRoute.emplace_back(newStopIds.size());
+        newFirstStopEventOfRoute.emplace_back(stopEventOrder.size());
+
+        firstStopIdOfRoute.swap(newFirstStopIdOfRoute);
+        firstStopEventOfRoute.swap(newFirstStopEventOfRoute);
+        stopIds.swap(newStopIds);
+        stopEventOrder.order(stopEvents);
+        routeOrder.order(routeData);
+
+        for (RouteSegment& segment : routeSegments) {
+            segment.routeId = routePermutation.permutate(segment.routeId);
+        }
+        for (const StopId stop : stops()) {
+            std::sort(routeSegments.begin() + firstRouteSegmentOfStop[stop],
+                      routeSegments.begin() + firstRouteSegmentOfStop[stop + 1]);
+        }
+
+        return stopEventOrder;
+    }
+
     // Arc-Flag TB
     inline int getNumberOfPartitionCells() const noexcept { return numberOfPartitions; }
 
@@ -1239,6 +1323,7 @@ public:
 
     std::vector<StopId> stopIds;
     std::vector<StopEvent> stopEvents;
+    std::vector<int> transposedDepartureTimes;
 
     std::vector<Stop> stopData;
     std::vector<Route> routeData;
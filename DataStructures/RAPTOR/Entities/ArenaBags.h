@@ -0,0 +1,325 @@
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+#ifdef USE_SIMD
+#include <immintrin.h>
+#endif
+
+#include "../../../Helpers/Assert.h"
+#include "../../../Helpers/Meta.h"
+#include "../../../Helpers/aligned_allocator.h"
+
+namespace RAPTOR {
+
+template <typename LABEL>
+class ArenaBags;
+
+// Reference to one bag of an ArenaBags container. It stays valid while labels are inserted, but pointers and references
+// to labels do not.
+template <typename LABEL, bool IS_CONST>
+class ArenaBagReference {
+public:
+    using Label = LABEL;
+    using Bags = Meta::IF<IS_CONST, const ArenaBags<Label>, ArenaBags<Label>>;
+
+    ArenaBagReference(Bags& bags, const size_t bag) : bags(bags), bag(bag) {}
+
+    inline size_t size() const noexcept { return bags.slots[bag].size; }
+
+    inline bool empty() const noexcept { return size() == 0; }
+
+    inline const Label& operator[](const size_t i) const noexcept {
+        AssertMsg(i < size(), "Index " << i << " is out of range!");
+        return bags.labels[bags.slots[bag].begin + i];
+    }
+
+    inline const Label* begin() const noexcept { return bags.labels.data() + bags.slots[bag].begin; }
+
+    inline const Label* end() const noexcept { return begin() + size(); }
+
+    template <typename OTHER_LABEL>
+    inline bool dominates(const OTHER_LABEL& newLabel) const noexcept {
+        return bags.dominates(bag, newLabel.arrivalTime, newLabel.walkingDistance);
+    }
+
+    template <typename OTHER_LABEL, bool OTHER_IS_CONST>
+    inline bool dominates(const ArenaBagReference<OTHER_LABEL, OTHER_IS_CONST>& other) const noexcept {
+        for (const OTHER_LABEL& label : other) {
+            if (!dominates(label)) return false;
+        }
+        return true;
+    }
+
+    inline bool merge(const Label& newLabel) const noexcept {
+        static_assert(!IS_CONST, "Cannot modify a const bag!");
+        if (dominates(newLabel)) return false;
+        bags.mergeUndominated(bag, newLabel);
+        return true;
+    }
+
+    inline void mergeUndominated(const Label& newLabel) const noexcept {
+        static_assert(!IS_CONST, "Cannot modify a const bag!");
+        AssertMsg(!dominates(newLabel), "Trying to merge dominated label!");
+        bags.mergeUndominated(bag, newLabel);
+    }
+
+    // Appends a label that neither dominates nor is dominated by a label of the bag.
+    inline void append(const Label& newLabel) const noexcept {
+        static_assert(!IS_CONST, "Cannot modify a const bag!");
+        AssertMsg(!dominates(newLabel), "Trying to append dominated label!");
+        bags.append(bag, newLabel);
+    }
+
+private:
+    Bags& bags;
+    const size_t bag;
+};
+
+// Pareto bags with respect to arrival time and walking distance, which are stored together in one arena, such that
+// the bags of a round (or the best bags of a query) do not require individual allocations. The label type must provide
+// the members arrivalTime and walkingDistance, and a label dominates another label if it is not worse in both. Besides
+// the labels, the two criteria are stored as separate arrays, which are scanned in blocks of 8 labels with AVX2.
+// Every bag occupies a range of the arena whose capacity is a multiple of 8; if it is full, the bag is moved to a new
+// range with twice the capacity at the end of the arena. clear() resets only the bags that were used, and the memory
+// of the arena is kept for subsequent queries.
+template <typename LABEL>
+class ArenaBags {
+public:
+    using Label = LABEL;
+    using Type = ArenaBags<Label>;
+    using BagReference = ArenaBagReference<Label, false>;
+    using ConstBagReference = ArenaBagReference<Label, true>;
+    friend BagReference;
+    friend ConstBagReference;
+
+    inline static constexpr u_int32_t BlockSize = 8;
+
+private:
+    struct Slot {
+        Slot() : begin(0), size(0), capacity(0) {}
+        u_int32_t begin;
+        u_int32_t size;
+        u_int32_t capacity;
+    };
+
+public:
+    ArenaBags(const size_t numberOfBags = 0) : slots(numberOfBags), arenaSize(0) {}
+
+    inline size_t size() const noexcept { return slots.size(); }
+
+    inline BagReference operator[](const size_t bag) noexcept {
+        AssertMsg(bag < slots.size(), "Bag " << bag << " is out of range!");
+        return BagReference(*this, bag);
+    }
+
+    inline ConstBagReference operator[](const size_t bag) const noexcept {
+        AssertMsg(bag < slots.size(), "Bag " << bag << " is out of range!");
+        return ConstBagReference(*this, bag);
+    }
+
+    inline void clear() noexcept {
+        for (const u_int32_t bag : usedBags) {
+            slots[bag] = Slot();
+        }
+        usedBags.clear();
+        arenaSize = 0;
+    }
+
+    inline size_t numberOfLabels() const noexcept {
+        size_t result = 0;
+        for (const u_int32_t bag : usedBags) {
+            result += slots[bag].size;
+        }
+        return result;
+    }
+
+    inline long long byteSize() const noexcept {
+        return slots.capacity() * sizeof(Slot) + usedBags.capacity() * sizeof(u_int32_t)
+               + arrivalTimes.capacity() * sizeof(int) + walkingDistances.capacity() * sizeof(int)
+               + labels.capacity() * sizeof(Label);
+    }
+
+private:
+    inline bool dominates(const size_t bag, const int arrivalTime, const int walkingDistance) const noexcept {
+        const Slot& slot = slots[bag];
+        const int* arrivals = arrivalTimes.data() + slot.begin;
+        const int* distances = walkingDistances.data() + slot.begin;
+#if defined(USE_SIMD) && defined(__AVX2__)
+        const __m256i arrivalTimeBlock = _mm256_set1_epi32(arrivalTime);
+        const __m256i walkingDistanceBlock = _mm256_set1_epi32(walkingDistance);
+        for (u_int32_t i = 0; i < slot.size; i += BlockSize) {
+            const __m256i worseArrival =
+                _mm256_cmpgt_epi32(_mm256_load_si256(reinterpret_cast<const __m256i*>(arrivals + i)), arrivalTimeBlock);
+            const __m256i worseDistance = _mm256_cmpgt_epi32(
+                _mm256_load_si256(reinterpret_cast<const __m256i*>(distances + i)), walkingDistanceBlock);
+            const u_int32_t dominating =
+                ~_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_or_si256(worseArrival, worseDistance)))
+                & validLanes(slot.size - i);
+            if (dominating != 0) return true;
+        }
+        return false;
+#else
+        for (u_int32_t i = 0; i < slot.size; i++) {
+            if (arrivals[i] <= arrivalTime && distances[i] <= walkingDistance) return true;
+        }
+        return false;
+#endif
+    }
+
+    // Removes all labels that are dominated by the new label and appends it. The order of the remaining labels is
+    // kept, so the result is the same as for Bag::mergeUndominated().
+    inline void mergeUndominated(const size_t bag, const Label& newLabel) noexcept {
+        Slot& slot = slots[bag];
+        const int arrivalTime = newLabel.arrivalTime;
+        const int walkingDistance = newLabel.walkingDistance;
+        u_int32_t first = slot.size;
+#if defined(USE_SIMD) && defined(__AVX2__)
+        const __m256i arrivalTimeBlock = _mm256_set1_epi32(arrivalTime);
+        const __m256i walkingDistanceBlock = _mm256_set1_epi32(walkingDistance);
+        for (u_int32_t i = 0; i < slot.size; i += BlockSize) {
+            const __m256i betterArrival = _mm256_cmpgt_epi32(
+                arrivalTimeBlock, _mm256_load_si256(reinterpret_cast<const __m256i*>(&arrivalTimes[slot.begin + i])));
+            const __m256i betterDistance = _mm256_cmpgt_epi32(
+                walkingDistanceBlock,
+                _mm256_load_si256(reinterpret_cast<const __m256i*>(&walkingDistances[slot.begin + i])));
+            const u_int32_t dominated =
+                ~_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_or_si256(betterArrival, betterDistance)))
+                & validLanes(slot.size - i);
+            if (dominated != 0) {
+                first = i + __builtin_ctz(dominated);
+                break;
+            }
+        }
+#else
+        for (u_int32_t i = 0; i < slot.size; i++) {
+            if (arrivalTime <= arrivalTimes[slot.begin + i] && walkingDistance <= walkingDistances[slot.begin + i]) {
+                first = i;
+                break;
+            }
+        }
+#endif
+        if (first < slot.size) {
+            u_int32_t newSize = first;
+            for (u_int32_t i = first + 1; i < slot.size; i++) {
+                const u_int32_t from = slot.begin + i;
+                if (arrivalTime <= arrivalTimes[from] && walkingDistance <= walkingDistances[from]) continue;
+                const u_int32_t to = slot.begin + newSize;
+                arrivalTimes[to] = arrivalTimes[from];
+                walkingDistances[to] = walkingDistances[from];
+                labels[to] = labels[from];
+                newSize++;
+            }
+            slot.size = newSize;
+        }
+        append(bag, newLabel);
+    }
+
+    inline void append(const size_t bag, const Label& newLabel) noexcept {
+        Slot& slot = slots[bag];
+        if (slot.size == slot.capacity) grow(bag);
+        const u_int32_t index = slot.begin + slot.size;
+        arrivalTimes[index] = newLabel.arrivalTime;
+        walkingDistances[index] = newLabel.walkingDistance;
+        labels[index] = newLabel;
+        slot.size++;
+    }
+
+    inline void grow(const size_t bag) noexcept {
+        Slot& slot = slots[bag];
+        if (slot.capacity == 0) usedBags.emplace_back(bag);
+        const u_int32_t newCapacity = std::max(BlockSize, slot.capacity * 2);
+        const u_int32_t newBegin = arenaSize;
+        arenaSize += newCapacity;
+        if (arenaSize > labels.size()) {
+            const size_t newArenaCapacity = std::max<size_t>(arenaSize, labels.size() * 2);
+            arrivalTimes.resize(newArenaCapacity);
+            walkingDistances.resize(newArenaCapacity);
+            labels.resize(newArenaCapacity);
+        }
+        std::copy(arrivalTimes.begin() + slot.begin, arrivalTimes.begin() + slot.begin + slot.size,
+                  arrivalTimes.begin() + newBegin);
+        std::copy(walkingDistances.begin() + slot.begin, walkingDistances.begin() + slot.begin + slot.size,
+                  walkingDistances.begin() + newBegin);
+        std::copy(labels.begin() + slot.begin, labels.begin() + slot.begin + slot.size, labels.begin() + newBegin);
+        slot.begin = newBegin;
+        slot.capacity = newCapacity;
+    }
+
+    inline static u_int32_t validLanes(const u_int32_t remaining) noexcept {
+        return (remaining >= BlockSize) ? 0xFF : ((1u << remaining) - 1);
+    }
+
+private:
+    std::vector<Slot> slots;
+    std::vector<u_int32_t> usedBags;
+
+    size_t arenaSize;
+    std::vector<int, aligned_allocator<int, 32>> arrivalTimes;
+    std::vector<int, aligned_allocator<int, 32>> walkingDistances;
+    std::vector<Label> labels;
+};
+
+// Sequence of rounds of arena bags. The rounds of previous queries are kept and cleared when they are used again.
+template <typename LABEL>
+class ArenaBagRounds {
+public:
+    using Label = LABEL;
+    using Round = ArenaBags<Label>;
+    using Type = ArenaBagRounds<Label>;
+
+public:
+    ArenaBagRounds(const size_t numberOfBags = 0) : numberOfBags(numberOfBags), numberOfRounds(0) {}
+
+    inline size_t size() const noexcept { return numberOfRounds; }
+
+    inline bool empty() const noexcept { return numberOfRounds == 0; }
+
+    inline void emplace_back() noexcept {
+        if (numberOfRounds == rounds.size()) {
+            rounds.emplace_back(numberOfBags);
+        } else {
+            rounds[numberOfRounds].clear();
+        }
+        numberOfRounds++;
+    }
+
+    inline Round& back() noexcept {
+        AssertMsg(!empty(), "Cannot return current round, because no round exists!");
+        return rounds[numberOfRounds - 1];
+    }
+
+    inline Round& operator[](const size_t round) noexcept {
+        AssertMsg(round < numberOfRounds, "Round " << round << " is out of range!");
+        return rounds[round];
+    }
+
+    inline const Round& operator[](const size_t round) const noexcept {
+        AssertMsg(round < numberOfRounds, "Round " << round << " is out of range!");
+        return rounds[round];
+    }
+
+    inline void clear() noexcept { numberOfRounds = 0; }
+
+    // Releases all memory.
+    inline void reset() noexcept {
+        clear();
+        std::vector<Round>().swap(rounds);
+    }
+
+    inline long long byteSize() const noexcept {
+        long long result = 0;
+        for (const Round& round : rounds) {
+            result += round.byteSize();
+        }
+        return result;
+    }
+
+private:
+    size_t numberOfBags;
+    size_t numberOfRounds;
+    std::vector<Round> rounds;
+};
+
+} // namespace RAPTOR
@@ -0,0 +1,179 @@
+#pragma once
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+#include "../../../Helpers/Assert.h"
+
+namespace RAPTOR {
+
+// Per-round label storage of the RAPTOR variants, which is reused across queries. Labels that were not written in the
+// current query read as LABEL(). Only the labels of the current round (back()) can be modified.
+// Dense: The rounds are allocated once and kept. Each label carries a timestamp, such that clear() does not touch the
+// labels, and stale labels are reset lazily on the first write.
+// Sparse: Only the labels that are written in a round are stored. The labels of a stop are kept in a linked list
+// ordered by decreasing round, so the memory is proportional to the number of touched stops. References to labels are
+// only valid until the next label is inserted.
+template <typename LABEL, bool SPARSE = false>
+class Rounds {
+public:
+    using Label = LABEL;
+    static constexpr bool Sparse = SPARSE;
+    using Type = Rounds<Label, Sparse>;
+
+private:
+    inline static constexpr u_int32_t NoEntry = std::numeric_limits<u_int32_t>::max();
+
+    struct Slot {
+        Slot() : timestamp(0) {}
+        Label label;
+        u_int32_t timestamp;
+    };
+
+    // Index of the latest entry of a stop.
+    struct HeadSlot {
+        HeadSlot() : entry(NoEntry), timestamp(0) {}
+        u_int32_t entry;
+        u_int32_t timestamp;
+    };
+
+    struct Entry {
+        Entry(const u_int32_t round = 0, const u_int32_t next = NoEntry) : round(round), next(next) {}
+        Label label;
+        u_int32_t round;
+        u_int32_t next;
+    };
+
+public:
+    class RoundReference {
+    public:
+        RoundReference(Type& rounds, const size_t round) : rounds(rounds), round(round) {}
+        inline Label& operator[](const size_t stop) noexcept { return rounds.getMutable(round, stop); }
+
+    private:
+        Type& rounds;
+        const size_t round;
+    };
+
+    class ConstRoundReference {
+    public:
+        ConstRoundReference(const Type& rounds, const size_t round) : rounds(rounds), round(round) {}
+        inline const Label& operator[](const size_t stop) const noexcept { return rounds.get(round, stop); }
+
+    private:
+        const Type& rounds;
+        const size_t round;
+    };
+
+public:
+    Rounds(const size_t numberOfStops = 0) : numberOfStops(numberOfStops), numberOfRounds(0), timestamp(1) {
+        if constexpr (Sparse) heads.resize(numberOfStops);
+    }
+
+    inline size_t size() const noexcept { return numberOfRounds; }
+
+    inline bool empty() const noexcept { return numberOfRounds == 0; }
+
+    inline void emplace_back() noexcept {
+        if constexpr (!Sparse) {
+            if (numberOfRounds == rounds.size()) rounds.emplace_back(numberOfStops);
+        }
+        numberOfRounds++;
+    }
+
+    inline RoundReference back() noexcept {
+        AssertMsg(!empty(), "Cannot return current round, because no round exists!");
+        return RoundReference(*this, numberOfRounds - 1);
+    }
+
+    inline ConstRoundReference operator[](const size_t round) const noexcept {
+        AssertMsg(round < numberOfRounds, "Round " << round << " is out of range!");
+        return ConstRoundReference(*this, round);
+    }
+
+    inline void clear() noexcept {
+        numberOfRounds = 0;
+        if constexpr (Sparse) entries.clear();
+        if (timestamp == std::numeric_limits<u_int32_t>::max()) [[unlikely]] {
+            if constexpr (Sparse) {
+                std::fill(heads.begin(), heads.end(), HeadSlot());
+            } else {
+                for (std::vector<Slot>& round : rounds) {
+                    std::fill(round.begin(), round.end(), Slot());
+                }
+            }
+            timestamp = 0;
+        }
+        ++timestamp;
+    }
+
+    // Releases all memory.
+    inline void reset() noexcept {
+        clear();
+        std::vector<std::vector<Slot>>().swap(rounds);
+        std::vector<Entry>().swap(entries);
+    }
+
+    inline long long byteSize() const noexcept {
+        long long result = heads.capacity() * sizeof(HeadSlot) + entries.capacity() * sizeof(Entry);
+        for (const std::vector<Slot>& round : rounds) {
+            result += round.capacity() * sizeof(Slot);
+        }
+        return result;
+    }
+
+private:
+    inline const Label& get(const size_t round, const size_t stop) const noexcept {
+        AssertMsg(stop < numberOfStops, "Stop " << stop << " is out of range!");
+        if constexpr (Sparse) {
+            if (heads[stop].timestamp != timestamp) return defaultLabel;
+            u_int32_t entry = heads[stop].entry;
+            while (entry != NoEntry && entries[entry].round > round) {
+                entry = entries[entry].next;
+            }
+            return (entry != NoEntry && entries[entry].round == round) ? entries[entry].label : defaultLabel;
+        } else {
+            const Slot& slot = rounds[round][stop];
+            return (slot.timestamp == timestamp) ? slot.label : defaultLabel;
+        }
+    }
+
+    inline Label& getMutable(const size_t round, const size_t stop) noexcept {
+        AssertMsg(stop < numberOfStops, "Stop " << stop << " is out of range!");
+        AssertMsg(round + 1 == numberOfRounds, "Only the current round can be modified!");
+        if constexpr (Sparse) {
+            HeadSlot& head = heads[stop];
+            if (head.timestamp != timestamp) {
+                head.timestamp = timestamp;
+                head.entry = NoEntry;
+            }
+            if (head.entry == NoEntry || entries[head.entry].round != round) {
+                entries.emplace_back(round, head.entry);
+                head.entry = entries.size() - 1;
+            }
+            return entries[head.entry].label;
+        } else {
+            Slot& slot = rounds[round][stop];
+            if (slot.timestamp != timestamp) {
+                slot.label = Label();
+                slot.timestamp = timestamp;
+            }
+            return slot.label;
+        }
+    }
+
+private:
+    size_t numberOfStops;
+    size_t numberOfRounds;
+    u_int32_t timestamp;
+
+    std::vector<std::vector<Slot>> rounds;
+
+    std::vector<HeadSlot> heads;
+    std::vector<Entry> entries;
+
+    Label defaultLabel;
+};
+
+} // namespace RAPTOR
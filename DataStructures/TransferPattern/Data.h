@@ -3,12 +3,13 @@
 #include <algorithm>
 #include <vector>
 
+#include "../../Algorithms/RAPTOR/TripSearch.h"
 #include "../../Helpers/Console/Progress.h"
 #include "../RAPTOR/Data.h"
 #include "../RAPTOR/Entities/RouteSegment.h"
 #include "../RAPTOR/Entities/StopEvent.h"
+#include "Entities/CompactTransferPatterns.h"
 #include "Entities/Lookups.h"
-#include "Entities/LowerBound.h"
 
 namespace TransferPattern {
 
@@ -18,60 +19,33 @@ public:
 
     Data(const RAPTOR::Data& data)
         : raptorData(data),
-          lineLookup(data.numberOfRoutes()),
           stopLookup(data.numberOfStops()),
           firstTripIdOfLine(data.numberOfRoutes() + 1, noTripId),
-          transferPatternOfStop(data.numberOfStops()),
-          lowerBounds(data.numberOfStops()) {
-        // fill all the lowerBounds with enough space
-        for (size_t stop(0); stop < data.numberOfStops(); ++stop) {
-            lowerBounds[stop].resize(data.numberOfStops());
-        }
-
-        buildLineLookup();
+          transferPatternOfStop(data.numberOfStops()) {
+        buildDirectConnectionLookup();
         buildStopLookup();
+        buildMinRideTimes();
     }
 
-    Data(const std::string& fileName) { deserialize(fileName); }
+    Data(const std::string& fileName, const bool useCompactTransferPatterns = false) {
+        deserialize(fileName, useCompactTransferPatterns);
+    }
 
 private:
-    inline void buildLineLookup(const bool verbose = true) {
+    // Direct connections are evaluated on the transposed departure times of the RAPTOR data, which store the departure
+    // times of all trips of a route at the same stop contiguously. The transposed times are not serialized.
+    inline void buildDirectConnectionLookup(const bool verbose = true) {
         if (verbose) std::cout << "Building the Direct-Connection-Lookup Datastructure" << std::endl;
 
-        Progress progress(raptorData.numberOfRoutes());
-
-        lineLookup.assign(raptorData.numberOfRoutes(), {});
+        raptorData.buildTransposedDepartureTimes();
         firstTripIdOfLine.assign(raptorData.numberOfRoutes() + 1, noTripId);
 
         TripId currentFirstTripId(0);
-        size_t currentNumberOfTrips = 0;
-        size_t currentNumberOfStopsInRoute = 0;
-
         for (const RouteId route : raptorData.routes()) {
-            currentNumberOfTrips = raptorData.numberOfTripsInRoute(route);
-            currentNumberOfStopsInRoute = raptorData.numberOfStopsInRoute(route);
-
-            std::vector<RAPTOR::StopEvent> reserveVector(currentNumberOfTrips);
-            lineLookup[route].stopsAlongLine.assign(currentNumberOfStopsInRoute, reserveVector);
-
             firstTripIdOfLine[route] = currentFirstTripId;
-            currentFirstTripId += currentNumberOfTrips;
-
-            for (size_t tripIndex(0); tripIndex < currentNumberOfTrips; ++tripIndex) {
-                size_t stopsOfRouteIndex(0);
-                for (auto stopEvent : raptorData.stopEventsOfTrip(route, tripIndex)) {
-                    AssertMsg(tripIndex < lineLookup[route].stopsAlongLine[stopsOfRouteIndex].halts.size(),
-                              "TripIndex is too big for the halts vector!");
-                    lineLookup[route].stopsAlongLine[stopsOfRouteIndex].halts[tripIndex] = stopEvent;
-                    ++stopsOfRouteIndex;
-                }
-            }
-            ++progress;
+            currentFirstTripId += raptorData.numberOfTripsInRoute(route);
         }
-
         firstTripIdOfLine[raptorData.numberOfRoutes()] = currentFirstTripId;
-
-        progress.finished();
     }
 
     inline void buildStopLookup(const bool verbose = true) {
@@ -98,36 +72,64 @@ private:
         progress.finished();
     }
 
-public:
-    inline void assignLowerBounds(const StopId stop, const std::vector<int>& bestTravelTimes,
-                                  const std::vector<uint8_t>& bestMinNumberOfTrips) {
-        AssertMsg(raptorData.isStop(stop), "Stop is not a valid stop!");
-        AssertMsg(bestTravelTimes.size() == raptorData.numberOfStops(),
-                  "BestTravelTimes has not the right amount of elements!");
-        AssertMsg(bestMinNumberOfTrips.size() == raptorData.numberOfStops(),
-                  "BestMinNumberOfTrips has not the right amount of elements!");
-
-        for (size_t i(0); i < raptorData.numberOfStops(); ++i) {
-            AssertMsg(stop < lowerBounds[i].travelTimes.size(), "Size is not correct!");
-            AssertMsg(stop < lowerBounds[i].numberOfTrips.size(), "Size is not correct!");
-
-            lowerBounds[i].travelTimes[stop] = bestTravelTimes[i];
-            lowerBounds[i].numberOfTrips[stop] = bestMinNumberOfTrips[i];
+    // For every stop of a route, the sum of the minimum differences between the arrival times of consecutive stops
+    // (minArrivalOffset), and this sum minus the minimum dwell time at the stop (maxDepartureOffset). Every trip of the
+    // route satisfies arrival(b) - departure(a) >= minArrivalOffset(b) - maxDepartureOffset(a). Dwell times can be
+    // negative, since implicit buffer times move the departure before the arrival.
+    inline void buildMinRideTimes() {
+        minArrivalOffset.assign(raptorData.stopIds.size(), 0);
+        maxDepartureOffset.assign(raptorData.stopIds.size(), 0);
+        for (const RouteId route : raptorData.routes()) {
+            const size_t numberOfStops = raptorData.numberOfStopsInRoute(route);
+            const size_t numberOfTrips = raptorData.numberOfTripsInRoute(route);
+            const RAPTOR::StopEvent* firstTrip = raptorData.firstTripOfRoute(route);
+            int* arrivalOffsets = &minArrivalOffset[raptorData.firstStopIdOfRoute[route]];
+            int* departureOffsets = &maxDepartureOffset[raptorData.firstStopIdOfRoute[route]];
+            for (size_t stopIndex = 0; stopIndex < numberOfStops; ++stopIndex) {
+                int minHopTime = INFTY;
+                int minDwellTime = INFTY;
+                for (size_t trip = 0; trip < numberOfTrips; ++trip) {
+                    const RAPTOR::StopEvent* stopEvents = firstTrip + trip * numberOfStops;
+                    const RAPTOR::StopEvent& stopEvent = stopEvents[stopIndex];
+                    if (stopIndex > 0) {
+                        const int hopTime = stopEvent.arrivalTime - stopEvents[stopIndex - 1].arrivalTime;
+                        minHopTime = std::min(minHopTime, hopTime);
+                    }
+                    minDwellTime = std::min(minDwellTime, stopEvent.arrivalTime - stopEvent.departureTime);
+                }
+                if (stopIndex > 0) arrivalOffsets[stopIndex] = arrivalOffsets[stopIndex - 1] + minHopTime;
+                departureOffsets[stopIndex] = arrivalOffsets[stopIndex] - minDwellTime;
+            }
         }
     }
 
-    inline int getLowerBoundTravelTime(const StopId target, const StopId u) {
-        AssertMsg(raptorData.isStop(target), "Target is not a stop!");
-        AssertMsg(raptorData.isStop(u), "Stop u is not a stop!");
-
-        return lowerBounds[target].travelTimes[u];
-    }
-
-    inline int getLowerBoundNumberOfTrips(const StopId target, const StopId u) {
-        AssertMsg(raptorData.isStop(target), "Target is not a stop!");
-        AssertMsg(raptorData.isStop(u), "Stop u is not a stop!");
-
-        return lowerBounds[target].numberOfTrips[u];
+public:
+    // Lower bound on the time between boarding a trip at one stop and leaving it at the other, or INFTY if no route
+    // serves both in this order.
+    inline int getMinRideTime(const StopId from, const StopId to) const {
+        AssertMsg(raptorData.isStop(from), "From " << from << " is not a valid stop!");
+        AssertMsg(raptorData.isStop(to), "To " << to << " is not a valid stop!");
+
+        const std::vector<RAPTOR::RouteSegment>& fromLookup = stopLookup[from].incidentLines;
+        const std::vector<RAPTOR::RouteSegment>& toLookup = stopLookup[to].incidentLines;
+
+        int result = INFTY;
+        size_t i(0);
+        size_t j(0);
+        while (i < fromLookup.size() && j < toLookup.size()) {
+            if (fromLookup[i].routeId == toLookup[j].routeId && fromLookup[i].stopIndex < toLookup[j].stopIndex) {
+                const size_t firstStopId = raptorData.firstStopIdOfRoute[fromLookup[i].routeId];
+                result = std::min(result, minArrivalOffset[firstStopId + toLookup[j].stopIndex]
+                                              - maxDepartureOffset[firstStopId + fromLookup[i].stopIndex]);
+                // The next occurrence of the from stop in the same route may pair with the same to stop.
+                ++i;
+            } else if (fromLookup[i] < toLookup[j]) {
+                ++i;
+            } else {
+                ++j;
+            }
+        }
+        return std::max(result, 0);
     }
 
     inline RAPTOR::StopEvent getStopEvent(const RouteId routeId = noRouteId, const size_t tripIndex = (size_t)-1,
@@ -137,7 +139,7 @@ public:
         AssertMsg(StopIndex(0) <= stopIndex && stopIndex < StopIndex(raptorData.numberOfStopsInRoute(routeId)),
                   "StopIndex is out of bounds!");
 
-        return lineLookup[routeId].stopsAlongLine[stopIndex].halts[tripIndex];
+        return raptorData.tripOfRoute(routeId, tripIndex)[stopIndex];
     }
 
     inline int getArrivalTime(const RouteId routeId = noRouteId, const size_t tripIndex = (size_t)-1,
@@ -153,12 +155,50 @@ public:
     inline size_t earliestTripIndexOfLineByStopIndex(const StopIndex stopIndex, const RouteId route,
                                                      const int departureTime = 0) const {
         AssertMsg(raptorData.isRoute(route), "Route is not a route!");
+        AssertMsg(raptorData.hasTransposedDepartureTimes(), "The direct-connection lookup has not been built!");
 
-        for (size_t tripIndex(0); tripIndex < raptorData.numberOfTripsInRoute(route); ++tripIndex) {
-            if (getDepartureTime(route, tripIndex, stopIndex) >= departureTime) return tripIndex;
-        }
+        const size_t numberOfTrips = raptorData.numberOfTripsInRoute(route);
+        const int* departureTimes = raptorData.transposedDepartureTimesOfRoute(route) + (stopIndex * numberOfTrips);
+        const size_t tripIndex = RAPTOR::findFirstReachableTripInSortedColumn(departureTimes, numberOfTrips,
+                                                                              departureTime);
+        return (tripIndex < numberOfTrips) ? tripIndex : (size_t)-1;
+    }
 
-        return (size_t)-1;
+    // Returns the route and arrival time of the earliest trip from one stop to the other that departs at or after the
+    // given time, or (noRouteId, INFTY) if there is none. The routes serving both stops are found by merging the
+    // sorted incident routes of the two stops.
+    inline std::pair<RouteId, int> earliestDirectConnection(const StopId from, const StopId to,
+                                                            const int departureTime) const {
+        AssertMsg(raptorData.isStop(from), "From " << from << " is not a valid stop!");
+        AssertMsg(raptorData.isStop(to), "To " << to << " is not a valid stop!");
+
+        const std::vector<RAPTOR::RouteSegment>& fromLookup = stopLookup[from].incidentLines;
+        const std::vector<RAPTOR::RouteSegment>& toLookup = stopLookup[to].incidentLines;
+
+        AssertMsg(std::is_sorted(fromLookup.begin(), fromLookup.end()), "StopLookup of From is not sorted!");
+        AssertMsg(std::is_sorted(toLookup.begin(), toLookup.end()), "StopLookup of To is not sorted!");
+
+        std::pair<RouteId, int> result = std::make_pair(noRouteId, INFTY);
+        size_t i(0);
+        size_t j(0);
+        while (i < fromLookup.size() && j < toLookup.size()) {
+            if (fromLookup[i].routeId == toLookup[j].routeId && fromLookup[i].stopIndex < toLookup[j].stopIndex) {
+                const RouteId route = fromLookup[i].routeId;
+                const size_t tripIndex = earliestTripIndexOfLineByStopIndex(fromLookup[i].stopIndex, route,
+                                                                            departureTime);
+                if (tripIndex != (size_t)-1) {
+                    const int arrivalTime = getArrivalTime(route, tripIndex, toLookup[j].stopIndex);
+                    if (arrivalTime < result.second) result = std::make_pair(route, arrivalTime);
+                }
+                ++i;
+                ++j;
+            } else if (fromLookup[i] < toLookup[j]) {
+                ++i;
+            } else {
+                ++j;
+            }
+        }
+        return result;
     }
 
     inline TripId tripIdOfLineByTripIndex(const RouteId route = noRouteId, const size_t tripIndex = 0) {
@@ -195,12 +235,15 @@ public:
     }
 
     inline long long byteSize() const noexcept {
-        long long result = Vector::byteSize(lineLookup);
-        result += Vector::byteSize(stopLookup);
+        long long result = Vector::byteSize(stopLookup);
+        result += Vector::byteSize(firstTripIdOfLine);
+        result += Vector::byteSize(minArrivalOffset);
+        result += Vector::byteSize(maxDepartureOffset);
         result += raptorData.byteSize();
 
         for (size_t stop(0); stop < transferPatternOfStop.size(); ++stop)
             result += transferPatternOfStop[stop].byteSize();
+        result += compactTransferPatterns.byteSize();
 
         return result;
     }
@@ -212,36 +255,80 @@ public:
         raptorData.printInfo();
 
         std::cout << "Info about Transfer Pattern:" << std::endl;
+        if (!compactTransferPatterns.empty()) {
+            std::cout << "   Compact # of nodes:       " << std::setw(12)
+                      << String::prettyInt(compactTransferPatterns.numberOfNodes()) << std::endl;
+            std::cout << "   Compact # of entries:     " << std::setw(12)
+                      << String::prettyInt(compactTransferPatterns.numberOfEntries()) << std::endl;
+        }
         printStatsAboutTP();
         std::cout << "   Storage usage of all TP:  " << std::setw(12) << String::bytesToString(byteSize()) << std::endl;
     }
 
     inline void serialize(const std::string& fileName) {
-        raptorData.serialize(fileName + ".raptor");
-        IO::serialize(fileName, lineLookup, stopLookup, firstTripIdOfLine, lowerBounds);
+        serializeWithoutTransferPatterns(fileName);
         IO::serialize(fileName + ".transferPattern", transferPatternOfStop);
     }
 
-    inline void deserialize(const std::string& fileName) {
+    // For transfer patterns that were streamed to fileName.transferPattern during preprocessing.
+    inline void serializeWithoutTransferPatterns(const std::string& fileName) {
+        raptorData.serialize(fileName + ".raptor");
+        IO::serialize(fileName, stopLookup, firstTripIdOfLine);
+    }
+
+    inline void deserialize(const std::string& fileName, const bool useCompactTransferPatterns = false) {
         raptorData.deserialize(fileName + ".raptor");
-        IO::deserialize(fileName, lineLookup, stopLookup, firstTripIdOfLine, lowerBounds);
+        IO::deserialize(fileName, stopLookup, firstTripIdOfLine);
+        raptorData.buildTransposedDepartureTimes();
+        buildMinRideTimes();
+
+        if (useCompactTransferPatterns) {
+            std::cout << "Mapping compact transfer patterns from " << fileName << ".compactTransferPattern!"
+                      << std::endl;
+            compactTransferPatterns.deserialize(fileName + ".compactTransferPattern");
+            AssertMsg(compactTransferPatterns.numberOfStops() == raptorData.numberOfStops(),
+                      "Compact transfer patterns do not match the network!");
+            transferPatternOfStop.clear();
+        } else {
+            std::cout << "Loading all transfer patterns from " << fileName << ".transferPattern!" << std::endl;
+            IO::deserialize(fileName + ".transferPattern", transferPatternOfStop);
+        }
+    }
 
-        std::cout << "Loading all transfer patterns from " << fileName << ".transferPattern!" << std::endl;
-        IO::deserialize(fileName + ".transferPattern", transferPatternOfStop);
+    // Merges the transfer patterns of all stops into the compact representation, which is written to
+    // fileName.compactTransferPattern.
+    inline void serializeCompactTransferPatterns(const std::string& fileName) const {
+        CompactTransferPatternBuilder builder(raptorData.numberOfStops());
+        Progress progress(transferPatternOfStop.size());
+        for (const StopId stop : raptorData.stops()) {
+            builder.addPatternOfStop(stop, transferPatternOfStop[stop]);
+            ++progress;
+        }
+        progress.finished();
+        const CompactTransferPatterns patterns = builder.build();
+        std::cout << "   Number of nodes:          " << std::setw(12) << String::prettyInt(patterns.numberOfNodes())
+                  << std::endl;
+        std::cout << "   Number of entries:        " << std::setw(12) << String::prettyInt(patterns.numberOfEntries())
+                  << std::endl;
+        std::cout << "   Storage usage:            " << std::setw(12) << String::bytesToString(patterns.byteSize())
+                  << std::endl;
+        patterns.serialize(fileName + ".compactTransferPattern");
     }
 
 public:
     RAPTOR::Data raptorData;
 
-    std::vector<LookupOfLine> lineLookup;
     std::vector<StopLookup> stopLookup;
     std::vector<TripId> firstTripIdOfLine;
+    std::vector<int> minArrivalOffset;
+    std::vector<int> maxDepartureOffset;
 
     // StaticDAGTransferPattern holds ViaVertex == points to the correct StopId
     // and holds TravelTime == if negative, the edge is a trip edge
     std::vector<StaticDAGTransferPattern> transferPatternOfStop;
 
-    std::vector<LowerBound> lowerBounds;
+    // Alternative to transferPatternOfStop, mapped from disk (see Entities/CompactTransferPatterns.h)
+    CompactTransferPatterns compactTransferPatterns;
 };
 
 } // namespace TransferPattern
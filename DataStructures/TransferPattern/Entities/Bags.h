@@ -42,7 +42,13 @@ public:
 
     inline int getKey() const noexcept { return front().getKey(); }
 
-    inline bool hasSmallerKey(const DijkstraBag* const other) const noexcept { return getKey() < other->getKey(); }
+    // Bags with equal keys are ordered by their position, i.e., by their stop. This makes the order in which labels are
+    // settled independent of the order of the edges in the query graph.
+    inline bool hasSmallerKey(const DijkstraBag* const other) const noexcept {
+        if (front().hasSmallerKey(&other->front())) return true;
+        if (other->front().hasSmallerKey(&front())) return false;
+        return this < other;
+    }
 
     inline const DijkstraLabel& extractFront() noexcept {
         AssertMsg(!empty(), "An empty heap has no front!");
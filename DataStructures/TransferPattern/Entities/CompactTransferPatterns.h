@@ -0,0 +1,312 @@
+#pragma once
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../../../Helpers/Assert.h"
+#include "../../../Helpers/FileSystem/FileSystem.h"
+#include "../../../Helpers/Types.h"
+#include "../../Graph/Graph.h"
+
+namespace TransferPattern {
+
+// The transfer patterns of all source stops in one node table. The DAG of a source stop is a trie of journey
+// prefixes (see TransferPatternBuilder), read in forward direction. A node is given by its via stop, its children and
+// the targets whose journeys end with a leg from the node. Identical nodes are stored only once (hash-consing), so the
+// subtries of journey suffixes towards hub stops are shared between all source stops that use them.
+//
+// A child or target entry is a packed 64-bit value: the node id or target stop in the lower half, and the travel time
+// of the leg, as stored in the DAG, in the upper half (-1 if the leg uses a route). Keeping the travel time makes the
+// representation lossless. Every node has a 64-bit signature of the targets that can be reached from it, which lets
+// the decoder skip subtries.
+//
+// The file layout is the in-memory layout, so a file can be mapped into memory instead of being read:
+//     header (8 x u64), signatures (u64 per node), entries (u64), roots (u32 per stop), via stops (u32 per node),
+//     first entry (u32 per node + 1), first target entry (u32 per node)
+class CompactTransferPatterns {
+public:
+    using Entry = u_int64_t;
+    using Signature = u_int64_t;
+
+    static constexpr u_int64_t Magic = 0x5450434f4d504354ull;
+    static constexpr u_int64_t Version = 2;
+    static constexpr size_t HeaderSize = 8;
+
+    inline static Entry packEntry(const size_t id, const int travelTime) noexcept {
+        return (Entry(u_int32_t(travelTime)) << 32) | Entry(u_int32_t(id));
+    }
+
+    inline static size_t idOf(const Entry entry) noexcept { return u_int32_t(entry); }
+
+    inline static int travelTimeOf(const Entry entry) noexcept { return int32_t(u_int32_t(entry >> 32)); }
+
+    inline static Signature signatureOf(const StopId stop) noexcept { return Signature(1) << (size_t(stop) & 63); }
+
+public:
+    CompactTransferPatterns() { setViews(nullptr); }
+
+    CompactTransferPatterns(const size_t numberOfStops, const std::vector<u_int32_t>& rootOfStop,
+                            const std::vector<StopId>& viaStopOfNode, const std::vector<u_int32_t>& firstEntryOfNode,
+                            const std::vector<u_int32_t>& firstTargetOfNode,
+                            const std::vector<Signature>& signatureOfNode, const std::vector<Entry>& entries) {
+        const size_t numberOfNodes = viaStopOfNode.size();
+        AssertMsg(rootOfStop.size() == numberOfStops, "Wrong number of roots!");
+        AssertMsg(firstEntryOfNode.size() == numberOfNodes + 1, "Wrong number of entry offsets!");
+        AssertMsg(firstTargetOfNode.size() == numberOfNodes, "Wrong number of target offsets!");
+        AssertMsg(signatureOfNode.size() == numberOfNodes, "Wrong number of signatures!");
+        storage.assign(numberOfWords(numberOfStops, numberOfNodes, entries.size()), 0);
+        storage[0] = Magic;
+        storage[1] = Version;
+        storage[2] = numberOfStops;
+        storage[3] = numberOfNodes;
+        storage[4] = entries.size();
+        setViews(storage.data());
+        std::copy(signatureOfNode.begin(), signatureOfNode.end(), const_cast<Signature*>(signatures));
+        std::copy(entries.begin(), entries.end(), const_cast<Entry*>(entryArray));
+        std::copy(rootOfStop.begin(), rootOfStop.end(), const_cast<u_int32_t*>(roots));
+        for (size_t node = 0; node < numberOfNodes; node++) {
+            const_cast<u_int32_t*>(viaStops)[node] = viaStopOfNode[node];
+        }
+        std::copy(firstEntryOfNode.begin(), firstEntryOfNode.end(), const_cast<u_int32_t*>(firstEntries));
+        std::copy(firstTargetOfNode.begin(), firstTargetOfNode.end(), const_cast<u_int32_t*>(firstTargets));
+    }
+
+    CompactTransferPatterns(const std::string& fileName) {
+        setViews(nullptr);
+        deserialize(fileName);
+    }
+
+    CompactTransferPatterns(const CompactTransferPatterns&) = delete;
+    CompactTransferPatterns& operator=(const CompactTransferPatterns&) = delete;
+
+    CompactTransferPatterns(CompactTransferPatterns&& other) noexcept { *this = std::move(other); }
+
+    CompactTransferPatterns& operator=(CompactTransferPatterns&& other) noexcept {
+        if (this == &other) return *this;
+        unmap();
+        storage = std::move(other.storage);
+        mapping = other.mapping;
+        mappingSize = other.mappingSize;
+        setViews(mapping ? static_cast<const u_int64_t*>(mapping) : (storage.empty() ? nullptr : storage.data()));
+        other.mapping = nullptr;
+        other.mappingSize = 0;
+        other.setViews(nullptr);
+        return *this;
+    }
+
+    ~CompactTransferPatterns() { unmap(); }
+
+public:
+    inline bool empty() const noexcept { return header == nullptr; }
+
+    inline size_t numberOfStops() const noexcept { return header ? header[2] : 0; }
+
+    inline size_t numberOfNodes() const noexcept { return header ? header[3] : 0; }
+
+    inline size_t numberOfEntries() const noexcept { return header ? header[4] : 0; }
+
+    inline u_int32_t rootOfStop(const StopId stop) const noexcept {
+        AssertMsg(size_t(stop) < numberOfStops(), "Stop " << stop << " is out of bounds!");
+        return roots[stop];
+    }
+
+    inline StopId viaStopOfNode(const size_t node) const noexcept { return StopId(viaStops[node]); }
+
+    inline Signature signatureOfNode(const size_t node) const noexcept { return signatures[node]; }
+
+    // Children of the node, i.e., journey prefixes that extend the node by one leg.
+    inline const Entry* beginChildren(const size_t node) const noexcept { return entryArray + firstEntries[node]; }
+
+    inline const Entry* endChildren(const size_t node) const noexcept { return entryArray + firstTargets[node]; }
+
+    // Targets whose journeys end with a leg from the node.
+    inline const Entry* beginTargets(const size_t node) const noexcept { return entryArray + firstTargets[node]; }
+
+    inline const Entry* endTargets(const size_t node) const noexcept { return entryArray + firstEntries[node + 1]; }
+
+    inline long long byteSize() const noexcept {
+        return sizeof(u_int64_t) * numberOfWords(numberOfStops(), numberOfNodes(), numberOfEntries());
+    }
+
+    inline bool isMapped() const noexcept { return mapping != nullptr; }
+
+    inline void serialize(const std::string& fileName) const noexcept {
+        AssertMsg(!empty(), "There are no transfer patterns to serialize!");
+        std::ofstream os(FileSystem::ensureDirectoryExists(fileName), std::ios::binary);
+        Ensure(os, "cannot open file: " << fileName);
+        os.write(reinterpret_cast<const char*>(header), byteSize());
+    }
+
+    // Maps the file into memory, the pages are only loaded once the query accesses them.
+    inline void deserialize(const std::string& fileName) noexcept {
+        unmap();
+        storage.clear();
+        setViews(nullptr);
+        const int file = open(fileName.c_str(), O_RDONLY);
+        Ensure(file >= 0, "cannot open file: " << fileName);
+        struct stat fileStatus;
+        Ensure(fstat(file, &fileStatus) == 0, "cannot read the size of file: " << fileName);
+        Ensure(size_t(fileStatus.st_size) >= HeaderSize * sizeof(u_int64_t), "File " << fileName << " is too small!");
+        mappingSize = fileStatus.st_size;
+        mapping = mmap(nullptr, mappingSize, PROT_READ, MAP_SHARED, file, 0);
+        close(file);
+        Ensure(mapping != MAP_FAILED, "cannot map file: " << fileName);
+        const u_int64_t* words = static_cast<const u_int64_t*>(mapping);
+        Ensure(words[0] == Magic, "File " << fileName << " does not contain compact transfer patterns!");
+        Ensure(words[1] == Version, "File " << fileName << " has version " << words[1] << ", expected " << Version);
+        Ensure(sizeof(u_int64_t) * numberOfWords(words[2], words[3], words[4]) == mappingSize,
+               "File " << fileName << " has the wrong size!");
+        setViews(words);
+    }
+
+private:
+    inline static size_t numberOfWords(const size_t stops, const size_t nodes, const size_t entries) noexcept {
+        const size_t numberOfU32 = stops + nodes + (nodes + 1) + nodes;
+        return HeaderSize + nodes + entries + (numberOfU32 + 1) / 2;
+    }
+
+    inline void setViews(const u_int64_t* words) noexcept {
+        header = words;
+        if (!words) {
+            signatures = nullptr;
+            roots = viaStops = firstEntries = firstTargets = nullptr;
+            entryArray = nullptr;
+            return;
+        }
+        const size_t nodes = words[3];
+        signatures = words + HeaderSize;
+        entryArray = signatures + nodes;
+        roots = reinterpret_cast<const u_int32_t*>(entryArray + words[4]);
+        viaStops = roots + words[2];
+        firstEntries = viaStops + nodes;
+        firstTargets = firstEntries + nodes + 1;
+    }
+
+    inline void unmap() noexcept {
+        if (!mapping) return;
+        munmap(mapping, mappingSize);
+        mapping = nullptr;
+        mappingSize = 0;
+    }
+
+private:
+    std::vector<u_int64_t> storage;
+    void* mapping = nullptr;
+    size_t mappingSize = 0;
+
+    const u_int64_t* header;
+    const Signature* signatures;
+    const u_int32_t* roots;
+    const u_int32_t* viaStops;
+    const u_int32_t* firstEntries;
+    const u_int32_t* firstTargets;
+    const Entry* entryArray;
+};
+
+// Collects the nodes of all transfer pattern DAGs and merges identical ones.
+class CompactTransferPatternBuilder {
+private:
+    struct KeyHasher {
+        inline size_t operator()(const std::vector<u_int64_t>& key) const noexcept {
+            size_t seed = key.size();
+            for (const u_int64_t value : key) {
+                seed ^= std::hash<u_int64_t>{}(value) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+            }
+            return seed;
+        }
+    };
+
+public:
+    CompactTransferPatternBuilder(const size_t numberOfStops)
+        : numberOfStops(numberOfStops), rootOfStop(numberOfStops, -1), firstEntryOfNode(1, 0) {}
+
+    inline void addPatternOfStop(const StopId source, const StaticDAGTransferPattern& dag) noexcept {
+        AssertMsg(size_t(source) < numberOfStops, "Stop " << source << " is out of bounds!");
+        AssertMsg(dag.numVertices() >= numberOfStops, "The DAG of stop " << source << " has too few vertices!");
+        children.assign(dag.numVertices(), {});
+        targets.assign(dag.numVertices(), {});
+        for (const Vertex from : dag.vertices()) {
+            for (const Edge edge : dag.edgesFrom(from)) {
+                const Vertex to = dag.get(ToVertex, edge);
+                const int travelTime = dag.get(TravelTime, edge);
+                if (from < numberOfStops) {
+                    targets[to].emplace_back(CompactTransferPatterns::packEntry(from, travelTime));
+                } else {
+                    children[to].emplace_back(from, travelTime);
+                }
+            }
+        }
+        rootOfStop[source] = addNode(dag, Vertex(source));
+    }
+
+    inline CompactTransferPatterns build() const noexcept {
+        for (size_t stop = 0; stop < numberOfStops; stop++) {
+            AssertMsg(rootOfStop[stop] != u_int32_t(-1), "The pattern of stop " << stop << " is missing!");
+        }
+        return CompactTransferPatterns(numberOfStops, rootOfStop, viaStopOfNode, firstEntryOfNode, firstTargetOfNode,
+                                       signatureOfNode, entries);
+    }
+
+    inline size_t numberOfNodes() const noexcept { return viaStopOfNode.size(); }
+
+private:
+    // Children are added before their parent, so the ids of the children are known when the key of the parent is
+    // built. The depth of the recursion is the number of legs of the longest journey.
+    inline u_int32_t addNode(const StaticDAGTransferPattern& dag, const Vertex vertex) noexcept {
+        std::vector<u_int64_t> key;
+        key.emplace_back(dag.get(ViaVertex, vertex));
+        key.emplace_back(children[vertex].size());
+        CompactTransferPatterns::Signature signature = 0;
+        for (const std::pair<Vertex, int>& child : children[vertex]) {
+            const u_int32_t childNode = addNode(dag, child.first);
+            key.emplace_back(CompactTransferPatterns::packEntry(childNode, child.second));
+            signature |= signatureOfNode[childNode];
+        }
+        for (const CompactTransferPatterns::Entry target : targets[vertex]) {
+            signature |= CompactTransferPatterns::signatureOf(StopId(CompactTransferPatterns::idOf(target)));
+        }
+        std::sort(key.begin() + 2, key.end());
+        std::vector<CompactTransferPatterns::Entry> sortedTargets(targets[vertex]);
+        std::sort(sortedTargets.begin(), sortedTargets.end());
+        key.insert(key.end(), sortedTargets.begin(), sortedTargets.end());
+
+        const auto node = nodeOfKey.find(key);
+        if (node != nodeOfKey.end()) return node->second;
+
+        const u_int32_t newNode = viaStopOfNode.size();
+        AssertMsg(newNode < u_int32_t(-1), "Too many nodes!");
+        viaStopOfNode.emplace_back(StopId(key[0]));
+        signatureOfNode.emplace_back(signature);
+        entries.insert(entries.end(), key.begin() + 2, key.end() - sortedTargets.size());
+        firstTargetOfNode.emplace_back(entries.size());
+        entries.insert(entries.end(), sortedTargets.begin(), sortedTargets.end());
+        AssertMsg(entries.size() < (size_t(1) << 32), "Too many entries!");
+        firstEntryOfNode.emplace_back(entries.size());
+        nodeOfKey.emplace(std::move(key), newNode);
+        return newNode;
+    }
+
+private:
+    const size_t numberOfStops;
+
+    std::vector<u_int32_t> rootOfStop;
+    std::vector<StopId> viaStopOfNode;
+    std::vector<u_int32_t> firstEntryOfNode;
+    std::vector<u_int32_t> firstTargetOfNode;
+    std::vector<CompactTransferPatterns::Signature> signatureOfNode;
+    std::vector<CompactTransferPatterns::Entry> entries;
+    std::unordered_map<std::vector<u_int64_t>, u_int32_t, KeyHasher> nodeOfKey;
+
+    std::vector<std::vector<std::pair<Vertex, int>>> children;
+    std::vector<std::vector<CompactTransferPatterns::Entry>> targets;
+};
+
+} // namespace TransferPattern
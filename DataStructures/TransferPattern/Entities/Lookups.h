@@ -6,26 +6,6 @@
 #include "../../RAPTOR/Entities/StopEvent.h"
 
 namespace TransferPattern {
-struct HaltsOfStopInLine {
-    HaltsOfStopInLine(std::vector<RAPTOR::StopEvent> halts = {}) : halts(halts) {}
-
-    inline void serialize(IO::Serialization& serialize) const { serialize(halts); }
-
-    inline void deserialize(IO::Deserialization& deserialize) { deserialize(halts); }
-
-    std::vector<RAPTOR::StopEvent> halts;
-};
-
-struct LookupOfLine {
-    LookupOfLine(std::vector<HaltsOfStopInLine> stopsAlongLine = {}) : stopsAlongLine(stopsAlongLine) {}
-
-    inline void serialize(IO::Serialization& serialize) const { serialize(stopsAlongLine); }
-
-    inline void deserialize(IO::Deserialization& deserialize) { deserialize(stopsAlongLine); }
-
-    std::vector<HaltsOfStopInLine> stopsAlongLine;
-};
-
 struct LineAndStopIndex {
     LineAndStopIndex(RouteId routeId = noRouteId, StopIndex stopIndex = noStopIndex)
         : routeId(routeId), stopIndex(stopIndex) {}
@@ -19,27 +19,7 @@ public:
     Data() {}
 
     Data(const RAPTOR::Data& data) : raptorData(data) {
-        for (const RouteId route : routes()) {
-            firstTripOfRoute.emplace_back(TripId(routeOfTrip.size()));
-            const size_t tripLength = raptorData.numberOfStopsInRoute(route);
-            const size_t firstStopId = raptorData.firstStopIdOfRoute[route];
-            for (StopEventId firstStopEvent = StopEventId(raptorData.firstStopEventOfRoute[route]);
-                 firstStopEvent < raptorData.firstStopEventOfRoute[route + 1]; firstStopEvent += tripLength) {
-                const TripId trip = TripId(routeOfTrip.size());
-                routeOfTrip.emplace_back(route);
-                firstStopIdOfTrip.emplace_back(firstStopId);
-                firstStopEventOfTrip.emplace_back(firstStopEvent);
-                for (StopIndex i = StopIndex(0); i < tripLength; ++i) {
-                    tripOfStopEvent.emplace_back(trip);
-                    indexOfStopEvent.emplace_back(i);
-                    arrivalEvents.emplace_back(raptorData.stopEvents[arrivalEvents.size()].arrivalTime,
-                                               raptorData.stopIds[firstStopId + i]);
-                }
-            }
-        }
-        firstTripOfRoute.emplace_back(TripId(routeOfTrip.size()));
-        firstStopIdOfTrip.emplace_back(StopId(raptorData.stopIds.size()));
-        firstStopEventOfTrip.emplace_back(raptorData.stopEvents.size());
+        computeTripData();
         if (!raptorData.hasImplicitBufferTimes()) {
             raptorData.useImplicitDepartureBufferTimes();
         }
@@ -252,6 +232,18 @@ public:
         stopEventGraph.readBinary(fileName + ".graph");
     }
 
+    // Renumbers routes, trips and stop events according to the given route order (new id -> old id), such that
+    // routes that are close to each other in the order are also close to each other in memory. Stop ids are not
+    // changed. The stop event graph (including its arc-flags) is permuted accordingly. Returns the stop event
+    // permutation (old id -> new id).
+    inline Permutation applyRouteOrder(const Order& routeOrder) noexcept {
+        const Permutation stopEventPermutation(Construct::Invert, raptorData.applyRouteOrder(routeOrder));
+        computeTripData();
+        stopEventGraph.applyVertexPermutation(stopEventPermutation);
+        stopEventGraph.sortEdges(ToVertex);
+        return stopEventPermutation;
+    }
+
     // Arc-Flag TB
     inline int getNumberOfPartitionCells() const noexcept { return raptorData.getNumberOfPartitionCells(); }
 
@@ -306,6 +298,38 @@ public:
         if (verbose) std::cout << "Finished creating HypMETIS file " << fileName << "!\n";
     }
 
+private:
+    inline void computeTripData() noexcept {
+        firstTripOfRoute.clear();
+        routeOfTrip.clear();
+        firstStopIdOfTrip.clear();
+        firstStopEventOfTrip.clear();
+        tripOfStopEvent.clear();
+        indexOfStopEvent.clear();
+        arrivalEvents.clear();
+        for (const RouteId route : routes()) {
+            firstTripOfRoute.emplace_back(TripId(routeOfTrip.size()));
+            const size_t tripLength = raptorData.numberOfStopsInRoute(route);
+            const size_t firstStopId = raptorData.firstStopIdOfRoute[route];
+            for (StopEventId firstStopEvent = StopEventId(raptorData.firstStopEventOfRoute[route]);
+                 firstStopEvent < raptorData.firstStopEventOfRoute[route + 1]; firstStopEvent += tripLength) {
+                const TripId trip = TripId(routeOfTrip.size());
+                routeOfTrip.emplace_back(route);
+                firstStopIdOfTrip.emplace_back(firstStopId);
+                firstStopEventOfTrip.emplace_back(firstStopEvent);
+                for (StopIndex i = StopIndex(0); i < tripLength; ++i) {
+                    tripOfStopEvent.emplace_back(trip);
+                    indexOfStopEvent.emplace_back(i);
+                    arrivalEvents.emplace_back(raptorData.stopEvents[arrivalEvents.size()].arrivalTime,
+                                               raptorData.stopIds[firstStopId + i]);
+                }
+            }
+        }
+        firstTripOfRoute.emplace_back(TripId(routeOfTrip.size()));
+        firstStopIdOfTrip.emplace_back(StopId(raptorData.stopIds.size()));
+        firstStopEventOfTrip.emplace_back(raptorData.stopEvents.size());
+    }
+
 public:
     RAPTOR::Data raptorData;
 
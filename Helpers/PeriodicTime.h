@@ -0,0 +1,65 @@
+#pragma once
+
+#include <algorithm>
+
+#include "Assert.h"
+#include "Types.h"
+
+// Time arithmetic for periodic timetables, in which every trip operates once per period (usually one day). The times
+// of a timetable are those of the trip instances that start on day 0, the instance of day d runs d periods later.
+// Trips that run past the end of the period keep times of at least one period, so the departure times of a trip lie
+// in [0, (maxDayShift + 1) * period), where maxDayShift is the largest day offset that occurs in the timetable.
+namespace PeriodicTime {
+
+inline constexpr int DefaultPeriod = 24 * 60 * 60;
+
+inline int dayOf(const int time, const int period = DefaultPeriod) noexcept {
+    AssertMsg(period > 0, "Period must be positive!");
+    return (time >= 0) ? (time / period) : -((period - 1 - time) / period);
+}
+
+inline int timeOfDay(const int time, const int period = DefaultPeriod) noexcept {
+    return time - dayOf(time, period) * period;
+}
+
+// A trip instance, given by the index of the trip and the day on which the instance starts.
+struct TripInstance {
+    TripInstance(const size_t index = -1, const int day = 0, const int departureTime = never)
+        : index(index), day(day), departureTime(departureTime) {}
+
+    inline bool exists() const noexcept { return departureTime < never; }
+
+    size_t index;
+    int day;
+    int departureTime;
+};
+
+// Returns the earliest instance of the given trips that departs at or after the given time. The departure time of
+// trip i is departureTimeOf(i), and the departure times must be non-decreasing in i. An instance can only start on one
+// of the maxDayShift + 1 days before the day of the given time, or on the following day, so one binary search per
+// candidate day suffices. If there are no trips, the returned instance does not exist.
+template <typename DEPARTURE_TIME_OF>
+inline TripInstance earliestInstance(const size_t numberOfTrips, const DEPARTURE_TIME_OF& departureTimeOf,
+                                     const int time, const int period, const int maxDayShift) noexcept {
+    TripInstance result;
+    const int day = dayOf(time, period);
+    for (int instanceDay = day - maxDayShift; instanceDay <= day + 1; instanceDay++) {
+        const int dayOffset = instanceDay * period;
+        size_t begin = 0;
+        size_t end = numberOfTrips;
+        while (begin < end) {
+            const size_t middle = begin + (end - begin) / 2;
+            if (departureTimeOf(middle) + dayOffset < time) {
+                begin = middle + 1;
+            } else {
+                end = middle;
+            }
+        }
+        if (begin == numberOfTrips) continue;
+        const int departureTime = departureTimeOf(begin) + dayOffset;
+        if (departureTime < result.departureTime) result = TripInstance(begin, instanceDay, departureTime);
+    }
+    return result;
+}
+
+} // namespace PeriodicTime
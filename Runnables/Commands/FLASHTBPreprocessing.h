@@ -6,6 +6,7 @@
 #include "../../Algorithms/TripBased/Preprocessing/ARCFlagTBBuilder.h"
 #include "../../Algorithms/TripBased/Preprocessing/CanonicalOneToAllProfileTB.h"
 #include "../../Algorithms/TripBased/Preprocessing/CompressARCFlags.h"
+#include "../../Algorithms/TripBased/Preprocessing/LocalityRouteOrder.h"
 #include "../../Algorithms/TripBased/Preprocessing/RangeRAPTOR/ComputeARCFlagsProfileRAPTOR.h"
 #include "../../Algorithms/TripBased/Preprocessing/StopEventGraphBuilder.h"
 #include "../../Algorithms/TripBased/Preprocessing/ULTRABuilderTransitive.h"
@@ -191,6 +192,38 @@ public:
     }
 };
 
+class ReorderTripBasedForLocality : public ParameterizedCommand {
+public:
+    ReorderTripBasedForLocality(BasicShell& shell)
+        : ParameterizedCommand(shell, "reorderTripBasedForLocality",
+                               "Renumbers the routes, trips and stop events of the Trip-Based input such that "
+                               "routes are grouped by partition cell and geography, and saves it. Stop ids are "
+                               "not changed.") {
+        addParameter("Input file (Trip Data)");
+        addParameter("Output file (Trip Data)");
+        addParameter("Compressing", "true");
+    }
+
+    virtual void execute() noexcept {
+        const std::string inputFile = getParameter("Input file (Trip Data)");
+        const std::string outputFile = getParameter("Output file (Trip Data)");
+        const bool compress = getParameter<bool>("Compressing");
+
+        TripBased::Data trip(inputFile);
+        trip.printInfo();
+
+        std::cout << "Computing locality-aware route order..." << std::endl;
+        const Order routeOrder = TripBased::computeLocalityRouteOrder(trip);
+        trip.applyRouteOrder(routeOrder);
+        trip.printInfo();
+        trip.serialize(outputFile);
+
+        if (compress && trip.getNumberOfPartitionCells() > 1) {
+            TripBased::CompressARCFlags(outputFile);
+        }
+    }
+};
+
 class ComputeArcFlagTBRAPTOR : public ParameterizedCommand {
 public:
     ComputeArcFlagTBRAPTOR(BasicShell& shell)
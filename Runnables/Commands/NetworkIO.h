@@ -3,6 +3,7 @@
 #include <string>
 
 #include "../../DataStructures/CSA/Data.h"
+#include "../../DataStructures/Container/HubLabels.h"
 #include "../../DataStructures/Graph/Graph.h"
 #include "../../DataStructures/Graph/Utils/IO.h"
 #include "../../DataStructures/GTFS/Data.h"
@@ -309,6 +310,32 @@ private:
     }
 };
 
+class HubGraphToHubLabels : public ParameterizedCommand {
+public:
+    HubGraphToHubLabels(BasicShell& shell)
+        : ParameterizedCommand(shell, "hubGraphToHubLabels", "Converts a hub graph to the binary hub label format.") {
+        addParameter("Hub graph");
+        addParameter("Output file");
+        addParameter("Sort by", "distance", {"distance", "hub"});
+        addParameter("Delta encode?", "false");
+    }
+
+    virtual void execute() noexcept {
+        const bool sortByDistance = (getParameter("Sort by") == "distance");
+        const bool deltaEncode = getParameter<bool>("Delta encode?");
+        if (sortByDistance && deltaEncode) {
+            std::cout << error("Only labels sorted by hub can be delta encoded!") << std::endl;
+        } else {
+            TransferGraph hubGraph(getParameter("Hub graph"));
+            Graph::printInfo(hubGraph);
+            HubLabels hubLabels(hubGraph, sortByDistance);
+            if (deltaEncode) hubLabels.deltaEncode();
+            hubLabels.printInfo();
+            hubLabels.serialize(getParameter("Output file"));
+        }
+    }
+};
+
 class WriteIntermediateToCSV : public ParameterizedCommand {
 public:
     WriteIntermediateToCSV(BasicShell& shell)
@@ -4,6 +4,7 @@
 #include <string>
 
 #include "../../Algorithms/DepthFirstSearch.h"
+#include "../../Algorithms/PTL/LabelBuilder.h"
 #include "../../DataStructures/PTL/Data.h"
 #include "../../DataStructures/TE/Data.h"
 #include "../../Helpers/MultiThreading.h"
@@ -33,6 +34,55 @@ public:
     }
 };
 
+class ComputePTLLabels : public ParameterizedCommand {
+public:
+    ComputePTLLabels(BasicShell& shell)
+        : ParameterizedCommand(shell, "computePTLLabels",
+                               "Creates a PTL object given the TE binary and computes its labels via parallel pruned "
+                               "landmark labeling.") {
+        addParameter("Input file (TE binary)");
+        addParameter("Output file (PTL binary)");
+        addParameter("Vertex order", "stopEvents", {"stopEvents", "degree"});
+        addParameter("Max batch size", "256");
+        addParameter("Number of threads", "max");
+        addParameter("Pin multiplier", "1");
+    }
+
+    virtual void execute() noexcept {
+        const std::string inputFile = getParameter("Input file (TE binary)");
+        const std::string outputFile = getParameter("Output file (PTL binary)");
+        const PTL::LabelBuilder::VertexOrder order =
+            (getParameter("Vertex order") == "degree") ? PTL::LabelBuilder::Degree : PTL::LabelBuilder::StopEvents;
+        const int maxBatchSize = getParameter<int>("Max batch size");
+        const int numberOfThreads = getNumberOfThreads();
+        const int pinMultiplier = getParameter<int>("Pin multiplier");
+        if (maxBatchSize < 1) {
+            std::cout << error("Max batch size must be at least 1!") << std::endl;
+            return;
+        }
+
+        TE::Data data(inputFile);
+        data.printInfo();
+
+        PTL::Data ptl(data);
+        PTL::LabelBuilder builder(ptl.teData, order);
+        builder.computeLabels(ThreadPinning(numberOfThreads, pinMultiplier), maxBatchSize);
+        builder.moveLabelsTo(ptl);
+        ptl.printInfo();
+
+        ptl.serialize(outputFile);
+    }
+
+private:
+    inline int getNumberOfThreads() const noexcept {
+        if (getParameter("Number of threads") == "max") {
+            return numberOfCores();
+        } else {
+            return getParameter<int>("Number of threads");
+        }
+    }
+};
+
 class LoadLabelFile : public ParameterizedCommand {
 public:
     LoadLabelFile(BasicShell& shell)
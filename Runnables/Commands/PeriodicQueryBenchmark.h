@@ -0,0 +1,134 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../../Algorithms/CSA/CSA.h"
+#include "../../Algorithms/CSA/PeriodicCSA.h"
+#include "../../Algorithms/RAPTOR/PeriodicRAPTOR.h"
+#include "../../Algorithms/RAPTOR/RAPTOR.h"
+#include "../../DataStructures/CSA/Data.h"
+#include "../../DataStructures/Queries/Queries.h"
+#include "../../DataStructures/RAPTOR/Data.h"
+#include "../../Helpers/String/String.h"
+#include "../../Helpers/Timer.h"
+#include "../../Shell/Shell.h"
+
+using namespace Shell;
+
+// Compares the arrival times of queries on a periodic timetable with those of the non-periodic algorithm. The periodic
+// timetable contains every trip of the non-periodic one, so its arrival times can only be earlier.
+template <typename NON_PERIODIC_QUERY>
+inline void compareArrivalTimes(const std::vector<StopQuery>& queries, const std::vector<int>& periodicArrivalTimes,
+                                const NON_PERIODIC_QUERY& nonPeriodicQuery) noexcept {
+    size_t earlier = 0;
+    size_t later = 0;
+    for (size_t i = 0; i < queries.size(); i++) {
+        const int arrivalTime = nonPeriodicQuery(queries[i]);
+        if (periodicArrivalTimes[i] < arrivalTime) earlier++;
+        if (periodicArrivalTimes[i] > arrivalTime) later++;
+    }
+    std::cout << "Earlier arrivals than in the non-periodic timetable: " << earlier << " of " << queries.size()
+              << std::endl;
+    if (later > 0) {
+        std::cout << error(later, " of ", queries.size(), " arrival times are later than in the non-periodic timetable!")
+                  << std::endl;
+    }
+}
+
+class RunPeriodicRAPTORQueries : public ParameterizedCommand {
+public:
+    RunPeriodicRAPTORQueries(BasicShell& shell)
+        : ParameterizedCommand(shell, "runPeriodicRAPTORQueries",
+                               "Runs the given number of random transitive RAPTOR queries on the periodic timetable, "
+                               "in which every trip operates once per period. Optionally, the arrival times are "
+                               "compared with RAPTOR on the non-periodic timetable.") {
+        addParameter("RAPTOR input file");
+        addParameter("Number of queries");
+        addParameter("Period", "86400");
+        addParameter("Transposed departure times?", "true");
+        addParameter("Compare with RAPTOR?", "true");
+    }
+
+    virtual void execute() noexcept {
+        RAPTOR::Data raptorData = RAPTOR::Data::FromBinary(getParameter("RAPTOR input file"));
+        raptorData.useImplicitDepartureBufferTimes();
+        if (getParameter<bool>("Transposed departure times?")) raptorData.buildTransposedDepartureTimes();
+        raptorData.printInfo();
+        RAPTOR::PeriodicRAPTOR algorithm(raptorData, getParameter<int>("Period"));
+
+        const size_t n = getParameter<size_t>("Number of queries");
+        const std::vector<StopQuery> queries = generateRandomStopQueries(raptorData.numberOfStops(), n);
+
+        std::vector<int> arrivalTimes;
+        double numberOfRounds = 0;
+        double scannedRouteSegments = 0;
+        Timer timer;
+        for (const StopQuery& query : queries) {
+            algorithm.run(query.source, query.departureTime, query.target);
+            arrivalTimes.emplace_back(algorithm.getEarliestArrivalTime(query.target));
+            numberOfRounds += algorithm.getNumberOfRounds();
+            scannedRouteSegments += algorithm.getNumberOfScannedRouteSegments();
+        }
+        const double periodicTime = timer.elapsedMicroseconds();
+        std::cout << "Max. day shift: " << algorithm.getMaxDayShift() << std::endl;
+        std::cout << "Avg. rounds: " << String::prettyDouble(numberOfRounds / n) << std::endl;
+        std::cout << "Avg. scanned route segments: " << String::prettyDouble(scannedRouteSegments / n) << std::endl;
+        std::cout << "Avg. query time: " << String::musToString(periodicTime / n) << std::endl;
+
+        if (!getParameter<bool>("Compare with RAPTOR?")) return;
+        RAPTOR::RAPTOR<true, RAPTOR::NoProfiler, true, false, false, false> raptor(raptorData);
+        compareArrivalTimes(queries, arrivalTimes, [&](const StopQuery& query) {
+            raptor.run(query.source, query.departureTime, query.target);
+            return raptor.getEarliestArrivalTime(query.target);
+        });
+    }
+};
+
+class RunPeriodicCSAQueries : public ParameterizedCommand {
+public:
+    RunPeriodicCSAQueries(BasicShell& shell)
+        : ParameterizedCommand(shell, "runPeriodicCSAQueries",
+                               "Runs the given number of random transitive CSA queries on the periodic timetable, in "
+                               "which every trip operates once per period. The connections are scanned for the given "
+                               "number of days. Optionally, the arrival times are compared with CSA on the "
+                               "non-periodic timetable.") {
+        addParameter("CSA input file");
+        addParameter("Number of queries");
+        addParameter("Period", "86400");
+        addParameter("Number of days", "2");
+        addParameter("Compare with CSA?", "true");
+    }
+
+    virtual void execute() noexcept {
+        CSA::Data csaData = CSA::Data::FromBinary(getParameter("CSA input file"));
+        csaData.sortConnectionsAscending();
+        csaData.printInfo();
+        CSA::PeriodicCSA algorithm(csaData, getParameter<int>("Period"));
+
+        const size_t n = getParameter<size_t>("Number of queries");
+        const int numberOfDays = getParameter<int>("Number of days");
+        const std::vector<StopQuery> queries = generateRandomStopQueries(csaData.numberOfStops(), n);
+
+        std::vector<int> arrivalTimes;
+        double scannedConnections = 0;
+        Timer timer;
+        for (const StopQuery& query : queries) {
+            algorithm.run(query.source, query.departureTime, query.target, numberOfDays);
+            arrivalTimes.emplace_back(algorithm.getEarliestArrivalTime(query.target));
+            scannedConnections += algorithm.getNumberOfScannedConnections();
+        }
+        const double periodicTime = timer.elapsedMicroseconds();
+        std::cout << "Max. day shift: " << algorithm.getMaxDayShift() << std::endl;
+        std::cout << "Avg. scanned connections: " << String::prettyDouble(scannedConnections / n) << std::endl;
+        std::cout << "Avg. query time: " << String::musToString(periodicTime / n) << std::endl;
+
+        if (!getParameter<bool>("Compare with CSA?")) return;
+        CSA::CSA<false> csa(csaData);
+        compareArrivalTimes(queries, arrivalTimes, [&](const StopQuery& query) {
+            csa.run(query.source, query.departureTime, query.target);
+            return csa.getEarliestArrivalTime(query.target);
+        });
+    }
+};
@@ -5,9 +5,11 @@
 #include <string>
 #include <vector>
 
+#include "../../Algorithms/CSA/BatchCSA.h"
 #include "../../Algorithms/CSA/CSA.h"
 #include "../../Algorithms/CSA/DijkstraCSA.h"
 #include "../../Algorithms/CSA/HLCSA.h"
+#include "../../Algorithms/CSA/ParallelProfileCSA.h"
 #include "../../Algorithms/CSA/ProfileCSA.h"
 #include "../../Algorithms/CSA/ULTRACSA.h"
 #include "../../Algorithms/PTL/Query.h"
@@ -16,9 +18,11 @@
 #include "../../Algorithms/RAPTOR/HLRAPTOR.h"
 #include "../../Algorithms/RAPTOR/InitialTransfers.h"
 #include "../../Algorithms/RAPTOR/MCR.h"
+#include "../../Algorithms/RAPTOR/ManySourceRAPTOR.h"
 #include "../../Algorithms/RAPTOR/McRAPTOR.h"
 #include "../../Algorithms/RAPTOR/MultimodalMCR.h"
 #include "../../Algorithms/RAPTOR/MultimodalULTRAMcRAPTOR.h"
+#include "../../Algorithms/RAPTOR/ParallelRangeRAPTOR.h"
 #include "../../Algorithms/RAPTOR/RAPTOR.h"
 #include "../../Algorithms/RAPTOR/ULTRABounded/MultimodalUBMHydRA.h"
 #include "../../Algorithms/RAPTOR/ULTRABounded/MultimodalUBMRAPTOR.h"
@@ -32,12 +36,14 @@
 #include "../../Algorithms/TripBased/Query/ARCProfileQuery.h"
 #include "../../Algorithms/TripBased/Query/ARCTransitiveQuery.h"
 #include "../../Algorithms/TripBased/Query/ARCTransitiveQueryComp.h"
+#include "../../Algorithms/TripBased/Query/CachedARCQuery.h"
 #include "../../Algorithms/TripBased/Query/McQuery.h"
 #include "../../Algorithms/TripBased/Query/ProfileOneToAllQuery.h"
 #include "../../Algorithms/TripBased/Query/ProfileQuery.h"
 #include "../../Algorithms/TripBased/Query/Query.h"
 #include "../../Algorithms/TripBased/Query/TransitiveQuery.h"
 #include "../../DataStructures/CSA/Data.h"
+#include "../../DataStructures/Container/HubLabels.h"
 #include "../../DataStructures/PTL/Data.h"
 #include "../../DataStructures/Queries/Queries.h"
 #include "../../DataStructures/RAPTOR/Data.h"
@@ -50,6 +56,13 @@
 
 using namespace Shell;
 
+// Hub labels are read either from a hub graph, which has an edge to every hub of a vertex, or from the binary format
+// written by HubLabels::serialize().
+inline HubLabels loadHubLabels(const std::string& fileName, const std::string& format) noexcept {
+    if (format == "binary") return HubLabels(fileName);
+    return HubLabels(TransferGraph(fileName), true);
+}
+
 class RunTransitiveRAPTORQueries : public ParameterizedCommand {
 public:
     RunTransitiveRAPTORQueries(BasicShell& shell)
@@ -57,13 +70,29 @@ public:
                                "Runs the given number of random transitive RAPTOR queries.") {
         addParameter("RAPTOR input file");
         addParameter("Number of queries");
+        addParameter("Sparse rounds?", "false");
+        addParameter("Transposed departure times?", "true");
+        addParameter("Number of threads", "1");
+        addParameter("Min routes for parallel scan", "512");
     }
 
     virtual void execute() noexcept {
         RAPTOR::Data raptorData = RAPTOR::Data::FromBinary(getParameter("RAPTOR input file"));
         raptorData.useImplicitDepartureBufferTimes();
+        if (getParameter<bool>("Transposed departure times?")) raptorData.buildTransposedDepartureTimes();
         raptorData.printInfo();
-        RAPTOR::RAPTOR<true, RAPTOR::AggregateProfiler, true, false> algorithm(raptorData);
+        if (getParameter<bool>("Sparse rounds?")) {
+            run<true>(raptorData);
+        } else {
+            run<false>(raptorData);
+        }
+    }
+
+private:
+    template <bool SPARSE_ROUNDS>
+    inline void run(const RAPTOR::Data& raptorData) noexcept {
+        RAPTOR::RAPTOR<true, RAPTOR::AggregateProfiler, true, false, false, SPARSE_ROUNDS> algorithm(raptorData);
+        algorithm.setParallelRouteScans(getNumberOfThreads(), getParameter<size_t>("Min routes for parallel scan"));
 
         const size_t n = getParameter<size_t>("Number of queries");
         const std::vector<StopQuery> queries = generateRandomStopQueries(raptorData.numberOfStops(), n);
@@ -76,6 +105,133 @@ public:
         algorithm.getProfiler().printStatistics();
         std::cout << "Avg. journeys: " << String::prettyDouble(numJourneys / n) << std::endl;
     }
+
+    inline size_t getNumberOfThreads() const noexcept {
+        if (getParameter("Number of threads") == "max") {
+            return numberOfCores();
+        } else {
+            return getParameter<size_t>("Number of threads");
+        }
+    }
+};
+
+class RunParallelRangeRAPTORQueries : public ParameterizedCommand {
+public:
+    RunParallelRangeRAPTORQueries(BasicShell& shell)
+        : ParameterizedCommand(shell, "runParallelRangeRAPTORQueries",
+                               "Runs the given number of random multi-threaded range RAPTOR profile queries.") {
+        addParameter("RAPTOR input file");
+        addParameter("Number of queries");
+        addParameter("Min departure time", "0");
+        addParameter("Max departure time", "86400");
+        addParameter("One-to-one?", "false");
+        addParameter("Number of threads", "max");
+        addParameter("Pin multiplier", "1");
+        addParameter("Chunks per thread", "4");
+        addParameter("Transposed departure times?", "true");
+    }
+
+    virtual void execute() noexcept {
+        RAPTOR::Data raptorData = RAPTOR::Data::FromBinary(getParameter("RAPTOR input file"));
+        raptorData.useImplicitDepartureBufferTimes();
+        if (getParameter<bool>("Transposed departure times?")) raptorData.buildTransposedDepartureTimes();
+        raptorData.printInfo();
+        const size_t numberOfThreads = getNumberOfThreads();
+        const size_t pinMultiplier = getParameter<size_t>("Pin multiplier");
+        RAPTOR::ParallelRangeRAPTOR algorithm(raptorData, ThreadPinning(numberOfThreads, pinMultiplier),
+                                              getParameter<size_t>("Chunks per thread"));
+
+        const size_t n = getParameter<size_t>("Number of queries");
+        const int minDepartureTime = getParameter<int>("Min departure time");
+        const int maxDepartureTime = getParameter<int>("Max departure time");
+        const bool oneToOne = getParameter<bool>("One-to-one?");
+        const std::vector<StopQuery> queries = generateRandomStopQueries(raptorData.numberOfStops(), n);
+
+        double numDepartures = 0;
+        double numEntries = 0;
+        double totalTime = 0;
+        Timer timer;
+        for (const StopQuery& query : queries) {
+            timer.restart();
+            if (oneToOne) {
+                algorithm.run(query.source, query.target, minDepartureTime, maxDepartureTime);
+            } else {
+                algorithm.run(query.source, minDepartureTime, maxDepartureTime);
+            }
+            totalTime += timer.elapsedMicroseconds();
+            numDepartures += algorithm.numberOfDepartures();
+            numEntries += algorithm.numberOfProfileEntries();
+        }
+        std::cout << "Threads: " << numberOfThreads << std::endl;
+        std::cout << "Avg. departures: " << String::prettyDouble(numDepartures / n) << std::endl;
+        std::cout << "Avg. profile entries: " << String::prettyDouble(numEntries / n) << std::endl;
+        std::cout << "Avg. query time: " << String::musToString(totalTime / n) << std::endl;
+    }
+
+private:
+    inline size_t getNumberOfThreads() const noexcept {
+        if (getParameter("Number of threads") == "max") {
+            return numberOfCores();
+        } else {
+            return getParameter<size_t>("Number of threads");
+        }
+    }
+};
+
+class ComputeManySourceRAPTORMatrix : public ParameterizedCommand {
+public:
+    ComputeManySourceRAPTORMatrix(BasicShell& shell)
+        : ParameterizedCommand(shell, "computeManySourceRAPTORMatrix",
+                               "Computes the earliest arrival times from the given number of random source stops (or "
+                               "all stops) to all stops with batched many-source RAPTOR and writes the source x stop "
+                               "matrix to the output file.") {
+        addParameter("RAPTOR input file");
+        addParameter("Output file");
+        addParameter("Number of sources", "all");
+        addParameter("Departure time", "28800");
+        addParameter("Batch size", "32", {"32", "64"});
+        addParameter("Transposed departure times?", "true");
+    }
+
+    virtual void execute() noexcept {
+        RAPTOR::Data raptorData = RAPTOR::Data::FromBinary(getParameter("RAPTOR input file"));
+        raptorData.useImplicitDepartureBufferTimes();
+        if (getParameter<bool>("Transposed departure times?")) raptorData.buildTransposedDepartureTimes();
+        raptorData.printInfo();
+        if (getParameter<size_t>("Batch size") == 64) {
+            run<64>(raptorData);
+        } else {
+            run<32>(raptorData);
+        }
+    }
+
+private:
+    template <size_t BATCH_SIZE>
+    inline void run(const RAPTOR::Data& raptorData) noexcept {
+        RAPTOR::ManySourceRAPTOR<BATCH_SIZE> algorithm(raptorData);
+
+        std::vector<StopId> sources;
+        if (getParameter("Number of sources") == "all") {
+            for (const StopId stop : raptorData.stops()) {
+                sources.emplace_back(stop);
+            }
+        } else {
+            for (const StopQuery& query : generateRandomStopQueries(raptorData.numberOfStops(),
+                                                                    getParameter<size_t>("Number of sources"))) {
+                sources.emplace_back(query.source);
+            }
+        }
+
+        Timer timer;
+        const std::vector<int> matrix =
+            algorithm.computeArrivalTimeMatrix(sources, getParameter<int>("Departure time"));
+        const double time = timer.elapsedMicroseconds();
+        std::cout << "Sources: " << sources.size() << ", batch size: " << BATCH_SIZE << std::endl;
+        std::cout << "Total time: " << String::musToString(time) << std::endl;
+        std::cout << "Avg. time per source: " << String::musToString(time / std::max<size_t>(sources.size(), 1))
+                  << std::endl;
+        IO::serialize(getParameter("Output file"), sources, matrix);
+    }
 };
 
 class RunDijkstraRAPTORQueries : public ParameterizedCommand {
@@ -86,11 +242,13 @@ public:
         addParameter("RAPTOR input file");
         addParameter("CH data");
         addParameter("Number of queries");
+        addParameter("Transposed departure times?", "true");
     }
 
     virtual void execute() noexcept {
         RAPTOR::Data raptorData = RAPTOR::Data::FromBinary(getParameter("RAPTOR input file"));
         raptorData.useImplicitDepartureBufferTimes();
+        if (getParameter<bool>("Transposed departure times?")) raptorData.buildTransposedDepartureTimes();
         raptorData.printInfo();
         CH::CH ch(getParameter("CH data"));
         RAPTOR::DijkstraRAPTOR<RAPTOR::CoreCHInitialTransfers, RAPTOR::AggregateProfiler, true, false> algorithm(
@@ -117,25 +275,42 @@ public:
         addParameter("RAPTOR input file");
         addParameter("CH data");
         addParameter("Number of queries");
+        addParameter("Transposed departure times?", "true");
+        addParameter("Initial transfers", "bucket", {"bucket", "phast"});
+        addParameter("One-to-all?", "false");
     }
 
     virtual void execute() noexcept {
+        if (getParameter("Initial transfers") == "phast") {
+            run<RAPTOR::PHASTInitialTransfers>();
+        } else if (getParameter<bool>("One-to-all?")) {
+            std::cout << error("One-to-all queries require PHAST initial transfers!") << std::endl;
+        } else {
+            run<RAPTOR::BucketCHInitialTransfers>();
+        }
+    }
+
+private:
+    template <typename INITIAL_TRANSFERS>
+    inline void run() const noexcept {
         RAPTOR::Data raptorData = RAPTOR::Data::FromBinary(getParameter("RAPTOR input file"));
         raptorData.useImplicitDepartureBufferTimes();
+        if (getParameter<bool>("Transposed departure times?")) raptorData.buildTransposedDepartureTimes();
         raptorData.printInfo();
         CH::CH ch(getParameter("CH data"));
-        RAPTOR::ULTRARAPTOR<RAPTOR::AggregateProfiler, false> algorithm(raptorData, ch);
+        RAPTOR::ULTRARAPTOR<RAPTOR::AggregateProfiler, false, INITIAL_TRANSFERS> algorithm(raptorData, ch);
 
         const size_t n = getParameter<size_t>("Number of queries");
+        const bool oneToAll = getParameter<bool>("One-to-all?");
         const std::vector<VertexQuery> queries = generateRandomVertexQueries(ch.numVertices(), n);
 
         double numJourneys = 0;
         for (const VertexQuery& query : queries) {
-            algorithm.run(query.source, query.departureTime, query.target);
-            numJourneys += algorithm.getJourneys().size();
+            algorithm.run(query.source, query.departureTime, oneToAll ? noVertex : query.target);
+            if (!oneToAll) numJourneys += algorithm.getJourneys().size();
         }
         algorithm.getProfiler().printStatistics();
-        std::cout << "Avg. journeys: " << String::prettyDouble(numJourneys / n) << std::endl;
+        if (!oneToAll) std::cout << "Avg. journeys: " << String::prettyDouble(numJourneys / n) << std::endl;
     }
 };
 
@@ -147,14 +322,17 @@ public:
         addParameter("Out-hub file");
         addParameter("In-hub file");
         addParameter("Number of queries");
+        addParameter("Transposed departure times?", "true");
+        addParameter("Hub label format", "graph", {"graph", "binary"});
     }
 
     virtual void execute() noexcept {
         RAPTOR::Data raptorData = RAPTOR::Data::FromBinary(getParameter("RAPTOR input file"));
         raptorData.useImplicitDepartureBufferTimes();
+        if (getParameter<bool>("Transposed departure times?")) raptorData.buildTransposedDepartureTimes();
         raptorData.printInfo();
-        const TransferGraph outHubs(getParameter("Out-hub file"));
-        const TransferGraph inHubs(getParameter("In-hub file"));
+        const HubLabels outHubs = loadHubLabels(getParameter("Out-hub file"), getParameter("Hub label format"));
+        const HubLabels inHubs = loadHubLabels(getParameter("In-hub file"), getParameter("Hub label format"));
         RAPTOR::HLRAPTOR<RAPTOR::AggregateProfiler> algorithm(raptorData, outHubs, inHubs);
 
         const size_t n = getParameter<size_t>("Number of queries");
@@ -170,6 +348,45 @@ public:
     }
 };
 
+class RunHubLabelQueries : public ParameterizedCommand {
+public:
+    RunHubLabelQueries(BasicShell& shell)
+        : ParameterizedCommand(shell, "runHubLabelQueries",
+                               "Runs the given number of random vertex-to-vertex hub label distance queries.") {
+        addParameter("Out-hub file");
+        addParameter("In-hub file");
+        addParameter("Number of queries");
+        addParameter("Hub label format", "graph", {"graph", "binary"});
+        addParameter("Delta encode?", "false");
+    }
+
+    virtual void execute() noexcept {
+        HubLabels outHubs = loadHubLabels(getParameter("Out-hub file"), getParameter("Hub label format"));
+        HubLabels inHubs = loadHubLabels(getParameter("In-hub file"), getParameter("Hub label format"));
+        outHubs.setSortedByDistance(false);
+        inHubs.setSortedByDistance(false);
+        if (getParameter<bool>("Delta encode?")) {
+            outHubs.deltaEncode();
+            inHubs.deltaEncode();
+        }
+        outHubs.printInfo();
+        inHubs.printInfo();
+
+        const size_t n = getParameter<size_t>("Number of queries");
+        const std::vector<VertexQuery> queries = generateRandomVertexQueries(inHubs.numVertices(), n);
+
+        size_t numReachable = 0;
+        Timer timer;
+        for (const VertexQuery& query : queries) {
+            if (outHubs.getDistance(query.source, inHubs, query.target) != INFTY) numReachable++;
+        }
+        const double time = timer.elapsedMicroseconds();
+        std::cout << "Reachable: " << String::prettyInt(numReachable) << " / " << String::prettyInt(n) << std::endl;
+        std::cout << "Total time: " << String::musToString(time) << std::endl;
+        std::cout << "Avg. query time: " << String::prettyDouble(1000 * time / n) << "ns" << std::endl;
+    }
+};
+
 class RunTransitiveMcRAPTORQueries : public ParameterizedCommand {
 public:
     RunTransitiveMcRAPTORQueries(BasicShell& shell)
@@ -177,11 +394,13 @@ public:
                                "Runs the given number of random transitive McRAPTOR queries.") {
         addParameter("RAPTOR input file");
         addParameter("Number of queries");
+        addParameter("Transposed departure times?", "true");
     }
 
     virtual void execute() noexcept {
         RAPTOR::Data raptorData = RAPTOR::Data::FromBinary(getParameter("RAPTOR input file"));
         raptorData.useImplicitDepartureBufferTimes();
+        if (getParameter<bool>("Transposed departure times?")) raptorData.buildTransposedDepartureTimes();
         raptorData.printInfo();
         RAPTOR::McRAPTOR<true, true, RAPTOR::AggregateProfiler> algorithm(raptorData);
 
@@ -320,11 +539,13 @@ public:
         addParameter("RAPTOR input file");
         addParameter("CH data");
         addParameter("Number of queries");
+        addParameter("Transposed departure times?", "true");
     }
 
     virtual void execute() noexcept {
         RAPTOR::Data raptorData = RAPTOR::Data::FromBinary(getParameter("RAPTOR input file"));
         raptorData.useImplicitDepartureBufferTimes();
+        if (getParameter<bool>("Transposed departure times?")) raptorData.buildTransposedDepartureTimes();
         raptorData.printInfo();
         CH::CH ch(getParameter("CH data"));
         RAPTOR::ULTRAMcRAPTOR<RAPTOR::AggregateProfiler> algorithm(raptorData, ch);
@@ -604,13 +825,24 @@ public:
         addParameter("CSA input file");
         addParameter("Number of queries");
         addParameter("Target pruning?");
+        addParameter("Compressed times?", "false");
     }
 
     virtual void execute() noexcept {
+        if (getParameter<bool>("Compressed times?")) {
+            run<true>();
+        } else {
+            run<false>();
+        }
+    }
+
+private:
+    template <bool COMPRESSED_TIMES>
+    inline void run() const noexcept {
         CSA::Data csaData = CSA::Data::FromBinary(getParameter("CSA input file"));
         csaData.sortConnectionsAscending();
         csaData.printInfo();
-        CSA::CSA<true, CSA::AggregateProfiler> algorithm(csaData);
+        CSA::CSA<true, CSA::AggregateProfiler, true, COMPRESSED_TIMES> algorithm(csaData);
 
         const size_t n = getParameter<size_t>("Number of queries");
         const std::vector<StopQuery> queries = generateRandomStopQueries(csaData.numberOfStops(), n);
@@ -624,6 +856,95 @@ public:
     }
 };
 
+class RunBatchCSAQueries : public ParameterizedCommand {
+public:
+    RunBatchCSAQueries(BasicShell& shell)
+        : ParameterizedCommand(shell, "runBatchCSAQueries",
+                               "Runs the given number of random transitive CSA queries in batches, which share one "
+                               "connection scan. The queries are sorted by departure time before they are batched. "
+                               "Optionally, the queries are also answered one by one with CSA for comparison.") {
+        addParameter("CSA input file");
+        addParameter("Number of queries");
+        addParameter("Batch size", "8", {"8", "16", "32"});
+        addParameter("Target pruning?");
+        addParameter("Compare with CSA?", "true");
+    }
+
+    virtual void execute() noexcept {
+        CSA::Data csaData = CSA::Data::FromBinary(getParameter("CSA input file"));
+        csaData.sortConnectionsAscending();
+        csaData.printInfo();
+        switch (getParameter<size_t>("Batch size")) {
+            case 32:
+                run<32>(csaData);
+                break;
+            case 16:
+                run<16>(csaData);
+                break;
+            default:
+                run<8>(csaData);
+        }
+    }
+
+private:
+    template <size_t BATCH_SIZE>
+    inline void run(const CSA::Data& csaData) const noexcept {
+        CSA::BatchCSA<BATCH_SIZE> algorithm(csaData);
+
+        const size_t n = getParameter<size_t>("Number of queries");
+        std::vector<StopQuery> queries = generateRandomStopQueries(csaData.numberOfStops(), n);
+        std::stable_sort(queries.begin(), queries.end(), [](const StopQuery& a, const StopQuery& b) {
+            return a.departureTime < b.departureTime;
+        });
+
+        const bool targetPruning = getParameter<bool>("Target pruning?");
+
+        std::vector<int> arrivalTimes;
+        std::vector<StopId> sources;
+        std::vector<int> departureTimes;
+        std::vector<StopId> targets;
+        double scannedConnections = 0;
+        Timer timer;
+        for (size_t first = 0; first < queries.size(); first += BATCH_SIZE) {
+            sources.clear();
+            departureTimes.clear();
+            targets.clear();
+            for (size_t i = first; i < std::min(first + BATCH_SIZE, queries.size()); i++) {
+                sources.emplace_back(queries[i].source);
+                departureTimes.emplace_back(queries[i].departureTime);
+                targets.emplace_back(queries[i].target);
+            }
+            algorithm.run(sources, departureTimes, targetPruning ? targets : std::vector<StopId>());
+            scannedConnections += algorithm.getNumberOfScannedConnections();
+            for (size_t lane = 0; lane < sources.size(); lane++) {
+                arrivalTimes.emplace_back(algorithm.getEarliestArrivalTime(lane, targets[lane]));
+            }
+        }
+        const double batchTime = timer.elapsedMicroseconds();
+        const size_t numberOfBatches = (queries.size() + BATCH_SIZE - 1) / BATCH_SIZE;
+        std::cout << "Batch size: " << BATCH_SIZE << ", batches: " << numberOfBatches << std::endl;
+        std::cout << "Avg. scanned connections per batch: "
+                  << String::prettyDouble(scannedConnections / std::max<size_t>(numberOfBatches, 1)) << std::endl;
+        std::cout << "Avg. time per query: " << String::musToString(batchTime / std::max<size_t>(n, 1)) << std::endl;
+
+        if (!getParameter<bool>("Compare with CSA?")) return;
+        CSA::CSA<false> csa(csaData);
+        size_t mismatches = 0;
+        timer.restart();
+        for (size_t i = 0; i < queries.size(); i++) {
+            csa.run(queries[i].source, queries[i].departureTime, targetPruning ? queries[i].target : noStop);
+            if (csa.getEarliestArrivalTime(queries[i].target) != arrivalTimes[i]) mismatches++;
+        }
+        const double csaTime = timer.elapsedMicroseconds();
+        std::cout << "Avg. time per query (CSA): " << String::musToString(csaTime / std::max<size_t>(n, 1))
+                  << std::endl;
+        std::cout << "Speedup: " << String::prettyDouble(csaTime / std::max(batchTime, 1.0)) << std::endl;
+        if (mismatches > 0) {
+            std::cout << error(mismatches, " of ", n, " arrival times differ from CSA!") << std::endl;
+        }
+    }
+};
+
 class RunTransitiveProfileCSAQueries : public ParameterizedCommand {
 public:
     RunTransitiveProfileCSAQueries(BasicShell& shell)
@@ -652,6 +973,82 @@ public:
     }
 };
 
+class RunParallelProfileCSAQueries : public ParameterizedCommand {
+public:
+    RunParallelProfileCSAQueries(BasicShell& shell)
+        : ParameterizedCommand(shell, "runParallelProfileCSAQueries",
+                               "Runs the given number of random multi-threaded ProfileCSA queries, which split the "
+                               "day into overlapping departure time windows. Optionally, the profiles are compared "
+                               "with those of the sequential ProfileCSA.") {
+        addParameter("CSA input file");
+        addParameter("Number of queries");
+        addParameter("Window overlap", "14400");
+        addParameter("Number of threads", "max");
+        addParameter("Pin multiplier", "1");
+        addParameter("Windows per thread", "1");
+        addParameter("Compare with sequential?", "true");
+    }
+
+    virtual void execute() noexcept {
+        CSA::Data csaData = CSA::Data::FromBinary(getParameter("CSA input file"));
+        csaData.sortConnectionsAscending();
+        csaData.printInfo();
+        const bool compare = getParameter<bool>("Compare with sequential?");
+        const size_t numberOfThreads = getNumberOfThreads();
+        const size_t pinMultiplier = getParameter<size_t>("Pin multiplier");
+        CSA::ParallelProfileCSA<true> algorithm(csaData, ThreadPinning(numberOfThreads, pinMultiplier),
+                                                getParameter<int>("Window overlap"),
+                                                getParameter<size_t>("Windows per thread"));
+
+        const size_t n = getParameter<size_t>("Number of queries");
+        const std::vector<StopQuery> queries = generateRandomStopQueries(csaData.numberOfStops(), n);
+
+        std::vector<std::vector<CSA::ParallelProfileCSA<true>::ProfileEntry>> profiles;
+        double numJourneys = 0;
+        Timer timer;
+        for (const StopQuery& query : queries) {
+            algorithm.run(query.source, query.target, 0, 86400);
+            numJourneys += algorithm.numberOfJourneys();
+            if (compare) profiles.emplace_back(algorithm.getProfile());
+        }
+        const double parallelTime = timer.elapsedMicroseconds();
+        std::cout << "Threads: " << numberOfThreads << ", windows: " << algorithm.numberOfWindows() << std::endl;
+        std::cout << "Avg. journeys: " << String::prettyDouble(numJourneys / n) << std::endl;
+        std::cout << "Avg. query time: " << String::musToString(parallelTime / n) << std::endl;
+        if (!compare) return;
+
+        // ProfileCSA changes the connection times of its data, so the sequential algorithm needs a fresh copy.
+        CSA::Data sequentialData = CSA::Data::FromBinary(getParameter("CSA input file"));
+        sequentialData.sortConnectionsAscending();
+        CSA::ProfileCSA<true, CSA::NoProfiler> sequential(sequentialData);
+        size_t differentProfiles = 0;
+        timer.restart();
+        for (size_t i = 0; i < n; i++) {
+            sequential.run(queries[i].source, queries[i].target, 0, 86400);
+            const CSA::ProfileArena& sequentialProfiles = sequential.getProfiles();
+            const StopId source = queries[i].source;
+            bool equal = (sequentialProfiles.size(source) == profiles[i].size());
+            for (size_t j = 0; equal && j < profiles[i].size(); j++) {
+                equal = sequentialProfiles.departureTime(source, j) == profiles[i][j].departureTime
+                        && sequentialProfiles.arrivalTime(source, j) == profiles[i][j].arrivalTime;
+            }
+            if (!equal) differentProfiles++;
+        }
+        std::cout << "Avg. query time (sequential): " << String::musToString(timer.elapsedMicroseconds() / n)
+                  << std::endl;
+        std::cout << "Profiles different from sequential: " << differentProfiles << " of " << n << std::endl;
+    }
+
+private:
+    inline size_t getNumberOfThreads() const noexcept {
+        if (getParameter("Number of threads") == "max") {
+            return numberOfCores();
+        } else {
+            return getParameter<size_t>("Number of threads");
+        }
+    }
+};
+
 class RunDijkstraCSAQueries : public ParameterizedCommand {
 public:
     RunDijkstraCSAQueries(BasicShell& shell)
@@ -713,14 +1110,15 @@ public:
         addParameter("Out-hub file");
         addParameter("In-hub file");
         addParameter("Number of queries");
+        addParameter("Hub label format", "graph", {"graph", "binary"});
     }
 
     virtual void execute() noexcept {
         CSA::Data csaData = CSA::Data::FromBinary(getParameter("CSA input file"));
         csaData.sortConnectionsAscending();
         csaData.printInfo();
-        const TransferGraph outHubs(getParameter("Out-hub file"));
-        const TransferGraph inHubs(getParameter("In-hub file"));
+        const HubLabels outHubs = loadHubLabels(getParameter("Out-hub file"), getParameter("Hub label format"));
+        const HubLabels inHubs = loadHubLabels(getParameter("In-hub file"), getParameter("Hub label format"));
         CSA::HLCSA<CSA::AggregateProfiler> algorithm(csaData, outHubs, inHubs);
 
         const size_t n = getParameter<size_t>("Number of queries");
@@ -947,6 +1345,7 @@ public:
         addParameter("Trip-Based input file");
         addParameter("Number of queries");
         addParameter("Compressed?", "false");
+        addParameter("Timestamp bits", "32", {"16", "32"});
     }
 
     virtual void execute() noexcept {
@@ -957,22 +1356,76 @@ public:
         const size_t n = getParameter<size_t>("Number of queries");
         const std::vector<StopQuery> queries = generateRandomStopQueries(tripBasedData.numberOfStops(), n);
 
+        double numJourneys = 0;
+        if (getParameter<int>("Timestamp bits") == 16) {
+            numJourneys = run<TripBased::TimestampedReachedIndex<u_int16_t>>(tripBasedData, inputFile, queries);
+        } else {
+            numJourneys = run<TripBased::TimestampedReachedIndex<u_int32_t>>(tripBasedData, inputFile, queries);
+        }
+
+        std::cout << "Avg. journeys: " << String::prettyDouble(numJourneys / n) << std::endl;
+    }
+
+private:
+    template <typename REACHED_INDEX>
+    inline double run(TripBased::Data& tripBasedData, const std::string& inputFile,
+                      const std::vector<StopQuery>& queries) noexcept {
         double numJourneys = 0;
         if (getParameter<bool>("Compressed?")) {
-            TripBased::ARCTransitiveQueryComp<TripBased::AggregateProfiler> algorithm(tripBasedData, inputFile);
+            TripBased::ARCTransitiveQueryComp<TripBased::AggregateProfiler, REACHED_INDEX> algorithm(tripBasedData,
+                                                                                                    inputFile);
             for (const StopQuery& query : queries) {
                 algorithm.run(query.source, query.departureTime, query.target);
                 numJourneys += algorithm.getJourneys().size();
             }
             algorithm.getProfiler().printStatistics();
         } else {
-            TripBased::ARCTransitiveQuery<TripBased::AggregateProfiler> algorithm(tripBasedData);
+            TripBased::ARCTransitiveQuery<TripBased::AggregateProfiler, REACHED_INDEX> algorithm(tripBasedData);
             for (const StopQuery& query : queries) {
                 algorithm.run(query.source, query.departureTime, query.target);
                 numJourneys += algorithm.getJourneys().size();
             }
             algorithm.getProfiler().printStatistics();
         }
+        return numJourneys;
+    }
+};
+
+class RunCachedTransitiveArcTripBasedQueries : public ParameterizedCommand {
+public:
+    RunCachedTransitiveArcTripBasedQueries(BasicShell& shell)
+        : ParameterizedCommand(shell, "runCachedTransitiveArcTripBasedQueries",
+                               "Runs the given number of transitive Arc-Flag TB queries behind a result cache. The "
+                               "queries are drawn from the given number of random source/target pairs.") {
+        addParameter("Trip-Based input file");
+        addParameter("Number of queries");
+        addParameter("Number of source/target pairs");
+        addParameter("Bucket size (s)", "3600");
+        addParameter("Memory limit (MB)", "1024");
+        addParameter("Eviction policy", "LRU");
+    }
+
+    virtual void execute() noexcept {
+        const std::string inputFile = getParameter("Trip-Based input file");
+        TripBased::Data tripBasedData(inputFile);
+        tripBasedData.printInfo();
+
+        const size_t n = getParameter<size_t>("Number of queries");
+        const std::vector<StopQuery> queries = generateSkewedStopQueries(
+            tripBasedData.numberOfStops(), n, getParameter<size_t>("Number of source/target pairs"));
+
+        TripBased::CachedARCQuery<TripBased::AggregateProfiler> algorithm(
+            tripBasedData, getParameter<int>("Bucket size (s)"),
+            getParameter<size_t>("Memory limit (MB)") * 1024 * 1024,
+            TripBased::cacheEvictionPolicyFromString(getParameter("Eviction policy")));
+
+        double numJourneys = 0;
+        for (const StopQuery& query : queries) {
+            algorithm.run(query.source, query.departureTime, query.target);
+            numJourneys += algorithm.getJourneys().size();
+        }
+        algorithm.getProfiler().printStatistics();
+        algorithm.printInfo();
 
         std::cout << "Avg. journeys: " << String::prettyDouble(numJourneys / n) << std::endl;
     }
@@ -1090,13 +1543,24 @@ public:
         addParameter("Trip-Based input file");
         addParameter("CH data");
         addParameter("Number of queries");
+        addParameter("Initial transfers", "bucket", {"bucket", "phast"});
     }
 
     virtual void execute() noexcept {
+        if (getParameter("Initial transfers") == "phast") {
+            run<RAPTOR::PHASTInitialTransfers>();
+        } else {
+            run<RAPTOR::BucketCHInitialTransfers>();
+        }
+    }
+
+private:
+    template <typename INITIAL_TRANSFERS>
+    inline void run() const noexcept {
         TripBased::Data tripBasedData(getParameter("Trip-Based input file"));
         tripBasedData.printInfo();
         CH::CH ch(getParameter("CH data"));
-        TripBased::Query<TripBased::AggregateProfiler> algorithm(tripBasedData, ch);
+        TripBased::Query<TripBased::AggregateProfiler, INITIAL_TRANSFERS> algorithm(tripBasedData, ch);
 
         const size_t n = getParameter<size_t>("Number of queries");
         const std::vector<VertexQuery> queries = generateRandomVertexQueries(ch.numVertices(), n);
@@ -23,13 +23,14 @@ public:
         addParameter("Input file (TP Data)");
         addParameter("Number of queries");
         addParameter("A Star enabled?", "false");
+        addParameter("Compact patterns?", "false");
     }
 
     virtual void execute() noexcept {
         const bool useAStar = getParameter<bool>("A Star enabled?");
         const std::string inputFile = getParameter("Input file (TP Data)");
 
-        TransferPattern::Data data(inputFile);
+        TransferPattern::Data data(inputFile, getParameter<bool>("Compact patterns?"));
         data.printInfo();
 
         const size_t n = getParameter<size_t>("Number of queries");
@@ -84,27 +85,28 @@ public:
 
         std::cout << "Computing Transfer Pattern with " << (int)numberOfThreads << " # of threads!" << std::endl;
 
-        if (numberOfThreads == 0) {
-            TransferPattern::ComputeTransferPatternUsingTripBased(data, tpData);
-        } else {
-            TransferPattern::ComputeTransferPatternUsingTripBased(data, tpData, numberOfThreads, pinMultiplier);
-        }
-
         long long totalNumVertices(0);
         long long totalNumEdges(0);
-
-        for (const StopId stop : tpData.raptorData.stops()) {
-            totalNumVertices += tpData.transferPatternOfStop[stop].numVertices();
-            totalNumEdges += tpData.transferPatternOfStop[stop].numEdges();
+        {
+            TransferPattern::TransferPatternWriter writer(outputFile + ".transferPattern", data.numberOfStops());
+            if (numberOfThreads == 0) {
+                TransferPattern::ComputeTransferPatternUsingTripBased(data, writer);
+            } else {
+                TransferPattern::ComputeTransferPatternUsingTripBased(data, writer, numberOfThreads, pinMultiplier);
+            }
+            totalNumVertices = writer.getTotalNumberOfVertices();
+            totalNumEdges = writer.getTotalNumberOfEdges();
+            std::cout << "Max. # buffered patterns: " << writer.getMaxNumberOfBufferedPatterns() << std::endl;
         }
 
-        std::cout << "Total Size:       " << String::bytesToString(tpData.byteSize()) << std::endl;
+        std::cout << "Total Size:       " << String::bytesToString(tpData.byteSize()) << " (without patterns)"
+                  << std::endl;
         std::cout << "Average # Nodes:  " << String::prettyDouble(totalNumVertices / data.raptorData.numberOfStops())
                   << std::endl;
         std::cout << "Average # Edges:  " << String::prettyDouble(totalNumEdges / data.raptorData.numberOfStops())
                   << std::endl;
 
-        tpData.serialize(outputFile);
+        tpData.serializeWithoutTransferPatterns(outputFile);
     }
 
 private:
@@ -117,6 +119,25 @@ private:
     }
 };
 
+class CompressTransferPatterns : public ParameterizedCommand {
+public:
+    CompressTransferPatterns(BasicShell& shell)
+        : ParameterizedCommand(shell, "compressTP",
+                               "Merges the Transfer Patterns of all stops into a compact, memory-mappable file "
+                               "<TP Data>.compactTransferPattern, which runTPQueries can use instead.") {
+        addParameter("Input file (TP Data)");
+    }
+
+    virtual void execute() noexcept {
+        const std::string inputFile = getParameter("Input file (TP Data)");
+
+        TransferPattern::Data data(inputFile);
+        data.printInfo();
+
+        data.serializeCompactTransferPatterns(inputFile);
+    }
+};
+
 class ExportTPDAGOfStop : public ParameterizedCommand {
 public:
     ExportTPDAGOfStop(BasicShell& shell)
@@ -1,7 +1,10 @@
 #pragma once
 
+#include <fstream>
 #include <iostream>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "../../Algorithms/RAPTOR/ULTRA/Builder.h"
 #include "../../Algorithms/RAPTOR/ULTRA/McBuilder.h"
@@ -109,6 +112,95 @@ private:
     }
 };
 
+class UpdateStopToStopShortcuts : public ParameterizedCommand {
+public:
+    UpdateStopToStopShortcuts(BasicShell& shell)
+        : ParameterizedCommand(shell, "updateStopToStopShortcuts",
+                               "Updates stop-to-stop ULTRA shortcuts after edges of the transfer graph were changed. "
+                               "The changed edges file contains one line 'from to' per inserted, removed or modified "
+                               "edge. A negative search radius defaults to the witness limit.") {
+        addParameter("Input file");
+        addParameter("Old shortcut file");
+        addParameter("Changed edges file");
+        addParameter("Output file");
+        addParameter("Witness limit");
+        addParameter("Search radius", "-1");
+        addParameter("Number of threads", "max");
+        addParameter("Pin multiplier", "1");
+    }
+
+    virtual void execute() noexcept {
+        const std::string inputFile = getParameter("Input file");
+        const std::string outputFile = getParameter("Output file");
+        const int witnessLimit = getParameter<int>("Witness limit");
+        const int searchRadius = getParameter<int>("Search radius");
+        const size_t numberOfThreads = getNumberOfThreads();
+        const size_t pinMultiplier = getParameter<size_t>("Pin multiplier");
+
+        RAPTOR::Data data(inputFile);
+        data.useImplicitDepartureBufferTimes();
+        data.printInfo();
+        const RAPTOR::Data oldShortcutData(getParameter("Old shortcut file"));
+        if (oldShortcutData.numberOfStops() != data.numberOfStops()) {
+            std::cout << error("Old shortcuts were computed for a different timetable!") << std::endl;
+            return;
+        }
+        std::vector<std::pair<Vertex, Vertex>> changedEdges;
+        if (!readChangedEdges(getParameter("Changed edges file"), data.transferGraph.numVertices(), changedEdges)) {
+            return;
+        }
+        std::cout << "Number of changed edges: " << String::prettyInt(changedEdges.size()) << std::endl;
+
+        RAPTOR::ULTRA::Builder<false, false, false> shortcutGraphBuilder(data);
+        std::cout << "Updating stop-to-stop ULTRA shortcuts (parallel with " << numberOfThreads << " threads)."
+                  << std::endl;
+        shortcutGraphBuilder.updateShortcuts(ThreadPinning(numberOfThreads, pinMultiplier),
+                                             oldShortcutData.transferGraph, changedEdges, witnessLimit,
+                                             (searchRadius < 0) ? witnessLimit : searchRadius);
+        Graph::move(std::move(shortcutGraphBuilder.getShortcutGraph()), data.transferGraph);
+
+        data.dontUseImplicitDepartureBufferTimes();
+        Graph::printInfo(data.transferGraph);
+        data.transferGraph.printAnalysis();
+        data.serialize(outputFile);
+    }
+
+private:
+    inline size_t getNumberOfThreads() const noexcept {
+        if (getParameter("Number of threads") == "max") {
+            return numberOfCores();
+        } else {
+            return getParameter<int>("Number of threads");
+        }
+    }
+
+    // Reads one changed edge per line, given by the ids of its endpoints in the transfer graph. Returns false if the
+    // file cannot be read completely or contains an invalid vertex id.
+    inline static bool readChangedEdges(const std::string& fileName, const size_t numberOfVertices,
+                                        std::vector<std::pair<Vertex, Vertex>>& changedEdges) noexcept {
+        std::ifstream changedEdgesFile(fileName);
+        if (!changedEdgesFile.is_open()) {
+            std::cout << error("Cannot open changed edges file " + fileName + "!") << std::endl;
+            return false;
+        }
+        size_t from, to;
+        while (changedEdgesFile >> from >> to) {
+            if (from >= numberOfVertices || to >= numberOfVertices) {
+                std::cout << error("Changed edge (", from, ", ", to, ") in line ", changedEdges.size() + 1,
+                                   " has a vertex id that is not below ", numberOfVertices, "!")
+                          << std::endl;
+                return false;
+            }
+            changedEdges.emplace_back(Vertex(from), Vertex(to));
+        }
+        if (!changedEdgesFile.eof()) {
+            std::cout << error("Cannot parse line ", changedEdges.size() + 1, " of ", fileName, "!") << std::endl;
+            return false;
+        }
+        return true;
+    }
+};
+
 class ComputeMcStopToStopShortcuts : public ParameterizedCommand {
 public:
     ComputeMcStopToStopShortcuts(BasicShell& shell)
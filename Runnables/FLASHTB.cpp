@@ -3,6 +3,7 @@
 #include "Commands/FLASHTBPreprocessing.h"
 #include "Commands/NetworkIO.h"
 #include "Commands/NetworkTools.h"
+#include "Commands/PeriodicQueryBenchmark.h"
 #include "Commands/QueryBenchmark.h"
 
 using namespace Shell;
@@ -33,13 +34,20 @@ int main(int argc, char** argv) {
     new ComputeTransitiveEventToEventShortcuts(shell);
     new CreateLayoutGraph(shell);
     new ApplyPartitionToTripBased(shell);
+    new ReorderTripBasedForLocality(shell);
     new ShowFlagDistribution(shell);
     new ComputeArcFlagTB(shell);
     new ComputeArcFlagTBRAPTOR(shell);
 
     new RunTransitiveRAPTORQueries(shell);
+    new RunParallelRangeRAPTORQueries(shell);
+    new RunPeriodicRAPTORQueries(shell);
+    new ComputeManySourceRAPTORMatrix(shell);
     new RunTransitiveCSAQueries(shell);
+    new RunBatchCSAQueries(shell);
+    new RunPeriodicCSAQueries(shell);
     new RunTransitiveProfileCSAQueries(shell);
+    new RunParallelProfileCSAQueries(shell);
     new RunTransitiveTripBasedQueries(shell);
 
     new RunTDDijkstraQueries(shell);
@@ -48,6 +56,7 @@ int main(int argc, char** argv) {
     new RunTransitiveProfileOneToAllTripBasedQueries(shell);
     new RunTransitiveProfileTripBasedQueries(shell);
     new RunTransitiveArcTripBasedQueries(shell);
+    new RunCachedTransitiveArcTripBasedQueries(shell);
     new RunTransitiveProfileArcTripBasedQueries(shell);
 
     new TestTransitiveArcTripBasedQueries(shell);
@@ -24,6 +24,7 @@ int main(int argc, char** argv) {
     new BuildMultimodalTripBasedData(shell);
     new AddModeToMultimodalTripBasedData(shell);
     new LoadDimacsGraph(shell);
+    new HubGraphToHubLabels(shell);
     new DuplicateTrips(shell);
     new AddGraph(shell);
     new ReplaceGraph(shell);
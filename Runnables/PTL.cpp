@@ -12,6 +12,7 @@ int main(int argc, char** argv) {
     ::Shell::Shell shell;
 
     new TEToPTL(shell);
+    new ComputePTLLabels(shell);
     new LoadLabelFile(shell);
     new RunPTLQueries(shell);
 
@@ -13,6 +13,7 @@ int main(int argc, char** argv) {
     new ExportTPDAGOfStop(shell);
     new RunTransferPatternQueries(shell);
     new ComputeTPUsingTB(shell);
+    new CompressTransferPatterns(shell);
 
     shell.run();
     return 0;
@@ -14,6 +14,7 @@ int main(int argc, char** argv) {
     new BuildCoreCH(shell);
 
     new ComputeStopToStopShortcuts(shell);
+    new UpdateStopToStopShortcuts(shell);
     new ComputeMcStopToStopShortcuts(shell);
     new ComputeMultimodalMcStopToStopShortcuts(shell);
     new RAPTORToTripBased(shell);
@@ -25,7 +26,9 @@ int main(int argc, char** argv) {
     new ValidateEventToEventShortcuts(shell);
 
     new RunTransitiveCSAQueries(shell);
+    new RunBatchCSAQueries(shell);
     new RunTransitiveProfileCSAQueries(shell);
+    new RunParallelProfileCSAQueries(shell);
     new RunDijkstraCSAQueries(shell);
     new RunHLCSAQueries(shell);
     new RunULTRACSAQueries(shell);
@@ -33,6 +36,7 @@ int main(int argc, char** argv) {
     new RunTransitiveRAPTORQueries(shell);
     new RunDijkstraRAPTORQueries(shell);
     new RunHLRAPTORQueries(shell);
+    new RunHubLabelQueries(shell);
     new RunULTRARAPTORQueries(shell);
 
     new RunTransitiveMcRAPTORQueries(shell);